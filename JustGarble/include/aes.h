@@ -247,6 +247,39 @@ inline void AES_ecb_encrypt_blks_4(block *blks, AES_KEY_JG *key) {
 	blks[3] = _mm_aesenclast_si128(blks[3], sched[j]);
 }
 
+inline void AES_ecb_encrypt_blks_8(block *blks, AES_KEY_JG *key) {
+	unsigned j, rnds = ROUNDS(key);
+	const __m128i *sched = ((__m128i *) (key->rd_key));
+	block b0 = _mm_xor_si128(blks[0], sched[0]);
+	block b1 = _mm_xor_si128(blks[1], sched[0]);
+	block b2 = _mm_xor_si128(blks[2], sched[0]);
+	block b3 = _mm_xor_si128(blks[3], sched[0]);
+	block b4 = _mm_xor_si128(blks[4], sched[0]);
+	block b5 = _mm_xor_si128(blks[5], sched[0]);
+	block b6 = _mm_xor_si128(blks[6], sched[0]);
+	block b7 = _mm_xor_si128(blks[7], sched[0]);
+
+	for (j = 1; j < rnds; ++j){
+		b0 = _mm_aesenc_si128(b0, sched[j]);
+		b1 = _mm_aesenc_si128(b1, sched[j]);
+		b2 = _mm_aesenc_si128(b2, sched[j]);
+		b3 = _mm_aesenc_si128(b3, sched[j]);
+		b4 = _mm_aesenc_si128(b4, sched[j]);
+		b5 = _mm_aesenc_si128(b5, sched[j]);
+		b6 = _mm_aesenc_si128(b6, sched[j]);
+		b7 = _mm_aesenc_si128(b7, sched[j]);
+	}
+
+	blks[0] = _mm_aesenclast_si128(b0, sched[j]);
+	blks[1] = _mm_aesenclast_si128(b1, sched[j]);
+	blks[2] = _mm_aesenclast_si128(b2, sched[j]);
+	blks[3] = _mm_aesenclast_si128(b3, sched[j]);
+	blks[4] = _mm_aesenclast_si128(b4, sched[j]);
+	blks[5] = _mm_aesenclast_si128(b5, sched[j]);
+	blks[6] = _mm_aesenclast_si128(b6, sched[j]);
+	blks[7] = _mm_aesenclast_si128(b7, sched[j]);
+}
+
 inline void AES_ecb_decrypt_blks(block *blks, unsigned nblks, AES_KEY_JG *key) {
 	unsigned i, j, rnds = ROUNDS(key);
 	const __m128i *sched = ((__m128i *) (key->rd_key));
@@ -39,8 +39,17 @@
 #define Q_ED_ (Q_ED_MULTIPLIER) * q_ed_estimate(num_inputs, input_length)
 #define Q_CS_ (Q_ED_)
 
+//NOTE fixed point distance values have 2 * (Fixed_Point_Frac_Bits_ + input_length) fraction bits and W_FXP_ bits in all
+#define W_FXP_ 2*Fixed_Point_Length_ + M_ED_ + 5
+#define Q_FXP_ 48 * (W_FXP_) * (W_FXP_)
+
+//NOTE float cs and ed accept a runtime norm within this much of 1
+#define FLOAT_NORM_TOLERANCE ((float) 1 / (1 << 12))
+
+#define CS_DIST 0
+#define ED_DIST 1
+
 
-#define Avail_Mem_ sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGE_SIZE)
 
 
 typedef struct
@@ -52,6 +61,10 @@ typedef struct
 BiometricInput;
 
 
+//NOTE circuits are only built to be written to file, so they are built topology-only, without labels
+//NOTE builders set precomputed_size, the bits of enrollment-only terms read after the enrollment input, see precomputed_input_size()
+//NOTE builders that read them point precomputed_inputs at &init_inputs[n] themselves
+
 #define init_GC_bio_auth()\
 \
 if (Malicious_Security_) {\
@@ -67,6 +80,12 @@ if (Malicious_Security_) {\
 		Commit_Digest_Size_ = 256;\
 	}\
 }\
+if (Fixed_Point_) {\
+	cf_offset += sprintf(circuit_file + cf_offset, "fxp%u.%u_", Fixed_Point_Length_, Fixed_Point_Frac_Bits_);\
+}\
+if (Precomputed_Enrollment_) {\
+	cf_offset += sprintf(circuit_file + cf_offset, "pre_");\
+}\
 sprintf(circuit_file + cf_offset, "%u_%u.scd", num_inputs, input_length);\
 if (task == RETURN_FILE_NAME){\
 	return;\
@@ -83,16 +102,14 @@ srand(time(NULL));\
 GarbledCircuit garbledCircuit;\
 GarblingContext garblingContext;\
 \
-int input_size = n + ((Commit_Digest_Size_ + Commit_Rand_Input_Size_) * Malicious_Security_);\
+int input_size = n + precomputed_size + ((Commit_Digest_Size_ + Commit_Rand_Input_Size_) * Malicious_Security_);\
 \
 int output_size = Malicious_Security_ ? 3 : 2;\
 \
-block *in_labels = (block*) malloc(2 * input_size * sizeof(block));\
-block *out_labels = (block*) malloc(2 * output_size * sizeof(block));\
-\
-createInputLabels(in_labels, input_size);\
-createEmptyGarbledCircuit(&garbledCircuit, input_size, output_size, q, r, in_labels);\
+createEmptyGarbledCircuit(&garbledCircuit, input_size, output_size, q, r, NULL);\
 startBuilding(&garbledCircuit, &garblingContext);\
+if (Profile_Circuits_)\
+	startProfiling(&garbledCircuit, &garblingContext, __func__);\
 \
 int init_inputs[input_size];\
 countToN(init_inputs, input_size);\
@@ -105,10 +122,18 @@ int runtime_min[SINGLE_LENGTH];\
 int enroll_range[SINGLE_LENGTH];\
 int enroll_min[SINGLE_LENGTH];\
 \
-SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, &init_inputs[feature_vector_length], runtime_range);\
-SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, &init_inputs[feature_vector_length + 32], runtime_min);\
-SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, &init_inputs[biometric_input_size + feature_vector_length], enroll_range);\
-SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, &init_inputs[biometric_input_size + feature_vector_length + 32], enroll_min);\
+if (Fixed_Point_) {\
+	memcpy(runtime_range, &init_inputs[feature_vector_length], Fixed_Point_Length_ * sizeof(int));\
+	memcpy(runtime_min, &init_inputs[feature_vector_length + 32], Fixed_Point_Length_ * sizeof(int));\
+	memcpy(enroll_range, &init_inputs[biometric_input_size + feature_vector_length], Fixed_Point_Length_ * sizeof(int));\
+	memcpy(enroll_min, &init_inputs[biometric_input_size + feature_vector_length + 32], Fixed_Point_Length_ * sizeof(int));\
+}\
+else {\
+	SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, &init_inputs[feature_vector_length], runtime_range);\
+	SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, &init_inputs[feature_vector_length + 32], runtime_min);\
+	SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, &init_inputs[biometric_input_size + feature_vector_length], enroll_range);\
+	SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, &init_inputs[biometric_input_size + feature_vector_length + 32], enroll_min);\
+}\
 \
 runtime_biom_input.feature_vector = &init_inputs[0];\
 runtime_biom_input.vector_range = runtime_range;\
@@ -126,28 +151,37 @@ int threshold_comp_type = LEQ;
 
 
 
+//NOTE fixed point circuits set final_outputs[0] themselves
+
 #define finalize_GC_bio_auth()\
 \
 int cmp_outputs[2];\
-FLOAT_CMP_Circuit_2I(&garbledCircuit, &garblingContext, threshold_comp_type, INFTY_EQ_NAN, distance_threshold, dist_func_outputs, cmp_outputs);\
-memcpy(final_outputs, cmp_outputs, sizeof(int));\
+if (!Fixed_Point_) {\
+	FLOAT_CMP_Circuit_2I(&garbledCircuit, &garblingContext, threshold_comp_type, INFTY_EQ_NAN, distance_threshold, dist_func_outputs, cmp_outputs);\
+	memcpy(final_outputs, cmp_outputs, sizeof(int));\
+}\
 \
-finishBuilding(&garbledCircuit, &garblingContext, out_labels, final_outputs);\
+finishBuilding(&garbledCircuit, &garblingContext, NULL, final_outputs);\
+if (Profile_Circuits_) {\
+	finish_profiling();\
+}\
+optimizeCircuit(&garbledCircuit, &garblingContext);\
 writeCircuitToFile(&garbledCircuit, circuit_file);\
-\
-free(in_labels);\
-free(out_labels);
+removeGarbledCircuit(&garbledCircuit);
+
 
 
+//NOTE precomputed enrollment terms directly follow the enrollment input, and are committed to along with it
 
 #define verify_commitment()\
 \
-int verif_input_size = biometric_input_size + Commit_Rand_Input_Size_;\
+pushProfileRegion(&garbledCircuit, &garblingContext, "commitment verification");\
+int verif_input_size = biometric_input_size + precomputed_size + Commit_Rand_Input_Size_;\
 int verification_inputs[verif_input_size];\
 int verification_outputs[Commit_Digest_Size_];\
 \
-memcpy(verification_inputs,  enrollment_biom_input.feature_vector, biometric_input_size * sizeof(int));\
-memcpy(&verification_inputs[biometric_input_size],  &init_inputs[input_size  - Commit_Digest_Size_ - Commit_Rand_Input_Size_], Commit_Rand_Input_Size_ * sizeof(int));\
+memcpy(verification_inputs,  enrollment_biom_input.feature_vector, (biometric_input_size + precomputed_size) * sizeof(int));\
+memcpy(&verification_inputs[biometric_input_size + precomputed_size],  &init_inputs[input_size  - Commit_Digest_Size_ - Commit_Rand_Input_Size_], Commit_Rand_Input_Size_ * sizeof(int));\
 \
 if (Commit_Func_ == SHA2_256)\
 {\
@@ -159,6 +193,7 @@ else if (Commit_Func_ == SHA3_256)\
 }\
 \
 CMP_Circuit_2I(&garbledCircuit, &garblingContext, 2 * Commit_Digest_Size_, EQ, verification_outputs, &init_inputs[input_size - Commit_Digest_Size_], &final_outputs[2]);\
+popProfileRegion(&garbledCircuit, &garblingContext);
 
 
 
@@ -167,6 +202,10 @@ extern int Malicious_Security_;
 extern int Commit_Digest_Size_;
 extern int Commit_Rand_Input_Size_;
 extern int Commit_Func_;
+extern int Fixed_Point_;
+extern int Fixed_Point_Length_;
+extern int Fixed_Point_Frac_Bits_;
+extern int Precomputed_Enrollment_;
 
 
 long q_ed_estimate(int num_inputs, int input_length);
@@ -175,6 +214,14 @@ void build_hamming(int num_inputs, int input_length, char *circuit_file, int tas
 void build_euclidean(int num_inputs, int input_length, char *circuit_file, int task);
 void build_cosine(int num_inputs, int input_length, char *circuit_file, int task);
 
+int precomputed_input_size(int dist_func, int num_inputs, int input_length);
+void precompute_enrollment_inputs(int dist_func, int num_inputs, int input_length, int *enrollment_inputs, int *outputs);
+int precomputed_enrollment_check(int dist_func, int num_inputs, int input_length, char *pre_circuit_file, char *circuit_file, int num_trials);
+int float_value_check(int dist_func, int num_inputs, int input_length, char *circuit_file, int num_trials);
+
+long long fxp_norm_tolerance(int num_inputs);
+void fxp_error_report(int num_inputs, int input_length, int dist_func, int num_trials);
+
 
 #endif
 
@@ -118,6 +118,7 @@ int MUL_Circuit2(GarbledCircuit *garbledCircuit, GarblingContext *garblingContex
 int MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int *inputA, int *inputB, int *outputs);
 int DOTPROD_Circuit2(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int num_inputs, int input_length, int *inputs, int *outputs);
 int DOTPROD_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int num_inputs, int input_length, int *inputA, int *inputB, int *outputs);
+int DOTPROD_CSA_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int num_inputs, int input_length, int *inputA, int *inputB, int *outputs);
 int SQUARE_2R_G_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int* inputs, int* outputs, int stopping_split);
 int KMUL_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int* inputs, int* outputs, int stopping_split);
 
@@ -136,5 +137,21 @@ int FLOAT_SQUARE_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 int FLOAT_CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int comp_type, int infinity_type, int *inputA, int *inputB, int* outputs);
 int FLOAT_SHIFT_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int shift_amount, int direction, int infinity_type, int *inputA, int *outputs);
 
+
+//fixed point routines
+
+int FXP_SETCONST_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, long long value, int shift, int* outputs);
+int FXP_EXTEND_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int out_length, int int_repr, int* inputs, int* outputs);
+int FXP_MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int lenA, int lenB, int *inputA, int *inputB, int *outputs);
+int FXP_CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int comp_type, int *inputA, int *inputB, int* outputs);
+
+
+//template-cached routines, built once per parameterization and copied in afterwards (see instantiateTemplate())
+
+int MUL_TMPL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int *inputA, int *inputB, int *outputs);
+int INT_TO_FLOAT_TMPL_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int* inputs, int* outputs);
+int FLOAT_MUL_TMPL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int *inputA, int *inputB, int *outputs);
+int FXP_MUL_TMPL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int lenA, int lenB, int *inputA, int *inputB, int *outputs);
+
 #endif
 
@@ -36,6 +36,8 @@
 #define SHA3_512 13
 
 
+int AES_SBOX_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int* inputs, int* outputs);
+
 int AES_expand_key(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int* key, int* expanded_key);
 
 int AESEnc_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int* inputs, int* outputs);
@@ -80,6 +80,8 @@
 #define CIRCUIT_DIR_ "./circuit_files/"
 
 
+//NOTE circuits are only built to be written to file, so they are built topology-only, without labels
+
 #define init_GC()\
 \
 sprintf(circuit_file + cf_offset, "%u_%u.scd", num_inputs, input_length);\
@@ -100,12 +102,10 @@ GarblingContext garblingContext;\
 int input_size = n;\
 int output_size = m;\
 \
-block *in_labels = (block*) malloc(2 * input_size * sizeof(block));\
-block *out_labels = (block*) malloc(2 * output_size * sizeof(block));\
-\
-createInputLabels(in_labels, input_size);\
-createEmptyGarbledCircuit(&garbledCircuit, input_size, output_size, q, r, in_labels);\
+createEmptyGarbledCircuit(&garbledCircuit, input_size, output_size, q, r, NULL);\
 startBuilding(&garbledCircuit, &garblingContext);\
+if (Profile_Circuits_)\
+	startProfiling(&garbledCircuit, &garblingContext, __func__);\
 \
 int init_inputs[input_size];\
 countToN(init_inputs, input_size);\
@@ -114,13 +114,24 @@ int final_outputs[output_size];
 
 
 
+//NOTE the profile report is written next to the circuit file, as <circuit file>.folded
+
+#define finish_profiling()\
+\
+char profile_file[FNAME_LEN_ + 8];\
+sprintf(profile_file, "%s.folded", circuit_file);\
+finishProfiling(&garbledCircuit, &garblingContext, profile_file);
+
+
+
 #define finalize_GC()\
 \
-finishBuilding(&garbledCircuit, &garblingContext, out_labels, final_outputs);\
+finishBuilding(&garbledCircuit, &garblingContext, NULL, final_outputs);\
+if (Profile_Circuits_) {\
+	finish_profiling();\
+}\
 writeCircuitToFile(&garbledCircuit, circuit_file);\
-\
-free(in_labels);\
-free(out_labels);
+removeGarbledCircuit(&garbledCircuit);
 
 
 
@@ -24,6 +24,7 @@
 
 
 extern int Int_Representation_;
+extern int Profile_Circuits_;
 
 
 #endif
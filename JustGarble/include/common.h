@@ -148,6 +148,17 @@ inline void TRUNC_COPY(char *X, char *Y) {
 #define DKC2
 //#define TRUNCATED
 
+//NOTE HALF_GATES replaces the row-reduced garbling of non-XOR gates with half-gates (2 table rows per AND/OR gate, free NOT gates)
+//NOTE requires FREE_XOR, takes precedence over ROW_REDUCTION and TRUNCATED in garbleCircuit() and evaluate()
+#define HALF_GATES
+
+//NOTE number of independent non-free gates hashed together by evaluate(), i.e. one AES_ecb_encrypt_blks_8() call
+#define EVAL_BATCH_SIZE 4
+//NOTE number of consecutive gates levelized together by levelizeCircuit()
+#define SCHEDULE_WINDOW_SIZE 4096
+//NOTE garbling stages with fewer non-free gates per thread than this are garbled by a single thread
+#define MIN_GATES_PER_THREAD 64
+
 #define NUM_TESTS 10
 #define RUNNING_TIME_ITER 100
 block randomBlock();
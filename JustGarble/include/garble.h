@@ -38,6 +38,18 @@
 #define XORGATE 6
 #define NOTGATE 5
 
+//NOTE non-free gates consume a garbled table and AES work, free gates are computed from their input labels alone
+#if defined(HALF_GATES)
+#define isFreeGate(type) ((type) == XORGATE || (type) == NOTGATE)
+#elif defined(FREE_XOR)
+#define isFreeGate(type) ((type) == XORGATE)
+#else
+#define isFreeGate(type) 0
+#endif
+
+//gate and wire capacity reserved by createEmptyGarbledCircuit() at most, beyond which the arrays grow on demand
+#define GC_INITIAL_CAPACITY (1 << 16)
+
 #define TABLE_ID -1
 #define XOR_ID -2
 #define NOT_ID -3
@@ -31,6 +31,10 @@ int fixedZeroWire(GarbledCircuit *garbledCircuit, GarblingContext *garblingConte
 int fixedOneWire(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext);
 int genericGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int input0, int input1, int output, int *vals, int type);
 
+//make room for the next gate, and respectively for the given wire, in a circuit being built (see garble.c)
+void reserveGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext);
+void reserveWire(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int wire);
+
 inline int ANDGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int input0, int input1, int output) {
 	int vals[] = { 0, 0, 0, 1 };
 	return genericGate(garbledCircuit, garblingContext, input0, input1, output, vals, ANDGATE);
@@ -39,19 +43,25 @@ inline int ANDGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 #ifdef FREE_XOR
 
 inline int XORGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int input0, int input1, int output) {
-	if(garbledCircuit->wires[input0].id == 0) {
-		printf("ERROR: Uninitialized input at wire 0 %d, gate %ld\n", input0, garblingContext->gateIndex);
-	}
-	if(garbledCircuit->wires[input1].id == 0) {
-		printf("ERROR: Uninitialized input at wire 1 %d, gate %ld\n", input1, garblingContext->gateIndex);
+	reserveGate(garbledCircuit, garblingContext);
+	reserveWire(garbledCircuit, garblingContext, output);
+	if (hasWireLabels(garbledCircuit)) {
+		if(garbledCircuit->wires[input0].id == 0) {
+			printf("ERROR: Uninitialized input at wire 0 %d, gate %ld\n", input0, garblingContext->gateIndex);
+		}
+		if(garbledCircuit->wires[input1].id == 0) {
+			printf("ERROR: Uninitialized input at wire 1 %d, gate %ld\n", input1, garblingContext->gateIndex);
+		}
+		if(garbledCircuit->wires[output].id != 0) {
+			printf("ERROR: Reusing output at wire %d\n", output);
+		}
+		createNewWire(&(garbledCircuit->wires[output]), garblingContext, output);
+
+		garbledCircuit->wires[output].label0 = xorBlocks(garbledCircuit->wires[input0].label0, garbledCircuit->wires[input1].label0);
+		garbledCircuit->wires[output].label1 = xorBlocks(garbledCircuit->wires[input0].label1, garbledCircuit->wires[input1].label0);
 	}
-	if(garbledCircuit->wires[output].id != 0) {
-		printf("ERROR: Reusing output at wire %d\n", output);
-	}
-	createNewWire(&(garbledCircuit->wires[output]), garblingContext, output);
-
-	garbledCircuit->wires[output].label0 = xorBlocks(garbledCircuit->wires[input0].label0, garbledCircuit->wires[input1].label0);
-	garbledCircuit->wires[output].label1 = xorBlocks(garbledCircuit->wires[input0].label1, garbledCircuit->wires[input1].label0);
+	else
+		garblingContext->fixedWires[output] = VARIABLE_VAL_WIRE;
 	GarbledGate *garbledGate = &(garbledCircuit->garbledGates[garblingContext->gateIndex]);
 	if (garbledGate->id != 0)
 	dbgs("Reusing a gate");
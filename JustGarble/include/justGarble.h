@@ -43,17 +43,35 @@ typedef struct {
 	long input0, input1, output; int id, type;
 } GarbledGate;
 
+//NOTE 16-byte gate record used by the scheduled garbler and evaluator, wire ids index the label arena of the circuit
+typedef struct {
+	int input0, input1, output, type;
+} PackedGate;
+
 
 typedef char shortBlock[10];
 
-#ifdef TRUNCATED
+//NOTE one GarbledTable per non-free gate, holding only the rows its scheme transmits
+#ifdef HALF_GATES
+typedef struct {
+	block table[2];
+} GarbledTable;
+#elif defined(TRUNCATED)
 typedef struct {
+#ifdef ROW_REDUCTION
+	char table[3][10];
+#else
 	char table[4][10];
+#endif
 
 } GarbledTable;
 #else
 typedef struct {
+#ifdef ROW_REDUCTION
+	block table[3];
+#else
 	block table[4];
+#endif
 } GarbledTable;
 #endif
 
@@ -64,6 +82,31 @@ typedef struct {
 	long id;
 } Circuit;
 
+//NOTE packed copy of the gates grouped into levels by the number of non-free gates on their longest input path
+//NOTE within a level the non-free gates (gates[levelStart[l]] to gates[levelFree[l] - 1]) are mutually independent
+//NOTE and are followed by the free gates of that level in their original order
+//NOTE under HALF_GATES the garbled tables are laid out in this order, one per non-free gate
+//NOTE numTables is the number of non-free gates, i.e. of garbled table rows
+//NOTE wire ids in gates and outputs are label slots (numSlots in all), recycled once the last reader of a wire is done
+//NOTE the stage arrays regroup gates by circuit-wide AND-depth for multi-threaded garbling, see buildGarblingStages()
+//NOTE if mapped is set, the level arrays, gates and outputs point into a mapped SCD v2 file and are not freed
+typedef struct {
+	int numLevels;
+	int *levelStart;
+	int *levelFree;
+	PackedGate *gates;
+	int *outputs;
+	int numSlots;
+	int numTables;
+	int mapped;
+	int numStages;
+	int *stageStart;
+	int *stageFree;
+	PackedGate *stageGates;
+	int *stageTable;
+	int *stageOutputs;
+} GateSchedule;
+
 typedef struct {
 	int n, m, q, qand, qor, qxor, qnot, r;
 	block* inputLabels, outputLabels;
@@ -73,6 +116,10 @@ typedef struct {
 	int *outputs;
 	long id;
 	block globalKey;
+	GateSchedule *schedule;
+	block *labels;
+	void *mappedFile;
+	long mappedSize;
 } GarbledCircuit;
 
 typedef struct {
@@ -81,12 +128,16 @@ typedef struct {
 	long id;
 } GarbledOutput;
 
+//NOTE gate-count profile of a circuit being built, see startProfiling(); NULL unless profiling
+typedef struct CircuitProfile CircuitProfile;
+
 typedef struct {
 	long wireIndex, gateIndex, tableIndex;
 	DKCipherContext dkCipherContext;
 	int* fixedWires;
 	int fixCount;
 	block R;
+	CircuitProfile *profile;
 } GarblingContext;
 
 
@@ -94,6 +145,10 @@ typedef block* InputLabels;
 typedef block* ExtractedLabels;
 typedef block* OutputMap;
 
+//NOTE callback for streaming garbled tables, see garbleCircuitStreaming()
+//NOTE a TableSink is told that garbledTable[0] to garbledTable[numRows - 1] are final
+typedef void (*TableSink)(void *sinkContext, long numRows);
+
 
 
 /*
@@ -103,7 +158,9 @@ typedef block* OutputMap;
  */
 
 //1. Basic circuit building
-// Create memory for an empty circuit of the specified size.
+// Create memory for an empty circuit of the specified size. While the circuit
+// is built, q and r are only initial capacities: the gate and wire arrays grow
+// as gates are added, and finishBuilding() trims them to the circuit's size.
 int createEmptyCircuit(Circuit *circuit, int n, int m, int q, int r);
 
 // Start and finish building a circuit. In between these two steps, gates
@@ -118,12 +175,63 @@ int startBuilding(GarbledCircuit *gc, GarblingContext *ctx);
 int finishBuilding(GarbledCircuit *garbledCircuit,
 		GarblingContext *garbledContext, OutputMap outputMap, int *outputs);
 
-
-
-// Create memory for an empty circuit of the specified size.
+// Optimize a built circuit, between finishBuilding and writeCircuitToFile.
+// Constants from fixed wires are propagated through the whole circuit,
+// gates with the same type and inputs are merged, gates no output depends
+// on are dropped, and the rest are renumbered in topological order, the
+// output of gate i being wire n + 1 + i as in SCD files. Wire records and
+// output labels from finishBuilding are not updated, so the circuit is
+// meant to be written out (or levelized) rather than garbled as built.
+int optimizeCircuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext);
+
+// Build a sub-circuit once and copy it in wherever it is needed. A template
+// builder adds the sub-circuit on inputs, given its parameters, and writes
+// its output wires to outputs, as the *_Circuit routines do. The first
+// instantiateTemplate() call for a builder and parameter list builds it
+// topology-only on its own and optimizes it into a compact gate list, which
+// this and later calls copy into the circuit being built, with the template
+// inputs mapped onto inputs and fresh wires for everything else. The
+// parameters must determine the sub-circuit, including any global setting
+// the builder reads. Constant inputs are only folded by optimizeCircuit().
+// clearTemplateCache() frees all templates built so far.
+#define MAX_TEMPLATE_PARAMS 8
+typedef int (*TemplateBuilder)(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext,
+		int *params, int *inputs, int *outputs);
+int instantiateTemplate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, TemplateBuilder build,
+		int numParams, int *params, int numInputs, int numOutputs, int *inputs, int *outputs);
+void clearTemplateCache();
+
+// Profile gate counts while building. startProfiling(), right after
+// startBuilding(), opens a root region with the given name. Builder routines
+// open nested regions with pushProfileRegion() and close them with
+// popProfileRegion(); both do nothing unless the circuit is being profiled.
+// Regions with the same name and parent are merged. Each one is credited
+// with the non-free (AND/OR), XOR and NOT gates and the wires added while it
+// was open, and with the AND-depth it adds on its own. finishProfiling(),
+// after finishBuilding() and before optimizeCircuit(), closes all regions,
+// prints them as a tree and, unless reportFile is NULL, writes the non-free
+// gates of each region as folded stacks (the input of flamegraph.pl).
+// Region names must outlive the profile, e.g. string literals or __func__.
+int startProfiling(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, const char *name);
+void pushProfileRegion(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, const char *name);
+void popProfileRegion(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext);
+int finishProfiling(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, char *reportFile);
+
+
+
+// Create memory for an empty circuit of the specified size. While the circuit
+// is built, q and r are only initial capacities: the gate and wire arrays grow
+// as gates are added, and finishBuilding() trims them to the circuit's size.
+// If inputLabels is NULL, the circuit is built topology-only: no wire labels
+// or garbled tables are allocated or generated, and finishBuilding() leaves
+// the output map alone. Such a circuit can be optimized and written to a
+// file, but not garbled.
 int createEmptyGarbledCircuit(GarbledCircuit *garbledCircuit, int n, int m,
 		int q, int r, InputLabels inputLabels);
 
+// Whether a circuit being built carries wire labels, see createEmptyGarbledCircuit().
+#define hasWireLabels(garbledCircuit) ((garbledCircuit)->wires != NULL)
+
 //Create memory for 2*n input labels.
 int createInputLabels(InputLabels inputLabels, int n);
 
@@ -143,6 +251,68 @@ int createInputLabels(InputLabels inputLabels, int n);
 long garbleCircuit(GarbledCircuit *garbledCircuit, InputLabels inputLabels,
 		OutputMap outputMap);
 
+//Set the number of threads garbleCircuit uses (half-gates scheme only,
+//default 1). Gates of the same AND-depth are split across the threads, and
+//since tables and tweaks are tied to the gate schedule rather than to the
+//thread doing the work, the garbled output does not depend on this setting.
+void setGarblingThreads(int numThreads);
+
+//Same as garbleCircuit, but R, the input labels and the table key are all
+//derived from the 128-bit seed (AES under the seed, in counter mode), so the
+//same seed gives the same garbled circuit. The seed must be kept secret and
+//used for one garbling only; createGarblingSeed() draws a fresh one.
+long garbleCircuitFromSeed(GarbledCircuit *garbledCircuit, block seed,
+		InputLabels inputLabels, OutputMap outputMap);
+
+//Draw a fresh garbling seed.
+block createGarblingSeed();
+
+//Recompute the 2n input labels garbleCircuitFromSeed produced from seed,
+//without garbling again.
+int createInputLabelsFromSeed(InputLabels inputLabels, int n, block seed);
+
+//Levelize the circuit and, with more than one garbling thread, build its
+//garbling stages, as garbleCircuit does on first use. Once this is done,
+//garbleCircuit only reads the circuit, apart from its table and labels.
+int prepareGarbling(GarbledCircuit *garbledCircuit);
+
+//Same as garbleCircuit, but reports garbled table rows to sink as they are
+//produced, in chunks of chunkRows rows, so that they can be sent while the
+//rest of the circuit is garbled. Rows are reported in table order. With
+//more than one garbling thread, or with schemes other than half-gates, all
+//rows are reported at once when garbling is done.
+long garbleCircuitStreaming(GarbledCircuit *garbledCircuit, InputLabels inputLabels,
+		OutputMap outputMap, long chunkRows, TableSink sink, void *sinkContext);
+
+//A garbled copy of a circuit produced ahead of time by a GarblingPool: its
+//table (getTableRows() entries), its 2m-block output map and the seed it was
+//garbled from. The 2n input labels are not kept; createInputLabelsFromSeed()
+//recomputes them when they are needed.
+typedef struct {
+	GarbledTable *garbledTable;
+	OutputMap outputMap;
+	block seed;
+	block globalKey;
+} GarbledInstance;
+
+typedef struct GarblingPool GarblingPool;
+
+//Start a pool of numInstances garbled copies of garbledCircuit, kept full by
+//numWorkers background threads, each garbling with setGarblingThreads()
+//threads (set that first). The pool only reads garbledCircuit, which must
+//outlive it. Memory is bounded by numInstances tables and output maps.
+GarblingPool *createGarblingPool(GarbledCircuit *garbledCircuit, int numInstances, int numWorkers);
+
+//Hand out the oldest ready instance, waiting for one if the pool is empty.
+//Every instance is garbled afresh and handed out once.
+GarbledInstance *takeGarbledInstance(GarblingPool *pool);
+
+//Give an instance taken from the pool back, to be garbled again.
+void releaseGarbledInstance(GarblingPool *pool, GarbledInstance *instance);
+
+//Stop the workers and free the pool and all of its instances.
+void removeGarblingPool(GarblingPool *pool);
+
 //Evaluate a garbled circuit, using n input labels in the Extracted Labels
 //to return m output labels. The garbled circuit might be generated either in
 //one piece, as the result of running garbleCircuit, or may be pieced together,
@@ -167,6 +337,48 @@ int mapOutputs(OutputMap outputMap, OutputMap extractedMap, int *outputVals,
 int writeCircuitToFile(GarbledCircuit *garbledCircuit, char *fileName);
 int readCircuitFromFile(GarbledCircuit *garbledCircuit, char *fileName);
 
+// Write a circuit in the SCD v2 binary format (see src/SCD_Format). With
+// SCD2_PACKED the gates, outputs and gate schedule are stored as they sit in
+// memory, and readCircuitFromFile maps them from the file without parsing,
+// so evaluator processes share one page-cache copy of the topology. With
+// SCD2_VARINT the gates are delta/varint encoded instead, for a smaller file
+// that is decoded and levelized on load. readCircuitFromFile tells v1 and v2
+// files apart by their first bytes.
+#define SCD2_PACKED 0
+#define SCD2_VARINT 1
+int writeCircuitToFileSCD2(GarbledCircuit *garbledCircuit, char *fileName, int encoding);
+
+// Group the gates of a finished circuit into levels, so that the non-free
+// gates of a level can be garbled or evaluated together. Wires are then
+// renamed onto label slots that are reused as soon as the last gate reading
+// a wire is done, so garbling and evaluation need memory for the widest cut
+// of the circuit rather than for all of its wires. readCircuitFromFile
+// levelizes the circuit it reads, and garbleCircuit and evaluate levelize on
+// first use otherwise.
+int levelizeCircuit(GarbledCircuit *garbledCircuit);
+void removeSchedule(GarbledCircuit *garbledCircuit);
+
+// The number of GarbledTable entries a garbled circuit needs and transmits,
+// i.e. the number of gates that are not free (AND/OR, and NOT unless under
+// half-gates). Tables are laid out densely, in the order the garbler and
+// evaluator visit the non-free gates. Before levelization this is q.
+int getTableRows(GarbledCircuit *garbledCircuit);
+
+// Regroup a levelized circuit into the circuit-wide stages garbled by
+// multiple threads. garbleCircuit calls this on first use.
+int buildGarblingStages(GarbledCircuit *garbledCircuit);
+
+// Allocate the label arena, one block per label slot of the schedule (one
+// per wire for a circuit that is not levelized). The garbler keeps only the
+// zero label of each wire there (the one label is label0 ^ R under free-XOR)
+// and the evaluator keeps the active label, so the Wire records are not
+// touched while garbling or evaluating a levelized circuit.
+int createLabelArena(GarbledCircuit *garbledCircuit);
+
+// Allocate the garbled table with getTableRows() entries, so call it after
+// the circuit is levelized.
+int createGarbledTable(GarbledCircuit *garbledCircuit);
+
 
 //#include "garble.h"
 //#include "circuits.h"
@@ -33,5 +33,6 @@ extern void AES_encrypt_JG(const unsigned char *in, unsigned char *out, const AE
 extern void AES_decrypt_JG(const unsigned char *in, unsigned char *out, const AES_KEY_JG *key);
 extern void AES_ecb_encrypt_blks(block *blks, unsigned nblks, AES_KEY_JG *key);
 extern void AES_ecb_encrypt_blks_4(block *blks, AES_KEY_JG *key);
+extern void AES_ecb_encrypt_blks_8(block *blks, AES_KEY_JG *key);
 extern void AES_ecb_decrypt_blks(block *blks, unsigned nblks, AES_KEY_JG *key);
 
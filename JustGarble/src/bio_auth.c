@@ -19,8 +19,11 @@
 */
 
 
+#include <stdlib.h>
 #include <unistd.h>
 #include <time.h>
+#include <math.h>
+#include <limits.h>
 #include "../include/justGarble.h"
 #include "../include/bio_auth.h"
 #include "../include/bio_common.h"
@@ -30,6 +33,10 @@ int Malicious_Security_ = 0;
 int Commit_Digest_Size_ = 0;
 int Commit_Func_ = SHA2_256;
 int Commit_Rand_Input_Size_ = 128;
+int Fixed_Point_ = 0;
+int Fixed_Point_Length_ = 26;
+int Fixed_Point_Frac_Bits_ = 24;
+int Precomputed_Enrollment_ = 0;
 
 
 long q_ed_estimate(int num_inputs, int input_length) {
@@ -52,9 +59,11 @@ long q_ed_estimate(int num_inputs, int input_length) {
 		n *= 2;
 	}
 
-	long mem_ceiling = 7 * Avail_Mem_ / (8 * Q_ED_MULTIPLIER);
+	//NOTE the estimate only sizes the initial arrays of createEmptyGarbledCircuit(), which grow as needed
+	//NOTE so it just has to keep q and r = 8 * q within an int, with room for the float or fixed point gates on top
+	long int_ceiling = INT_MAX / (16 * Q_ED_MULTIPLIER);
 
-	return estimate < mem_ceiling ? estimate : mem_ceiling;
+	return estimate < int_ceiling ? estimate : int_ceiling;
 }
 
 
@@ -69,10 +78,25 @@ long q_ed_estimate(int num_inputs, int input_length) {
 
 void build_hamming(int num_inputs, int input_length, char *circuit_file, int task)
 {
+	//NOTE there is no float arithmetic to replace here, nor an enrollment-only term to precompute,
+	//NOTE so the circuit (and its file name) is the same either way
+	if (Fixed_Point_ || Precomputed_Enrollment_)
+	{
+		int fixed_point = Fixed_Point_;
+		int precomputed_enrollment = Precomputed_Enrollment_;
+		Fixed_Point_ = 0;
+		Precomputed_Enrollment_ = 0;
+		build_hamming(num_inputs, input_length, circuit_file, task);
+		Fixed_Point_ = fixed_point;
+		Precomputed_Enrollment_ = precomputed_enrollment;
+		return;
+	}
+
 	int m = M_HD_;
+	int precomputed_size = 0;
 
-	int q = Q_HD_ + Q_FLOAT_;	//max num gates
-	int r = 8 * q;	//max num wires
+	int q = Q_HD_ + Q_FLOAT_;	//initial gate capacity
+	int r = 8 * q;	//initial wire capacity
 
 	int cf_offset = sprintf(circuit_file, "%sbio_auth_hd_", CIRCUIT_DIR_);
 
@@ -102,12 +126,42 @@ void build_hamming(int num_inputs, int input_length, char *circuit_file, int tas
 
 //TODO update to work with floats
 
+//valid_norm = 1 iff |norm - 1| <= FLOAT_NORM_TOLERANCE, since the float norm is never exactly 1 once range and min
+//are rounded to float and the expansion is evaluated with truncating float arithmetic
+
+static void float_norm_check(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int *norm, int *valid_norm)
+{
+	int lower_bound[SINGLE_LENGTH];
+	int upper_bound[SINGLE_LENGTH];
+	int above_lower[2];
+	int below_upper[2];
+
+	SET_CONST_FLOAT_CAST_Circuit(garbledCircuit, garblingContext, 1 - FLOAT_NORM_TOLERANCE, lower_bound);
+	SET_CONST_FLOAT_CAST_Circuit(garbledCircuit, garblingContext, 1 + FLOAT_NORM_TOLERANCE, upper_bound);
+
+	//NOTE FLOAT_CMP_Circuit_2I() also writes A != B after the requested comparison, hence the two outputs
+	FLOAT_CMP_Circuit_2I(garbledCircuit, garblingContext, GEQ, INFTY_EQ_NAN, norm, lower_bound, above_lower);
+	FLOAT_CMP_Circuit_2I(garbledCircuit, garblingContext, LEQ, INFTY_EQ_NAN, norm, upper_bound, below_upper);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, above_lower[0], below_upper[0], valid_norm);
+}
+
+
+
+static void build_euclidean_fxp(int num_inputs, int input_length, char *circuit_file, int task);
+
 void build_euclidean(int num_inputs, int input_length, char *circuit_file, int task)
 {
+	if (Fixed_Point_)
+	{
+		build_euclidean_fxp(num_inputs, input_length, circuit_file, task);
+		return;
+	}
+
 	int m = M_ED_;
+	int precomputed_size = Precomputed_Enrollment_ ? precomputed_input_size(ED_DIST, num_inputs, input_length) : 0;
 
-	int q = Q_ED_ + Q_FLOAT_;	//max num gates
-	int r = 8 * q;	//max num wires
+	int q = Q_ED_ + Q_FLOAT_;	//initial gate capacity
+	int r = 8 * q;	//initial wire capacity
 
 	int stopping_split = 4;	//max recursion; lower == deeper
 
@@ -115,6 +169,7 @@ void build_euclidean(int num_inputs, int input_length, char *circuit_file, int t
 
 	//see init_GC() macro for more declarations
 	init_GC_bio_auth();
+	int *precomputed_inputs = &init_inputs[n];
 
 	int one = 1;
 	int zero = 0;
@@ -123,41 +178,35 @@ void build_euclidean(int num_inputs, int input_length, char *circuit_file, int t
 
 	threshold_comp_type = LES;
 
-	int m_sum = input_length + lg_flr(num_inputs);
+	int m_sum = input_length + 1 + lg_flr(num_inputs - 1);	//as wide as SUM_Circuit() output
 	int compr_dot_prod_runsqr[m];
-	int compr_dot_prod_enrlsqr[m];
 	int compr_dot_prod_runenrl[m];
 	int compr_sum_runtime[m_sum];
-	int compr_sum_enrollment[m_sum];
 
 	SETCONST_Circuit(&garbledCircuit, &garblingContext, m_sum, &zero, compr_sum_runtime);
-	SETCONST_Circuit(&garbledCircuit, &garblingContext, m_sum, &zero, compr_sum_enrollment);
 
 	SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, compr_sum_runtime);
-	SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, enrollment_biom_input.feature_vector, compr_sum_enrollment);
 	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, runtime_biom_input.feature_vector, compr_dot_prod_runsqr);
-	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, enrollment_biom_input.feature_vector, compr_dot_prod_enrlsqr);
-	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, enrollment_biom_input.feature_vector, enrollment_biom_input.feature_vector, compr_dot_prod_runenrl);
+	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, enrollment_biom_input.feature_vector, compr_dot_prod_runenrl);
 
 	int runrng_squared[SINGLE_LENGTH];
-	int enrlrng_squared[SINGLE_LENGTH];
 	int runminrng[SINGLE_LENGTH];
-	int negrunminrng[SINGLE_LENGTH];
+	int runenrlrng[SINGLE_LENGTH];
+	int negrunenrlrng[SINGLE_LENGTH];
 
 	FLOAT_SQUARE_Circuit(&garbledCircuit, &garblingContext, runtime_range, runrng_squared);
-	FLOAT_SQUARE_Circuit(&garbledCircuit, &garblingContext, enroll_range, enrlrng_squared);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_range, runtime_min, runminrng);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_range, runtime_min, runminrng);
 	FLOAT_SHIFT_Circuit(&garbledCircuit, &garblingContext, 1, LEFT, INFTY_EQ_NAN, runminrng, runminrng);
-	FLOAT_NEG_Circuit(&garbledCircuit, &garblingContext, runminrng, negrunminrng);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_range, enroll_range, runenrlrng);
+	FLOAT_SHIFT_Circuit(&garbledCircuit, &garblingContext, 1, LEFT, INFTY_EQ_NAN, runenrlrng, runenrlrng);
+	FLOAT_NEG_Circuit(&garbledCircuit, &garblingContext, runenrlrng, negrunenrlrng);
 
 	int mindiff[SINGLE_LENGTH];
 	int shlmindiff[SINGLE_LENGTH];
 	int mindiff_squared[SINGLE_LENGTH];
 	int float_dot_prod_runsqr[SINGLE_LENGTH];
-	int float_dot_prod_enrlsqr[SINGLE_LENGTH];
 	int float_dot_prod_runenrl[SINGLE_LENGTH];
 	int float_sum_runtime[SINGLE_LENGTH];
-	int float_sum_enrollment[SINGLE_LENGTH];
 	int float_num_inputs[SINGLE_LENGTH];
 	int float_prod_1[SINGLE_LENGTH];
 	int in_sum[6 * SINGLE_LENGTH];
@@ -165,52 +214,78 @@ void build_euclidean(int num_inputs, int input_length, char *circuit_file, int t
 	memcpy(&in_sum[0], enrollment_biom_input.vector_min, SINGLE_LENGTH * sizeof(int));
 	memcpy(&in_sum[SINGLE_LENGTH], runtime_biom_input.vector_min, SINGLE_LENGTH * sizeof(int));
 	FLOAT_NEG_Circuit(&garbledCircuit, &garblingContext, &in_sum[SINGLE_LENGTH], &in_sum[SINGLE_LENGTH]);
-	SUM_Circuit(&garbledCircuit, &garblingContext, 2, input_length, in_sum, mindiff);
+	FLOAT_SUM_Circuit(&garbledCircuit, &garblingContext, 2, in_sum, mindiff);
 	FLOAT_SHIFT_Circuit(&garbledCircuit, &garblingContext, 1, LEFT, INFTY_EQ_NAN, mindiff, shlmindiff);
 	FLOAT_SQUARE_Circuit(&garbledCircuit, &garblingContext, mindiff, mindiff_squared);
 
-	INT_TO_FLOAT_Circuit(&garbledCircuit, &garblingContext, m, compr_dot_prod_runsqr, float_dot_prod_runsqr);
-	INT_TO_FLOAT_Circuit(&garbledCircuit, &garblingContext, m, compr_dot_prod_enrlsqr, float_dot_prod_enrlsqr);
-	INT_TO_FLOAT_Circuit(&garbledCircuit, &garblingContext, m, compr_dot_prod_runenrl, float_dot_prod_runenrl);
-	INT_TO_FLOAT_Circuit(&garbledCircuit, &garblingContext, m_sum, compr_sum_runtime, float_sum_runtime);
-	INT_TO_FLOAT_Circuit(&garbledCircuit, &garblingContext, m_sum, compr_sum_enrollment, float_sum_enrollment);
+	INT_TO_FLOAT_TMPL_Circuit(&garbledCircuit, &garblingContext, m, compr_dot_prod_runsqr, float_dot_prod_runsqr);
+	INT_TO_FLOAT_TMPL_Circuit(&garbledCircuit, &garblingContext, m, compr_dot_prod_runenrl, float_dot_prod_runenrl);
+	INT_TO_FLOAT_TMPL_Circuit(&garbledCircuit, &garblingContext, m_sum, compr_sum_runtime, float_sum_runtime);
+
+	//sum_i ((r_r a_i + m_r) - (r_e b_i + m_e))^2 = r_r^2 sum(a_i^2) + r_e^2 sum(b_i^2) - 2 r_r r_e sum(a_i b_i)
+	//	+ 2 d r_e sum(b_i) - 2 d r_r sum(a_i) + n d^2, where d = m_e - m_r
 
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runrng_squared, float_dot_prod_runsqr, &in_sum[0]);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, enrlrng_squared, float_dot_prod_enrlsqr, &in_sum[SINGLE_LENGTH]);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, float_dot_prod_runenrl, negrunminrng, &in_sum[2 * SINGLE_LENGTH]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runrng_squared, float_dot_prod_runsqr, &in_sum[0]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, float_dot_prod_runenrl, negrunenrlrng, &in_sum[2 * SINGLE_LENGTH]);
 
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_range, shlmindiff, float_prod_1);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, float_prod_1, float_sum_enrollment, &in_sum[3 * SINGLE_LENGTH]);
+	if (Precomputed_Enrollment_)
+	{
+		//r_e^2 sum(b_i^2) and r_e sum(b_i) are read as raw floats, see precompute_enrollment_inputs()
+		int enrlrng_sum_enrollment[SINGLE_LENGTH];
+
+		SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, precomputed_inputs, &in_sum[SINGLE_LENGTH]);
+		SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, &precomputed_inputs[32], enrlrng_sum_enrollment);
+		FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, shlmindiff, enrlrng_sum_enrollment, &in_sum[3 * SINGLE_LENGTH]);
+	}
+	else
+	{
+		int compr_dot_prod_enrlsqr[m];
+		int compr_sum_enrollment[m_sum];
+		int enrlrng_squared[SINGLE_LENGTH];
+		int float_dot_prod_enrlsqr[SINGLE_LENGTH];
+		int float_sum_enrollment[SINGLE_LENGTH];
+
+		SETCONST_Circuit(&garbledCircuit, &garblingContext, m_sum, &zero, compr_sum_enrollment);
+		SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, enrollment_biom_input.feature_vector, compr_sum_enrollment);
+		DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, enrollment_biom_input.feature_vector, enrollment_biom_input.feature_vector, compr_dot_prod_enrlsqr);
+		INT_TO_FLOAT_TMPL_Circuit(&garbledCircuit, &garblingContext, m, compr_dot_prod_enrlsqr, float_dot_prod_enrlsqr);
+		INT_TO_FLOAT_TMPL_Circuit(&garbledCircuit, &garblingContext, m_sum, compr_sum_enrollment, float_sum_enrollment);
+
+		FLOAT_SQUARE_Circuit(&garbledCircuit, &garblingContext, enroll_range, enrlrng_squared);
+		FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, enrlrng_squared, float_dot_prod_enrlsqr, &in_sum[SINGLE_LENGTH]);
+
+		FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_range, shlmindiff, float_prod_1);
+		FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, float_prod_1, float_sum_enrollment, &in_sum[3 * SINGLE_LENGTH]);
+	}
 
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_range, shlmindiff, float_prod_1);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, float_prod_1, float_sum_runtime, &in_sum[4 * SINGLE_LENGTH]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_range, shlmindiff, float_prod_1);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, float_prod_1, float_sum_runtime, &in_sum[4 * SINGLE_LENGTH]);
 	FLOAT_NEG_Circuit(&garbledCircuit, &garblingContext, &in_sum[4 * SINGLE_LENGTH], &in_sum[4 * SINGLE_LENGTH]);
 
 	SET_CONST_FLOAT_CAST_Circuit(&garbledCircuit, &garblingContext, (float) num_inputs, float_num_inputs);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, float_num_inputs, mindiff_squared, &in_sum[5 * SINGLE_LENGTH]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, float_num_inputs, mindiff_squared, &in_sum[5 * SINGLE_LENGTH]);
 
 	FLOAT_SUM_Circuit(&garbledCircuit, &garblingContext, 6, in_sum, dist_func_outputs);
 
 	int valid_norm;
 
 	//normalization check
+	pushProfileRegion(&garbledCircuit, &garblingContext, "normalization check");
 
 	int runmin_squared[SINGLE_LENGTH];
 
 	FLOAT_SQUARE_Circuit(&garbledCircuit, &garblingContext, runtime_min, runmin_squared);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runminrng, float_sum_runtime, &in_sum[0]);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runrng_squared, float_dot_prod_runsqr, &in_sum[SINGLE_LENGTH]);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runmin_squared, float_num_inputs, &in_sum[2 * SINGLE_LENGTH]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runminrng, float_sum_runtime, &in_sum[0]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runrng_squared, float_dot_prod_runsqr, &in_sum[SINGLE_LENGTH]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runmin_squared, float_num_inputs, &in_sum[2 * SINGLE_LENGTH]);
 
 	int norm_check_outputs[SINGLE_LENGTH];
 	FLOAT_SUM_Circuit(&garbledCircuit, &garblingContext, 3, in_sum, norm_check_outputs);
 
-	int float_one[SINGLE_LENGTH];
-	SET_CONST_FLOAT_CAST_Circuit(&garbledCircuit, &garblingContext, (float) 1, float_one);
-
-	FLOAT_CMP_Circuit_2I(&garbledCircuit, &garblingContext, EQ, INFTY_EQ_NAN, float_one, norm_check_outputs, &valid_norm);
+	float_norm_check(&garbledCircuit, &garblingContext, norm_check_outputs, &valid_norm);
 
 	final_outputs[1] = valid_norm;
+	popProfileRegion(&garbledCircuit, &garblingContext);
 
 	if (Malicious_Security_)
 	{
@@ -223,16 +298,26 @@ void build_euclidean(int num_inputs, int input_length, char *circuit_file, int t
 
 
 
+static void build_cosine_fxp(int num_inputs, int input_length, char *circuit_file, int task);
+
 void build_cosine(int num_inputs, int input_length, char *circuit_file, int task) {
 
+	if (Fixed_Point_)
+	{
+		build_cosine_fxp(num_inputs, input_length, circuit_file, task);
+		return;
+	}
+
 	int m = M_CS_;			//int CS output size
+	int precomputed_size = Precomputed_Enrollment_ ? precomputed_input_size(CS_DIST, num_inputs, input_length) : 0;
 
-	int q = Q_CS_ + Q_FLOAT_;	//max num gates
-	int r = 8 * q;				//max num wires
+	int q = Q_CS_ + Q_FLOAT_;	//initial gate capacity
+	int r = 8 * q;				//initial wire capacity
 
 	int cf_offset = sprintf(circuit_file, "%sbio_auth_cs_", CIRCUIT_DIR_);
 
 	init_GC_bio_auth();
+	int *precomputed_inputs = &init_inputs[n];
 
 	int one = 1;
 	int zero = 0;
@@ -241,50 +326,68 @@ void build_cosine(int num_inputs, int input_length, char *circuit_file, int task
 
 	threshold_comp_type = GRT;
 
-	int m_sum = input_length + lg_flr(num_inputs);
+	int m_sum = input_length + 1 + lg_flr(num_inputs - 1);	//as wide as SUM_Circuit() output
 	int compr_dot_prod[m];
 	int compr_sum_runtime[m_sum];
-	int compr_sum_enrollment[m_sum];
 
 	SETCONST_Circuit(&garbledCircuit, &garblingContext, m_sum, &zero, compr_sum_runtime);
-	SETCONST_Circuit(&garbledCircuit, &garblingContext, m_sum, &zero, compr_sum_enrollment);
 
 	SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, compr_sum_runtime);
-	SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, enrollment_biom_input.feature_vector, compr_sum_enrollment);
 	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, enrollment_biom_input.feature_vector, compr_dot_prod);
 
 	int float_dot_prod[SINGLE_LENGTH];
 	int float_sum_runtime[SINGLE_LENGTH];
-	int float_sum_enrollment[SINGLE_LENGTH];
 	int float_num_inputs[SINGLE_LENGTH];
 	int float_prod_1[SINGLE_LENGTH];
 	int float_prod_2[SINGLE_LENGTH];
-	int float_prod_3[SINGLE_LENGTH];
-	int float_prod_4[SINGLE_LENGTH];
 	int in_sum[4 * SINGLE_LENGTH];
+	int num_terms = 4;
 
-	INT_TO_FLOAT_Circuit(&garbledCircuit, &garblingContext, m, compr_dot_prod, float_dot_prod);
-	INT_TO_FLOAT_Circuit(&garbledCircuit, &garblingContext, m_sum, compr_sum_runtime, float_sum_runtime);
-	INT_TO_FLOAT_Circuit(&garbledCircuit, &garblingContext, m_sum, compr_sum_enrollment, float_sum_enrollment);
+	INT_TO_FLOAT_TMPL_Circuit(&garbledCircuit, &garblingContext, m, compr_dot_prod, float_dot_prod);
+	INT_TO_FLOAT_TMPL_Circuit(&garbledCircuit, &garblingContext, m_sum, compr_sum_runtime, float_sum_runtime);
+	SET_CONST_FLOAT_CAST_Circuit(&garbledCircuit, &garblingContext, (float) num_inputs, float_num_inputs);
 
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_range, float_dot_prod, float_prod_1);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_range, float_prod_1, &in_sum[0]);
+	//sum_i (r_r a_i + m_r)(r_e b_i + m_e) = r_e r_r sum(a_i b_i) + m_e r_r sum(a_i) + m_r (r_e sum(b_i) + n m_e)
 
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_min, float_sum_runtime, float_prod_2);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_range, float_prod_2, &in_sum[SINGLE_LENGTH]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_range, float_dot_prod, float_prod_1);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_range, float_prod_1, &in_sum[0]);
 
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_range, float_sum_enrollment, float_prod_3);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_min, float_prod_3, &in_sum[2 * SINGLE_LENGTH]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_range, float_sum_runtime, float_prod_2);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_min, float_prod_2, &in_sum[SINGLE_LENGTH]);
 
-	SET_CONST_FLOAT_CAST_Circuit(&garbledCircuit, &garblingContext, (float) num_inputs, float_num_inputs);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_min, float_num_inputs, float_prod_4);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_min, float_prod_4, &in_sum[3 * SINGLE_LENGTH]);
+	if (Precomputed_Enrollment_)
+	{
+		//r_e sum(b_i) + n m_e is read as a raw float, see precompute_enrollment_inputs()
+		int enroll_inner[SINGLE_LENGTH];
 
-	FLOAT_SUM_Circuit(&garbledCircuit, &garblingContext, 4, in_sum, dist_func_outputs);
+		SET_RAW_FLOAT_Circuit(&garbledCircuit, &garblingContext, precomputed_inputs, enroll_inner);
+		FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_min, enroll_inner, &in_sum[2 * SINGLE_LENGTH]);
+		num_terms = 3;
+	}
+	else
+	{
+		int compr_sum_enrollment[m_sum];
+		int float_sum_enrollment[SINGLE_LENGTH];
+		int float_prod_3[SINGLE_LENGTH];
+		int float_prod_4[SINGLE_LENGTH];
+
+		SETCONST_Circuit(&garbledCircuit, &garblingContext, m_sum, &zero, compr_sum_enrollment);
+		SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, enrollment_biom_input.feature_vector, compr_sum_enrollment);
+		INT_TO_FLOAT_TMPL_Circuit(&garbledCircuit, &garblingContext, m_sum, compr_sum_enrollment, float_sum_enrollment);
+
+		FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_range, float_sum_enrollment, float_prod_3);
+		FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_min, float_prod_3, &in_sum[2 * SINGLE_LENGTH]);
+
+		FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, enrollment_biom_input.vector_min, float_num_inputs, float_prod_4);
+		FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_biom_input.vector_min, float_prod_4, &in_sum[3 * SINGLE_LENGTH]);
+	}
+
+	FLOAT_SUM_Circuit(&garbledCircuit, &garblingContext, num_terms, in_sum, dist_func_outputs);
 
 	int valid_norm;
 
 	//normalization check
+	pushProfileRegion(&garbledCircuit, &garblingContext, "normalization check");
 
 	int runrng_squared[SINGLE_LENGTH];
 	int runmin_squared[SINGLE_LENGTH];
@@ -293,24 +396,251 @@ void build_cosine(int num_inputs, int input_length, char *circuit_file, int task
 
 	FLOAT_SQUARE_Circuit(&garbledCircuit, &garblingContext, runtime_range, runrng_squared);
 	FLOAT_SQUARE_Circuit(&garbledCircuit, &garblingContext, runtime_min, runmin_squared);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_range, runtime_min, runminrng);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runtime_range, runtime_min, runminrng);
 
 	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, runtime_biom_input.feature_vector, compr_dot_prod);
+	INT_TO_FLOAT_TMPL_Circuit(&garbledCircuit, &garblingContext, m, compr_dot_prod, float_dot_prod);
 
 	FLOAT_SHIFT_Circuit(&garbledCircuit, &garblingContext, 1, LEFT, INFTY_EQ_NAN, runminrng, runminrng);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runminrng, float_sum_runtime, &in_sum[0]);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runrng_squared, float_dot_prod, &in_sum[SINGLE_LENGTH]);
-	FLOAT_MUL_Circuit_2I(&garbledCircuit, &garblingContext, runmin_squared, float_num_inputs, &in_sum[2 * SINGLE_LENGTH]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runminrng, float_sum_runtime, &in_sum[0]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runrng_squared, float_dot_prod, &in_sum[SINGLE_LENGTH]);
+	FLOAT_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, runmin_squared, float_num_inputs, &in_sum[2 * SINGLE_LENGTH]);
 
 	int norm_check_outputs[SINGLE_LENGTH];
 	FLOAT_SUM_Circuit(&garbledCircuit, &garblingContext, 3, in_sum, norm_check_outputs);
 
-	int float_one[SINGLE_LENGTH];
-	SET_CONST_FLOAT_CAST_Circuit(&garbledCircuit, &garblingContext, (float) 1, float_one);
-
-	FLOAT_CMP_Circuit_2I(&garbledCircuit, &garblingContext, EQ, INFTY_EQ_NAN, float_one, norm_check_outputs, &valid_norm);
+	float_norm_check(&garbledCircuit, &garblingContext, norm_check_outputs, &valid_norm);
 
 	final_outputs[1] = valid_norm;
+	popProfileRegion(&garbledCircuit, &garblingContext);
+
+	if (Malicious_Security_)
+	{
+		verify_commitment();
+	}
+
+	finalize_GC_bio_auth();
+}
+
+
+
+
+/////////	Fixed Point Distance Functions for Biometric Authentication
+
+
+
+//build_cosine() and build_euclidean() hand over to these when Fixed_Point_ is set
+//range and min are then read as Fixed_Point_Length_-bit signed ints, the low bits of their 32-bit input fields
+//min has F = Fixed_Point_Frac_Bits_ fraction bits, and range has G = F + input_length, so that range * a_i has F
+//fraction bits like min, and all the bits of range are significant whatever the feature vector resolution
+//products keep all of their bits, so the distance is computed exactly on these inputs, with 2G fraction bits
+//the only error is in the client rounding range and min, see fxp_error_report()
+//the expansions are factored such that the range and min of one side multiply a single sum each
+
+#define FXP_REPORT_TRIALS 1000
+
+#define FXP_RANGE_FRAC_BITS (Fixed_Point_Frac_Bits_ + input_length)
+
+
+//acc += term * 2^shift (or acc -= term * 2^shift), for a signed term_length-bit term and a w-bit accumulator
+//NOTE callers make sure that term * 2^shift fits in w bits, so the sign bits of the term above w - shift are dropped
+
+static void fxp_accumulate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int w, int term_length, int shift, int subtracting, int *term, int *acc)
+{
+	int term_ext[w];
+
+	if (term_length > w - shift)
+		term_length = w - shift;
+
+	FXP_SETCONST_Circuit(garbledCircuit, garblingContext, shift, 0, 0, term_ext);
+	FXP_EXTEND_Circuit(garbledCircuit, garblingContext, term_length, w - shift, SIGNED, term, &term_ext[shift]);
+
+	if (subtracting)
+		SUB_Circuit_2I(garbledCircuit, garblingContext, 2 * w, NO_UNDERFLOW, acc, term_ext, acc);
+	else
+		ADD_Circuit_2I(garbledCircuit, garblingContext, 2 * w, NO_OVERFLOW, acc, term_ext, acc);
+}
+
+
+
+//acc += x * y * 2^shift (or acc -= ...), for signed x and y
+
+static void fxp_mul_accumulate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int w, int x_length, int *x, int y_length, int *y, int shift, int subtracting, int *acc)
+{
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
+	int xy[x_length + y_length];
+
+	FXP_MUL_TMPL_Circuit_2I(garbledCircuit, garblingContext, x_length, y_length, x, y, xy);
+	fxp_accumulate(garbledCircuit, garblingContext, w, x_length + y_length, shift, subtracting, xy, acc);
+
+	popProfileRegion(garbledCircuit, garblingContext);
+}
+
+
+
+//bound on how far either vector moves in euclidean norm when its range and min are rounded, sqrt(n) * 2^-(F+1) for each
+
+static long double fxp_encoding_error(int num_inputs)
+{
+	return ldexpl(sqrtl((long double) num_inputs), -Fixed_Point_Frac_Bits_);
+}
+
+
+
+//the norm check accepts |sum(x_i^2) - 1| up to this many units of 2^(-2F), which covers the rounding of range and min
+
+long long fxp_norm_tolerance(int num_inputs)
+{
+	long double e = fxp_encoding_error(num_inputs);
+
+	return (long long) ceill(ldexpl(2 * e + e * e, 2 * Fixed_Point_Frac_Bits_));
+}
+
+
+
+//valid_norm = 1 iff |r (r sum(a_i^2) + 2^(il+1) min sum(a_i)) + 2^(2il) n min^2 - 1| <= fxp_norm_tolerance() for the runtime input
+//dot_prod_runsqr (M_ED_ + 1 bits) and sum_runtime (input_length + 2 + lg_flr(num_inputs - 1) bits) are signed
+
+static void fxp_norm_check(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int num_inputs, int input_length, BiometricInput *biom_input, int *dot_prod_runsqr, int *sum_runtime, int *valid_norm)
+{
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
+	int l = Fixed_Point_Length_;
+	int m = M_ED_;
+	int m_sum = input_length + 1 + lg_flr(num_inputs - 1);
+	int n_length = 2 + lg_flr(num_inputs);
+	int t = l + m + 2;
+	int w = W_FXP_;
+
+	int fxp_num_inputs[n_length];
+	int min_sqr[2 * l];
+	int inner[t];
+	int norm[w];
+	int tolerance[w];
+	int neg_tolerance[w];
+
+	FXP_SETCONST_Circuit(garbledCircuit, garblingContext, n_length, num_inputs, 0, fxp_num_inputs);
+	FXP_SETCONST_Circuit(garbledCircuit, garblingContext, t, 0, 0, inner);
+	FXP_SETCONST_Circuit(garbledCircuit, garblingContext, w, -1, 2 * FXP_RANGE_FRAC_BITS, norm);
+
+	fxp_mul_accumulate(garbledCircuit, garblingContext, t, l, biom_input->vector_range, m + 1, dot_prod_runsqr, 0, 0, inner);
+	fxp_mul_accumulate(garbledCircuit, garblingContext, t, l, biom_input->vector_min, m_sum + 1, sum_runtime, input_length + 1, 0, inner);
+	fxp_mul_accumulate(garbledCircuit, garblingContext, w, l, biom_input->vector_range, t, inner, 0, 0, norm);
+
+	FXP_MUL_TMPL_Circuit_2I(garbledCircuit, garblingContext, l, l, biom_input->vector_min, biom_input->vector_min, min_sqr);
+	fxp_mul_accumulate(garbledCircuit, garblingContext, w, 2 * l, min_sqr, n_length, fxp_num_inputs, 2 * input_length, 0, norm);
+
+	long long tol = fxp_norm_tolerance(num_inputs);
+	FXP_SETCONST_Circuit(garbledCircuit, garblingContext, w, tol, 2 * input_length, tolerance);
+	FXP_SETCONST_Circuit(garbledCircuit, garblingContext, w, -tol, 2 * input_length, neg_tolerance);
+
+	int below_upper[2];
+	int above_lower[2];
+
+	FXP_CMP_Circuit_2I(garbledCircuit, garblingContext, 2 * w, LEQ, norm, tolerance, below_upper);
+	FXP_CMP_Circuit_2I(garbledCircuit, garblingContext, 2 * w, GEQ, norm, neg_tolerance, above_lower);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, below_upper[0], above_lower[0], valid_norm);
+
+	popProfileRegion(garbledCircuit, garblingContext);
+}
+
+
+
+static void build_euclidean_fxp(int num_inputs, int input_length, char *circuit_file, int task)
+{
+	int m = M_ED_;
+	int l = Fixed_Point_Length_;
+	int w = W_FXP_;
+	int precomputed_size = Precomputed_Enrollment_ ? precomputed_input_size(ED_DIST, num_inputs, input_length) : 0;
+
+	int q = Q_ED_ + Q_FXP_;	//initial gate capacity
+	int r = 8 * q;	//initial wire capacity
+
+	int cf_offset = sprintf(circuit_file, "%sbio_auth_ed_", CIRCUIT_DIR_);
+
+	//see init_GC() macro for more declarations
+	init_GC_bio_auth();
+	int *precomputed_inputs = &init_inputs[n];
+
+	int fxp_threshold[w];
+	FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, w, 1 << 6, 2 * FXP_RANGE_FRAC_BITS, fxp_threshold);
+
+	threshold_comp_type = LES;
+
+	int m_sum = input_length + 1 + lg_flr(num_inputs - 1);
+	int n_length = 2 + lg_flr(num_inputs);
+	int t = l + m + 3;
+	int dot_prod_runsqr[m + 1];
+	int dot_prod_runenrl[m + 1];
+	int sum_runtime[m_sum + 1];
+	int fxp_num_inputs[n_length];
+
+	SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, sum_runtime);
+	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, runtime_biom_input.feature_vector, dot_prod_runsqr);
+	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, enrollment_biom_input.feature_vector, dot_prod_runenrl);
+
+	FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, m_sum, m_sum + 1, UNSIGNED, sum_runtime, sum_runtime);
+	FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, m, m + 1, UNSIGNED, dot_prod_runsqr, dot_prod_runsqr);
+	FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, m, m + 1, UNSIGNED, dot_prod_runenrl, dot_prod_runenrl);
+	FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, n_length, num_inputs, 0, fxp_num_inputs);
+
+	int mindiff[l + 1];
+	int enroll_min_ext[l + 1];
+
+	FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, l, l + 1, SIGNED, runtime_biom_input.vector_min, mindiff);
+	FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, l, l + 1, SIGNED, enrollment_biom_input.vector_min, enroll_min_ext);
+	SUB_Circuit_2I(&garbledCircuit, &garblingContext, 2 * (l + 1), NO_UNDERFLOW, mindiff, enroll_min_ext, mindiff);
+
+	//sum_i ((r_r a_i + m_r) - (r_e b_i + m_e))^2 = r_r (r_r sum(a_i^2) - 2 r_e sum(a_i b_i) + 2^(il+1) d sum(a_i))
+	//	+ r_e (r_e sum(b_i^2) - 2^(il+1) d sum(b_i)) + 2^(2il) n d^2, where d = m_r - m_e, and 2^il aligns F and G fraction bits
+
+	int runtime_inner[t];
+	int mindiff_sqr[2 * l + 2];
+	int dist[w];
+
+	FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, t, 0, 0, runtime_inner);
+	FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, w, 0, 0, dist);
+
+	fxp_mul_accumulate(&garbledCircuit, &garblingContext, t, l, runtime_biom_input.vector_range, m + 1, dot_prod_runsqr, 0, 0, runtime_inner);
+	fxp_mul_accumulate(&garbledCircuit, &garblingContext, t, l, enrollment_biom_input.vector_range, m + 1, dot_prod_runenrl, 1, 1, runtime_inner);
+	fxp_mul_accumulate(&garbledCircuit, &garblingContext, t, l + 1, mindiff, m_sum + 1, sum_runtime, input_length + 1, 0, runtime_inner);
+
+	fxp_mul_accumulate(&garbledCircuit, &garblingContext, w, l, runtime_biom_input.vector_range, t, runtime_inner, 0, 0, dist);
+
+	if (Precomputed_Enrollment_)
+	{
+		//r_e^2 sum(b_i^2) (w bits) and r_e sum(b_i) (l + m_sum + 1 bits) are read as signed ints, see precompute_enrollment_inputs()
+		fxp_accumulate(&garbledCircuit, &garblingContext, w, w, 0, 0, precomputed_inputs, dist);
+		fxp_mul_accumulate(&garbledCircuit, &garblingContext, w, l + 1, mindiff, l + m_sum + 1, &precomputed_inputs[w], input_length + 1, 1, dist);
+	}
+	else
+	{
+		int dot_prod_enrlsqr[m + 1];
+		int sum_enrollment[m_sum + 1];
+		int enroll_inner[t];
+
+		SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, enrollment_biom_input.feature_vector, sum_enrollment);
+		DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, enrollment_biom_input.feature_vector, enrollment_biom_input.feature_vector, dot_prod_enrlsqr);
+		FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, m_sum, m_sum + 1, UNSIGNED, sum_enrollment, sum_enrollment);
+		FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, m, m + 1, UNSIGNED, dot_prod_enrlsqr, dot_prod_enrlsqr);
+
+		FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, t, 0, 0, enroll_inner);
+		fxp_mul_accumulate(&garbledCircuit, &garblingContext, t, l, enrollment_biom_input.vector_range, m + 1, dot_prod_enrlsqr, 0, 0, enroll_inner);
+		fxp_mul_accumulate(&garbledCircuit, &garblingContext, t, l + 1, mindiff, m_sum + 1, sum_enrollment, input_length + 1, 1, enroll_inner);
+		fxp_mul_accumulate(&garbledCircuit, &garblingContext, w, l, enrollment_biom_input.vector_range, t, enroll_inner, 0, 0, dist);
+	}
+
+	FXP_MUL_TMPL_Circuit_2I(&garbledCircuit, &garblingContext, l + 1, l + 1, mindiff, mindiff, mindiff_sqr);
+	fxp_mul_accumulate(&garbledCircuit, &garblingContext, w, 2 * l + 2, mindiff_sqr, n_length, fxp_num_inputs, 2 * input_length, 0, dist);
+
+	int cmp_outputs_fxp[2];
+	FXP_CMP_Circuit_2I(&garbledCircuit, &garblingContext, 2 * w, threshold_comp_type, fxp_threshold, dist, cmp_outputs_fxp);
+	final_outputs[0] = cmp_outputs_fxp[0];
+
+	//normalization check
+
+	fxp_norm_check(&garbledCircuit, &garblingContext, num_inputs, input_length, &runtime_biom_input, dot_prod_runsqr, sum_runtime, &final_outputs[1]);
 
 	if (Malicious_Security_)
 	{
@@ -318,10 +648,644 @@ void build_cosine(int num_inputs, int input_length, char *circuit_file, int task
 	}
 
 	finalize_GC_bio_auth();
+
+	fxp_error_report(num_inputs, input_length, ED_DIST, FXP_REPORT_TRIALS);
 }
 
 
 
+static void build_cosine_fxp(int num_inputs, int input_length, char *circuit_file, int task)
+{
+	int m = M_CS_;
+	int l = Fixed_Point_Length_;
+	int w = W_FXP_;
+	int precomputed_size = Precomputed_Enrollment_ ? precomputed_input_size(CS_DIST, num_inputs, input_length) : 0;
+
+	int q = Q_CS_ + Q_FXP_;	//initial gate capacity
+	int r = 8 * q;	//initial wire capacity
+
+	int cf_offset = sprintf(circuit_file, "%sbio_auth_cs_", CIRCUIT_DIR_);
+
+	init_GC_bio_auth();
+	int *precomputed_inputs = &init_inputs[n];
+
+	int fxp_threshold[w];
+	FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, w, 1 - (1 << 6), 2 * FXP_RANGE_FRAC_BITS, fxp_threshold);
+
+	threshold_comp_type = GRT;
+
+	int m_sum = input_length + 1 + lg_flr(num_inputs - 1);
+	int n_length = 2 + lg_flr(num_inputs);
+	int t_runtime = l + m + 1;
+	int t_enroll = l + m_sum + 2;
+	int dot_prod[m + 1];
+	int dot_prod_runsqr[m + 1];
+	int sum_runtime[m_sum + 1];
+	int fxp_num_inputs[n_length];
+
+	SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, sum_runtime);
+	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, enrollment_biom_input.feature_vector, dot_prod);
+	DOTPROD_Circuit_2I(&garbledCircuit, &garblingContext, num_inputs, input_length, runtime_biom_input.feature_vector, runtime_biom_input.feature_vector, dot_prod_runsqr);
 
+	FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, m_sum, m_sum + 1, UNSIGNED, sum_runtime, sum_runtime);
+	FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, m, m + 1, UNSIGNED, dot_prod, dot_prod);
+	FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, m, m + 1, UNSIGNED, dot_prod_runsqr, dot_prod_runsqr);
+	FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, n_length, num_inputs, 0, fxp_num_inputs);
 
+	//sum_i (r_r a_i + m_r)(r_e b_i + m_e) = r_r (r_e sum(a_i b_i) + 2^il m_e sum(a_i))
+	//	+ 2^il m_r (r_e sum(b_i) + 2^il n m_e), where 2^il aligns F and G fraction bits
 
+	int runtime_inner[t_runtime];
+	int enroll_inner_built[t_enroll];
+	int dist[w];
+
+	FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, t_runtime, 0, 0, runtime_inner);
+	FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, w, 0, 0, dist);
+
+	fxp_mul_accumulate(&garbledCircuit, &garblingContext, t_runtime, l, enrollment_biom_input.vector_range, m + 1, dot_prod, 0, 0, runtime_inner);
+	fxp_mul_accumulate(&garbledCircuit, &garblingContext, t_runtime, l, enrollment_biom_input.vector_min, m_sum + 1, sum_runtime, input_length, 0, runtime_inner);
+
+	//r_e sum(b_i) + 2^il n m_e is read as a signed t_enroll-bit int when precomputed, see precompute_enrollment_inputs()
+	int *enroll_inner = precomputed_inputs;
+
+	if (!Precomputed_Enrollment_)
+	{
+		int sum_enrollment[m_sum + 1];
+
+		SUM_Circuit(&garbledCircuit, &garblingContext, num_inputs, input_length, enrollment_biom_input.feature_vector, sum_enrollment);
+		FXP_EXTEND_Circuit(&garbledCircuit, &garblingContext, m_sum, m_sum + 1, UNSIGNED, sum_enrollment, sum_enrollment);
+
+		enroll_inner = enroll_inner_built;
+		FXP_SETCONST_Circuit(&garbledCircuit, &garblingContext, t_enroll, 0, 0, enroll_inner);
+		fxp_mul_accumulate(&garbledCircuit, &garblingContext, t_enroll, l, enrollment_biom_input.vector_range, m_sum + 1, sum_enrollment, 0, 0, enroll_inner);
+		fxp_mul_accumulate(&garbledCircuit, &garblingContext, t_enroll, l, enrollment_biom_input.vector_min, n_length, fxp_num_inputs, input_length, 0, enroll_inner);
+	}
+
+	fxp_mul_accumulate(&garbledCircuit, &garblingContext, w, l, runtime_biom_input.vector_range, t_runtime, runtime_inner, 0, 0, dist);
+	fxp_mul_accumulate(&garbledCircuit, &garblingContext, w, l, runtime_biom_input.vector_min, t_enroll, enroll_inner, input_length, 0, dist);
+
+	int cmp_outputs_fxp[2];
+	FXP_CMP_Circuit_2I(&garbledCircuit, &garblingContext, 2 * w, threshold_comp_type, fxp_threshold, dist, cmp_outputs_fxp);
+	final_outputs[0] = cmp_outputs_fxp[0];
+
+	//normalization check
+
+	fxp_norm_check(&garbledCircuit, &garblingContext, num_inputs, input_length, &runtime_biom_input, dot_prod_runsqr, sum_runtime, &final_outputs[1]);
+
+	if (Malicious_Security_)
+	{
+		verify_commitment();
+	}
+
+	finalize_GC_bio_auth();
+
+	fxp_error_report(num_inputs, input_length, CS_DIST, FXP_REPORT_TRIALS);
+}
+
+
+
+//compares the fixed point pipeline with the float one on random unit feature vectors, compressed as the client does:
+//a_i = round((x_i - min) / range), range = (max - min) / (2^input_length - 1), with range and min then rescaled so that
+//the vector sum_i (range * a_i + min) is exactly a unit vector
+//the reference distance is computed on these vectors in long double, the float path is modeled by the same expansion in
+//single precision, and the fixed point path by the exact integer arithmetic of the circuit on the rounded range and min
+//the analytic bound: rounding range to G and min to F fraction bits moves each coordinate by at most 2^-(F+1) twice,
+//so each vector by at most e = 2^-F * sqrt(n), the cosine moves by at most 2e + e^2, and the squared euclidean distance by at most 8e + 4e^2
+
+static void fxp_compress(int num_inputs, int input_length, long double *x, int *a, long double *range, long double *min)
+{
+	long double x_min = x[0];
+	long double x_max = x[0];
+	long double norm = 0;
+
+	for (int i = 1; i < num_inputs; i++)
+	{
+		x_min = x[i] < x_min ? x[i] : x_min;
+		x_max = x[i] > x_max ? x[i] : x_max;
+	}
+
+	*range = (x_max - x_min) / ((1 << input_length) - 1);
+	*min = x_min;
+
+	for (int i = 0; i < num_inputs; i++)
+	{
+		a[i] = (int) roundl((x[i] - x_min) / *range);
+		norm += (*range * a[i] + *min) * (*range * a[i] + *min);
+	}
+
+	norm = sqrtl(norm);
+	*range /= norm;
+	*min /= norm;
+}
+
+
+static void fxp_random_unit_vector(int num_inputs, long double *x)
+{
+	long double norm = 0;
+
+	for (int i = 0; i < num_inputs; i++)
+	{
+		x[i] += 2 * ((long double) rand() / RAND_MAX) - 1;
+		norm += x[i] * x[i];
+	}
+
+	norm = sqrtl(norm);
+	for (int i = 0; i < num_inputs; i++)
+		x[i] /= norm;
+}
+
+
+static int fxp_threshold_decision(int comp_type, long double threshold, long double dist)
+{
+	return comp_type == GRT ? threshold > dist : threshold < dist;
+}
+
+
+void fxp_error_report(int num_inputs, int input_length, int dist_func, int num_trials)
+{
+	int F = Fixed_Point_Frac_Bits_;
+	int G = FXP_RANGE_FRAC_BITS;
+	int il = input_length;
+	long double fxp_limit = ldexpl(1, Fixed_Point_Length_ - 1);
+	long double e = fxp_encoding_error(num_inputs);
+	long double bound = dist_func == ED_DIST ? 8 * e + 4 * e * e : 2 * e + e * e;
+	long long tol = fxp_norm_tolerance(num_inputs);
+
+	int comp_type = dist_func == ED_DIST ? LES : GRT;
+	long double threshold = dist_func == ED_DIST ? (1 << 6) : (1 - (1 << 6));
+
+	long double max_fxp_err = 0;
+	long double max_float_err = 0;
+	long double max_fxp_float_diff = 0;
+	int decision_mismatches = 0;
+	int norm_check_failures = 0;
+	int out_of_range = 0;
+
+	long double x[num_inputs];
+	long double y[num_inputs];
+	int a[num_inputs];
+	int b[num_inputs];
+
+	for (int t = 0; t < num_trials; t++)
+	{
+		//enrollment vectors range from near copies of the runtime vector to unrelated ones
+		long double closeness = (long double) t / num_trials;
+
+		memset(x, 0, sizeof(x));
+		fxp_random_unit_vector(num_inputs, x);
+		for (int i = 0; i < num_inputs; i++)
+			y[i] = x[i] * num_inputs * closeness;
+		fxp_random_unit_vector(num_inputs, y);
+
+		long double r[2], mn[2];
+		fxp_compress(num_inputs, input_length, x, a, &r[0], &mn[0]);
+		fxp_compress(num_inputs, input_length, y, b, &r[1], &mn[1]);
+
+		long long rq[2], mq[2];
+		int in_range = 1;
+		for (int j = 0; j < 2; j++)
+		{
+			rq[j] = llroundl(ldexpl(r[j], G));
+			mq[j] = llroundl(ldexpl(mn[j], F));
+			in_range &= (llabs(rq[j]) < fxp_limit) && (llabs(mq[j]) < fxp_limit);
+		}
+		if (!in_range)
+		{
+			out_of_range++;
+			continue;
+		}
+
+		long long dot = 0, dot_aa = 0, dot_bb = 0, sum_a = 0, sum_b = 0;
+		long double exact = 0;
+
+		for (int i = 0; i < num_inputs; i++)
+		{
+			long double xi = r[0] * a[i] + mn[0];
+			long double yi = r[1] * b[i] + mn[1];
+			exact += dist_func == ED_DIST ? (xi - yi) * (xi - yi) : xi * yi;
+			dot += (long long) a[i] * b[i];
+			dot_aa += (long long) a[i] * a[i];
+			dot_bb += (long long) b[i] * b[i];
+			sum_a += a[i];
+			sum_b += b[i];
+		}
+
+		float fr[2] = {(float) r[0], (float) r[1]};
+		float fm[2] = {(float) mn[0], (float) mn[1]};
+		float float_dist;
+		__int128 fxp_dist;
+		__int128 fxp_norm;
+
+		if (dist_func == ED_DIST)
+		{
+			float fd = fm[0] - fm[1];
+			float_dist = fr[0] * fr[0] * (float) dot_aa + fr[1] * fr[1] * (float) dot_bb - 2 * fr[0] * fr[1] * (float) dot
+					+ 2 * fr[0] * fd * (float) sum_a - 2 * fr[1] * fd * (float) sum_b + (float) num_inputs * fd * fd;
+
+			__int128 d = mq[0] - mq[1];
+			fxp_dist = (__int128) rq[0] * rq[0] * dot_aa + (__int128) rq[1] * rq[1] * dot_bb - 2 * (__int128) rq[0] * rq[1] * dot
+					+ (((__int128) rq[0] * d * sum_a - (__int128) rq[1] * d * sum_b) << (il + 1)) + ((num_inputs * d * d) << (2 * il));
+		}
+		else
+		{
+			float_dist = fr[0] * fr[1] * (float) dot + fr[0] * fm[1] * (float) sum_a + fm[0] * fr[1] * (float) sum_b
+					+ fm[0] * fm[1] * (float) num_inputs;
+
+			fxp_dist = (__int128) rq[0] * rq[1] * dot + (((__int128) rq[0] * mq[1] * sum_a + (__int128) mq[0] * rq[1] * sum_b) << il)
+					+ (((__int128) mq[0] * mq[1] * num_inputs) << (2 * il));
+		}
+
+		fxp_norm = (__int128) rq[0] * rq[0] * dot_aa + (((__int128) rq[0] * mq[0] * sum_a) << (il + 1))
+				+ (((__int128) mq[0] * mq[0] * num_inputs) << (2 * il));
+		fxp_norm -= (__int128) 1 << (2 * G);
+		norm_check_failures += (fxp_norm > ((__int128) tol << (2 * il))) || (fxp_norm < -((__int128) tol << (2 * il)));
+
+		long double fxp_val = ldexpl((long double) fxp_dist, -2 * G);
+		long double fxp_err = fabsl(fxp_val - exact);
+		long double float_err = fabsl(float_dist - exact);
+		long double fxp_float_diff = fabsl(fxp_val - float_dist);
+
+		max_fxp_err = fxp_err > max_fxp_err ? fxp_err : max_fxp_err;
+		max_float_err = float_err > max_float_err ? float_err : max_float_err;
+		max_fxp_float_diff = fxp_float_diff > max_fxp_float_diff ? fxp_float_diff : max_fxp_float_diff;
+		decision_mismatches += fxp_threshold_decision(comp_type, threshold, fxp_val) != fxp_threshold_decision(comp_type, threshold, float_dist);
+	}
+
+	printf("\nFixed point error report (%s, range and min as %d-bit ints with %d and %d fraction bits, distance in %d bits)\n",
+			dist_func == ED_DIST ? "squared euclidean distance" : "cosine similarity", Fixed_Point_Length_, G, F, W_FXP_);
+	printf("Analytic bound on |fixed point - exact| for unit vectors: %.3Le\n", bound);
+	printf("Norm check tolerance: %.3Le\n", ldexpl((long double) tol, -2 * F));
+	printf("Over %d random vector pairs (%d skipped, range or min out of fixed point range):\n", num_trials, out_of_range);
+	printf("\tmax |fixed point - exact|: %.3Le\n", max_fxp_err);
+	printf("\tmax |float - exact|: %.3Le\n", max_float_err);
+	printf("\tmax |fixed point - float|: %.3Le\n", max_fxp_float_diff);
+	printf("\tthreshold decisions differing from float: %d\n", decision_mismatches);
+	printf("\tnorm checks failed on unit vectors: %d\n\n", norm_check_failures);
+}
+
+
+
+
+/////////	Enrollment-Time Precomputation
+
+
+
+//with Precomputed_Enrollment_ set, cs and ed read the terms that depend on the enrollment input alone from extra circuit
+//inputs that directly follow it, rather than computing them in every authentication
+//they are computed once, in the clear, at enrollment, and secret-shared and committed to along with the template
+//float: ed reads r_e^2 sum(b_i^2) then r_e sum(b_i), cs reads r_e sum(b_i) + n m_e, each as 32 raw IEEE bits
+//fxp: ed reads r_e^2 sum(b_i^2) in W_FXP_ bits then r_e sum(b_i) in L + m_sum + 1, cs reads r_e sum(b_i) + 2^il n m_e
+//in L + m_sum + 2, as signed ints on the same scale as in build_euclidean_fxp() and build_cosine_fxp()
+
+int precomputed_input_size(int dist_func, int num_inputs, int input_length)
+{
+	int l = Fixed_Point_Length_;
+	int m_sum = input_length + 1 + lg_flr(num_inputs - 1);
+
+	if (!Fixed_Point_)
+		return dist_func == ED_DIST ? 2 * 32 : 32;
+
+	return dist_func == ED_DIST ? (W_FXP_) + l + m_sum + 1 : l + m_sum + 2;
+}
+
+
+static void set_precomputed_bits(__int128 value, int length, int *outputs)
+{
+	for (int i = 0; i < length; i++)
+		outputs[i] = (int) ((value >> (i < 127 ? i : 127)) & 1);
+}
+
+
+static long long get_input_bits(int *inputs, int length, int int_repr)
+{
+	long long value = 0;
+
+	for (int i = 0; i < length; i++)
+		value |= (long long) (inputs[i] & 1) << i;
+	if ((int_repr == SIGNED) && (length < 64) && inputs[length - 1])
+		value -= 1LL << length;
+
+	return value;
+}
+
+
+//enrollment_inputs holds the enrollment biometric input as laid out in the circuit, one bit per int,
+//and outputs receives the precomputed_input_size() bits that follow it
+
+void precompute_enrollment_inputs(int dist_func, int num_inputs, int input_length, int *enrollment_inputs, int *outputs)
+{
+	int l = Fixed_Point_Length_;
+	int m_sum = input_length + 1 + lg_flr(num_inputs - 1);
+	int feature_vector_length = num_inputs * input_length;
+	long long sum = 0;
+	long long sqr_sum = 0;
+
+	for (int i = 0; i < num_inputs; i++)
+	{
+		long long b = get_input_bits(&enrollment_inputs[i * input_length], input_length, UNSIGNED);
+		sum += b;
+		sqr_sum += b * b;
+	}
+
+	if (!Fixed_Point_)
+	{
+		unsigned int raw[2];
+		float range, min, values[2];
+
+		raw[0] = (unsigned int) get_input_bits(&enrollment_inputs[feature_vector_length], 32, UNSIGNED);
+		raw[1] = (unsigned int) get_input_bits(&enrollment_inputs[feature_vector_length + 32], 32, UNSIGNED);
+		memcpy(&range, &raw[0], sizeof(float));
+		memcpy(&min, &raw[1], sizeof(float));
+
+		if (dist_func == ED_DIST)
+		{
+			values[0] = range * range * (float) sqr_sum;
+			values[1] = range * (float) sum;
+		}
+		else
+			values[0] = range * (float) sum + (float) num_inputs * min;
+
+		memcpy(raw, values, sizeof(raw));
+		for (int j = 0; j < (dist_func == ED_DIST ? 2 : 1); j++)
+			set_precomputed_bits(raw[j], 32, &outputs[32 * j]);
+		return;
+	}
+
+	__int128 range = get_input_bits(&enrollment_inputs[feature_vector_length], l, SIGNED);
+	__int128 min = get_input_bits(&enrollment_inputs[feature_vector_length + 32], l, SIGNED);
+
+	if (dist_func == ED_DIST)
+	{
+		set_precomputed_bits(range * range * sqr_sum, W_FXP_, outputs);
+		set_precomputed_bits(range * sum, l + m_sum + 1, &outputs[W_FXP_]);
+	}
+	else
+		set_precomputed_bits(range * sum + ((num_inputs * min) << input_length), l + m_sum + 2, outputs);
+}
+
+
+
+//garbles the circuit and evaluates it on the given input bits, writing the output bits
+
+static void evaluate_on_inputs(GarbledCircuit *garbledCircuit, int *inputs, int *outputs)
+{
+	int n = garbledCircuit->n;
+	int m = garbledCircuit->m;
+	block *input_labels = (block*) malloc(sizeof(block) * 2 * n);
+	block *extracted_labels = (block*) malloc(sizeof(block) * n);
+	block output_map[2 * m];
+	block eval_map[m];
+
+	garbleCircuit(garbledCircuit, input_labels, output_map);
+	extractLabels(extracted_labels, input_labels, inputs, n);
+	evaluate(garbledCircuit, extracted_labels, eval_map);
+	mapOutputs(output_map, eval_map, outputs, m);
+
+	free(input_labels);
+	free(extracted_labels);
+}
+
+
+
+//uniform signed length-bit int
+
+static long long fxp_random_int(int length)
+{
+	long long bits = ((long long) rand() << 31) ^ rand();
+
+	return (bits & ((1LL << length) - 1)) - (1LL << (length - 1));
+}
+
+
+
+//evaluates a pre_ circuit and the circuit it replaces on the same compressed random unit vectors as fxp_error_report(),
+//with the enrollment-only inputs of the pre_ circuit filled in by precompute_enrollment_inputs(), and returns the number
+//of trials whose outputs differ, or -1 if the circuits cannot be read or do not match in shape
+//unit vectors never cross the fixed thresholds, so every other trial draws range and min from the whole fixed point
+//range instead, which makes the threshold comparison go both ways
+//fixed point only, float pre_ circuits are checked by float_value_check() instead; commitment inputs are random bits
+
+int precomputed_enrollment_check(int dist_func, int num_inputs, int input_length, char *pre_circuit_file, char *circuit_file, int num_trials)
+{
+	GarbledCircuit pre_circuit;
+	GarbledCircuit circuit;
+
+	if (readCircuitFromFile(&pre_circuit, pre_circuit_file) == FAILURE)
+		return -1;
+	if (readCircuitFromFile(&circuit, circuit_file) == FAILURE)
+	{
+		removeGarbledCircuit(&pre_circuit);
+		return -1;
+	}
+
+	int F = Fixed_Point_Frac_Bits_;
+	int G = FXP_RANGE_FRAC_BITS;
+	int l = Fixed_Point_Length_;
+	long double fxp_limit = ldexpl(1, l - 1);
+	int feature_vector_length = num_inputs * input_length;
+	int biometric_input_size = feature_vector_length + 64;
+	int precomputed_size = precomputed_input_size(dist_func, num_inputs, input_length);
+	int n = circuit.n;
+	int m = circuit.m;
+
+	if ((pre_circuit.n != n + precomputed_size) || (pre_circuit.m != m) || (n < 2 * biometric_input_size))
+	{
+		printf("\nCircuits %s and %s do not differ by the precomputed inputs alone\n", pre_circuit_file, circuit_file);
+		removeGarbledCircuit(&pre_circuit);
+		removeGarbledCircuit(&circuit);
+		return -1;
+	}
+
+	int *inputs = (int*) malloc(sizeof(int) * n);
+	int *pre_inputs = (int*) malloc(sizeof(int) * (n + precomputed_size));
+	int outputs[m];
+	int pre_outputs[m];
+	int mismatches = 0;
+	int out_of_range = 0;
+
+	long double x[num_inputs];
+	long double y[num_inputs];
+	int a[num_inputs];
+	int b[num_inputs];
+	int *vectors[2] = {a, b};
+
+	for (int t = 0; t < num_trials; t++)
+	{
+		long double closeness = (long double) t / num_trials;
+
+		memset(x, 0, sizeof(x));
+		fxp_random_unit_vector(num_inputs, x);
+		for (int i = 0; i < num_inputs; i++)
+			y[i] = x[i] * num_inputs * closeness;
+		fxp_random_unit_vector(num_inputs, y);
+
+		long double r[2], mn[2];
+		fxp_compress(num_inputs, input_length, x, a, &r[0], &mn[0]);
+		fxp_compress(num_inputs, input_length, y, b, &r[1], &mn[1]);
+
+		long long rq[2], mq[2];
+		int in_range = 1;
+		for (int j = 0; j < 2; j++)
+		{
+			rq[j] = (t & 1) ? fxp_random_int(l) : llroundl(ldexpl(r[j], G));
+			mq[j] = (t & 1) ? fxp_random_int(l) : llroundl(ldexpl(mn[j], F));
+			in_range &= (llabs(rq[j]) < fxp_limit) && (llabs(mq[j]) < fxp_limit);
+		}
+		if (!in_range)
+		{
+			out_of_range++;
+			continue;
+		}
+
+		for (int i = 0; i < n; i++)
+			inputs[i] = rand() % 2;
+		memset(inputs, 0, 2 * biometric_input_size * sizeof(int));
+		for (int j = 0; j < 2; j++)
+		{
+			int *biom_input = &inputs[j * biometric_input_size];
+			for (int i = 0; i < num_inputs; i++)
+				set_precomputed_bits(vectors[j][i], input_length, &biom_input[i * input_length]);
+			set_precomputed_bits(rq[j], l, &biom_input[feature_vector_length]);
+			set_precomputed_bits(mq[j], l, &biom_input[feature_vector_length + 32]);
+		}
+
+		memcpy(pre_inputs, inputs, 2 * biometric_input_size * sizeof(int));
+		precompute_enrollment_inputs(dist_func, num_inputs, input_length, &inputs[biometric_input_size], &pre_inputs[2 * biometric_input_size]);
+		memcpy(&pre_inputs[2 * biometric_input_size + precomputed_size], &inputs[2 * biometric_input_size], (n - 2 * biometric_input_size) * sizeof(int));
+
+		evaluate_on_inputs(&circuit, inputs, outputs);
+		evaluate_on_inputs(&pre_circuit, pre_inputs, pre_outputs);
+		mismatches += memcmp(outputs, pre_outputs, sizeof(outputs)) != 0;
+	}
+
+	printf("\nPrecomputed enrollment check (%s against %s):\n", pre_circuit_file, circuit_file);
+	printf("\toutputs differing over %d random vector pairs, half with random range and min (%d skipped, range or min out of fixed point range): %d\n\n",
+			num_trials, out_of_range, mismatches);
+
+	free(inputs);
+	free(pre_inputs);
+	removeGarbledCircuit(&pre_circuit);
+	removeGarbledCircuit(&circuit);
+	return mismatches;
+}
+
+
+
+//evaluates a float cs or ed circuit (pre_ or not, as Precomputed_Enrollment_ says) on compressed random unit vectors,
+//and compares its threshold decision and norm check with those on the exact distance and norm of its inputs,
+//returning the number of trials where either differs, or -1 if the circuit cannot be read or does not match in shape
+//every other trial scales range and min of both vectors by up to 16, so that the distance crosses the threshold and the
+//runtime norm is off by more than FLOAT_NORM_TOLERANCE; cs also flips the enrollment vector in half of those trials
+//trials whose exact distance or norm lies within 2^-16 of the sum of the absolute expansion terms of a threshold are
+//not counted, since truncating float arithmetic may go either way there
+
+int float_value_check(int dist_func, int num_inputs, int input_length, char *circuit_file, int num_trials)
+{
+	GarbledCircuit circuit;
+
+	if (readCircuitFromFile(&circuit, circuit_file) == FAILURE)
+		return -1;
+
+	int feature_vector_length = num_inputs * input_length;
+	int biometric_input_size = feature_vector_length + 64;
+	int precomputed_size = Precomputed_Enrollment_ ? precomputed_input_size(dist_func, num_inputs, input_length) : 0;
+	int n = circuit.n;
+	int m = circuit.m;
+
+	if ((n < 2 * biometric_input_size + precomputed_size) || (m < 2))
+	{
+		printf("\nCircuit %s does not take two float biometric inputs\n", circuit_file);
+		removeGarbledCircuit(&circuit);
+		return -1;
+	}
+
+	int comp_type = dist_func == ED_DIST ? LES : GRT;
+	long double threshold = dist_func == ED_DIST ? (1 << 6) : (1 - (1 << 6));
+
+	int *inputs = (int*) malloc(sizeof(int) * n);
+	int outputs[m];
+	int mismatches = 0;
+	int near_threshold = 0;
+
+	long double x[num_inputs];
+	long double y[num_inputs];
+	int a[num_inputs];
+	int b[num_inputs];
+	int *vectors[2] = {a, b};
+
+	for (int t = 0; t < num_trials; t++)
+	{
+		long double closeness = (long double) t / num_trials;
+		long double scale = (t & 1) ? powl(2, 4 * (long double) rand() / RAND_MAX) : 1;
+
+		memset(x, 0, sizeof(x));
+		fxp_random_unit_vector(num_inputs, x);
+		for (int i = 0; i < num_inputs; i++)
+			y[i] = x[i] * num_inputs * closeness * (((t & 3) == 3) && (dist_func == CS_DIST) ? -1 : 1);
+		fxp_random_unit_vector(num_inputs, y);
+
+		long double r[2], mn[2];
+		fxp_compress(num_inputs, input_length, x, a, &r[0], &mn[0]);
+		fxp_compress(num_inputs, input_length, y, b, &r[1], &mn[1]);
+
+		float fr[2], fm[2];
+		for (int i = 0; i < n; i++)
+			inputs[i] = rand() % 2;
+		for (int j = 0; j < 2; j++)
+		{
+			int *biom_input = &inputs[j * biometric_input_size];
+			unsigned int raw;
+
+			fr[j] = (float) (r[j] * scale);
+			fm[j] = (float) (mn[j] * scale);
+			for (int i = 0; i < num_inputs; i++)
+				set_precomputed_bits(vectors[j][i], input_length, &biom_input[i * input_length]);
+			memcpy(&raw, &fr[j], sizeof(raw));
+			set_precomputed_bits(raw, 32, &biom_input[feature_vector_length]);
+			memcpy(&raw, &fm[j], sizeof(raw));
+			set_precomputed_bits(raw, 32, &biom_input[feature_vector_length + 32]);
+		}
+		if (Precomputed_Enrollment_)
+			precompute_enrollment_inputs(dist_func, num_inputs, input_length, &inputs[biometric_input_size], &inputs[2 * biometric_input_size]);
+
+		long double dist = 0, norm = 0;
+		long double sum_a = 0, sum_b = 0, dot = 0, dot_aa = 0, dot_bb = 0;
+
+		for (int i = 0; i < num_inputs; i++)
+		{
+			long double xi = (long double) fr[0] * a[i] + fm[0];
+			long double yi = (long double) fr[1] * b[i] + fm[1];
+			dist += dist_func == ED_DIST ? (xi - yi) * (xi - yi) : xi * yi;
+			norm += xi * xi;
+			sum_a += a[i];
+			sum_b += b[i];
+			dot += (long double) a[i] * b[i];
+			dot_aa += (long double) a[i] * a[i];
+			dot_bb += (long double) b[i] * b[i];
+		}
+
+		long double r0 = fr[0], r1 = fr[1], m0 = fm[0], m1 = fm[1], d = fm[1] - fm[0];
+		long double dist_terms = dist_func == ED_DIST
+				? r0 * r0 * dot_aa + r1 * r1 * dot_bb + fabsl(2 * r0 * r1 * dot) + fabsl(2 * d * r1 * sum_b) + fabsl(2 * d * r0 * sum_a) + num_inputs * d * d
+				: fabsl(r0 * r1 * dot) + fabsl(m1 * r0 * sum_a) + fabsl(m0 * r1 * sum_b) + fabsl(num_inputs * m0 * m1);
+		long double norm_terms = r0 * r0 * dot_aa + fabsl(2 * r0 * m0 * sum_a) + num_inputs * m0 * m0;
+
+		if ((fabsl(dist - threshold) <= ldexpl(dist_terms, -16))
+				|| (fabsl(fabsl(norm - 1) - FLOAT_NORM_TOLERANCE) <= ldexpl(norm_terms, -16)))
+		{
+			near_threshold++;
+			continue;
+		}
+
+		evaluate_on_inputs(&circuit, inputs, outputs);
+		mismatches += (outputs[0] != fxp_threshold_decision(comp_type, threshold, dist)) || (outputs[1] != (fabsl(norm - 1) <= FLOAT_NORM_TOLERANCE));
+	}
+
+	printf("\nFloat value check (%s):\n", circuit_file);
+	printf("\toutputs differing from the exact threshold decision and norm check over %d random vector pairs, half with scaled range and min (%d skipped, too close to call): %d\n\n",
+			num_trials, near_threshold, mismatches);
+
+	free(inputs);
+	removeGarbledCircuit(&circuit);
+	return mismatches;
+}
@@ -235,9 +235,12 @@ int ADD_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 
 int SUM_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int num_inputs, int input_length, int *inputs, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	if (num_inputs < 2)
 	{
 		memcpy(outputs, inputs, num_inputs * input_length * sizeof(int));
+		popProfileRegion(garbledCircuit, garblingContext);
 		return 0;
 	}
 
@@ -268,6 +271,8 @@ int SUM_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext
 	}
 
 	memcpy(outputs, &add_pairs[0], output_length * sizeof(int));
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -662,6 +667,8 @@ int SHIFT_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingConte
 
 int OBLV_SHIFT_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int direction, int shift_type, int sign, int max_shift, int* oblv_shift_amt, int* inputs, int* outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int shift_bits = 1 + lg_flr(max_shift);
 	int not_oblv_shift_amt[shift_bits];
 	NOT_Circuit2(garbledCircuit, garblingContext, shift_bits, oblv_shift_amt, not_oblv_shift_amt);
@@ -686,6 +693,8 @@ int OBLV_SHIFT_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garbling
 	}
 
 	memcpy(outputs, shifted_input, n * sizeof(int));
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -774,6 +783,8 @@ if (toggling_sign)\
 
 int CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int comp_type, int* inputA, int* inputB, int* outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int split = n / 2;
 	int testing_eq_only = comp_type & 4;
 	int testing_strict_inequality = comp_type & 2;
@@ -801,6 +812,7 @@ int CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 			outputs[0] = is_not_eq;
 
 		handle_int_repr(EXIT);
+		popProfileRegion(garbledCircuit, garblingContext);
 		return 0;
 	}
 
@@ -833,6 +845,8 @@ int CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 	outputs[1] = is_not_eq;
 
 	handle_int_repr(EXIT);
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -887,6 +901,8 @@ int MUL_Circuit2(GarbledCircuit *garbledCircuit, GarblingContext *garblingContex
 
 int MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int *inputA, int *inputB, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int split = n / 2;
 
 	if (inputA == inputB)
@@ -894,6 +910,7 @@ int MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 		int stopping_split = split >> (1 + (lg_flr(split) >> 1));
 		SQUARE_2R_G_Circuit(garbledCircuit, garblingContext, n, inputA, outputs, stopping_split);
 
+		popProfileRegion(garbledCircuit, garblingContext);
 		return 0;
 	}
 
@@ -936,6 +953,8 @@ int MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 	}
 
 	memcpy(outputs, out_add, n * sizeof(int));
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -948,9 +967,19 @@ int DOTPROD_Circuit2(GarbledCircuit *garbledCircuit, GarblingContext *garblingCo
 
 
 // automatically calls optimized squaring routine on matching inputs
+// unsigned ints use the fused carry-save routine DOTPROD_CSA_Circuit_2I(), which computes the same output bits
 
 int DOTPROD_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int num_inputs, int input_length, int *inputA, int *inputB, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
+	if (Int_Representation_ == UNSIGNED)
+	{
+		DOTPROD_CSA_Circuit_2I(garbledCircuit, garblingContext, num_inputs, input_length, inputA, inputB, outputs);
+
+		popProfileRegion(garbledCircuit, garblingContext);
+		return 0;
+	}
 
 	int split = num_inputs * input_length;
 	int inputA_copy[split];
@@ -959,24 +988,184 @@ int DOTPROD_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garbling
 	memcpy(inputB_copy, inputB, split * sizeof(int));
 
 	int output_length = 2 * input_length + lg_flr(num_inputs);
-	int out_mul[num_inputs][output_length];
+	int out_mul[num_inputs][2 * input_length];	//SUM_Circuit() reads the products back to back
 
 	int zero = 0;
 	SETCONST_Circuit(garbledCircuit, garblingContext, output_length, &zero, outputs);
 
+	//NOTE every coordinate uses the same multiplier (or squaring) template, which MUL_Circuit_2I() picks on matching inputs
+	int *coordB = inputA == inputB ? inputA_copy : inputB_copy;
 	for (int i = 0; i < num_inputs; i++)
+		MUL_TMPL_Circuit_2I(garbledCircuit, garblingContext, 2 * input_length, &inputA_copy[i * input_length], &coordB[i * input_length], (int *) &out_mul[i]);
+
+	SUM_Circuit(garbledCircuit, garblingContext, num_inputs, 2 * input_length, (int *) out_mul, outputs);
+
+	popProfileRegion(garbledCircuit, garblingContext);
+}
+
+
+
+//reduces the bits placed in columns[c * column_size...] (column_count[c] of them, weight 2^c) to their sum, mod 2^output_length
+//columns are compressed with layers of full adders (Wallace-style carry-save reduction, 1 AND per full adder)
+//until no column holds more than two bits, and the two remaining rows are then added with one ripple-carry adder
+//column_size must bound the number of bits in a column, which reduction never increases beyond its largest initial count + 2
+//columns and column_count are left untouched
+
+#define COLUMN_BIT(cols, counts, c, wire) (cols)[(c) * column_size + (counts)[c]++] = (wire)
+
+static int CSA_COLUMNS_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int output_length, int column_size, int *in_columns, int *in_column_count, int *outputs)
+{
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
+	int *columns = (int*) malloc(sizeof(int) * output_length * column_size);
+	int *next_columns = (int*) malloc(sizeof(int) * output_length * column_size);
+	int *column_count = (int*) malloc(sizeof(int) * output_length);
+	int *next_count = (int*) calloc(output_length, sizeof(int));
+	int *swap;
+
+	memcpy(columns, in_columns, sizeof(int) * output_length * column_size);
+	memcpy(column_count, in_column_count, sizeof(int) * output_length);
+
+	int wire;
+	int out_add[2];
+	int reducing = 0;
+
+	for (int c = 0; c < output_length; c++)
+		reducing |= column_count[c] > 2;
+
+	while (reducing)
 	{
-		SETCONST_Circuit(garbledCircuit, garblingContext, lg_flr(num_inputs), &zero, &out_mul[i][2 * input_length]);
-		if (inputA == inputB)
+		reducing = 0;
+		memset(next_count, 0, output_length * sizeof(int));
+
+		for (int c = 0; c < output_length; c++)
 		{
-			int stopping_split = input_length >> (1 + (lg_flr(input_length) >> 1));
-			SQUARE_2R_G_Circuit(garbledCircuit, garblingContext, 2 * input_length, &inputA_copy[i * input_length], (int *) &out_mul[i], stopping_split);
+			int *bits = &columns[c * column_size];
+			int j = 0;
+
+			for (; column_count[c] - j >= 3; j += 3)
+			{
+				if (c == output_length - 1)	//carries out of the top column are dropped, so only the sum is needed
+				{
+					MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, bits[j], bits[j + 1], &wire);
+					MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, wire, bits[j + 2], &wire);
+					COLUMN_BIT(next_columns, next_count, c, wire);
+				}
+				else
+				{
+					ADD32_Circuit2(garbledCircuit, garblingContext, bits[j], bits[j + 1], bits[j + 2], out_add);
+					COLUMN_BIT(next_columns, next_count, c, out_add[0]);
+					COLUMN_BIT(next_columns, next_count, c + 1, out_add[1]);
+				}
+			}
+			for (; j < column_count[c]; j++)
+				COLUMN_BIT(next_columns, next_count, c, bits[j]);
+		}
+
+		swap = columns;	columns = next_columns;	next_columns = swap;
+		swap = column_count;	column_count = next_count;	next_count = swap;
+
+		for (int c = 0; c < output_length; c++)
+			reducing |= column_count[c] > 2;
+	}
+
+	//final carry-propagate addition of the (at most) two remaining rows
+
+	int carry = -1;
+	int in_add[3];
+	int num_add;
+
+	for (int c = 0; c < output_length; c++)
+	{
+		num_add = column_count[c];
+		memcpy(in_add, &columns[c * column_size], num_add * sizeof(int));
+		if (carry >= 0)
+			in_add[num_add++] = carry;
+		carry = -1;
+
+		if (num_add == 0)
+			outputs[c] = fixedZeroWire(garbledCircuit, garblingContext);
+		else if (num_add == 1)
+			outputs[c] = in_add[0];
+		else if (c == output_length - 1)
+		{
+			MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, in_add[0], in_add[1], &outputs[c]);
+			if (num_add == 3)
+				MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, outputs[c], in_add[2], &outputs[c]);
 		}
 		else
-			MUL_Circuit_2I(garbledCircuit, garblingContext, 2 * input_length, &inputA_copy[i * input_length], &inputB_copy[i * input_length], (int *) &out_mul[i]);
+		{
+			if (num_add == 2)
+				ADD22_Circuit2(garbledCircuit, garblingContext, in_add[0], in_add[1], out_add);
+			else
+				ADD32_Circuit2(garbledCircuit, garblingContext, in_add[0], in_add[1], in_add[2], out_add);
+			outputs[c] = out_add[0];
+			carry = out_add[1];
+		}
 	}
 
-	SUM_Circuit(garbledCircuit, garblingContext, num_inputs, 2 * input_length, (int *) out_mul, outputs);
+	free(columns);	free(next_columns);
+	free(column_count);	free(next_count);
+
+	popProfileRegion(garbledCircuit, garblingContext);
+	return 0;
+}
+
+
+
+//computes the dot product of unsigned ints with a single multi-operand adder instead of one multiplier per coordinate
+//the partial-product bits of all coordinates are placed in their columns and summed with CSA_COLUMNS_Circuit()
+//on matching inputs, a_j * a_k and a_k * a_j are merged into one bit one column higher and a_j * a_j == a_j
+//output length matches SUM_Circuit() on the products: 2 * input_length + 1 + lg_flr(num_inputs - 1)
+
+int DOTPROD_CSA_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int num_inputs, int input_length, int *inputA, int *inputB, int *outputs)
+{
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
+	int output_length = 2 * input_length + ((num_inputs < 2) ? 0 : 1 + lg_flr(num_inputs - 1));
+	int column_size = num_inputs * input_length + 4;	//bound on the number of bits in a column during reduction
+
+	int *columns = (int*) malloc(sizeof(int) * output_length * column_size);
+	int *column_count = (int*) calloc(output_length, sizeof(int));
+
+	int wire;
+	int *a, *b;
+
+	for (int i = 0; i < num_inputs; i++)
+	{
+		a = &inputA[i * input_length];
+		b = &inputB[i * input_length];
+
+		for (int j = 0; j < input_length; j++)
+		{
+			if (inputA == inputB)
+			{
+				if (2 * j < output_length)
+					COLUMN_BIT(columns, column_count, 2 * j, a[j]);
+				for (int k = j + 1; k < input_length && j + k + 1 < output_length; k++)
+				{
+					MIXED_OP_Gate(garbledCircuit, garblingContext, AND, a[j], a[k], &wire);
+					COLUMN_BIT(columns, column_count, j + k + 1, wire);
+				}
+			}
+			else
+			{
+				for (int k = 0; k < input_length && j + k < output_length; k++)
+				{
+					MIXED_OP_Gate(garbledCircuit, garblingContext, AND, a[j], b[k], &wire);
+					COLUMN_BIT(columns, column_count, j + k, wire);
+				}
+			}
+		}
+	}
+
+	CSA_COLUMNS_Circuit(garbledCircuit, garblingContext, output_length, column_size, columns, column_count, outputs);
+
+	free(columns);
+	free(column_count);
+
+	popProfileRegion(garbledCircuit, garblingContext);
+	return 0;
 }
 
 
@@ -991,11 +1180,16 @@ int DOTPROD_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garbling
 
 int SQUARE_2R_G_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int* inputs, int* outputs, int stopping_split)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int split = n / 2;
 	int internal_split = (split / 2) + (split % 2);
 
-	int input_copy[split];
+	//NOTE an odd split leaves the high half one bit short, so it is padded with a zero wire
+	int input_copy[2 * internal_split];
 	memcpy(input_copy, inputs, split * sizeof(int));
+	if (split % 2)
+		input_copy[split] = fixedZeroWire(garbledCircuit, garblingContext);
 
 	int *in_mult_lo = (int*) malloc(sizeof(int) * 2 * internal_split);
 	int *in_mult_mid = (int*) malloc(sizeof(int) * 2 * internal_split);
@@ -1053,6 +1247,8 @@ int SQUARE_2R_G_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblin
 	free(out_mult_lo);	free(out_mult_mid);	free(out_mult_hi);
 	free(in_add);	free(out_add);
 
+	popProfileRegion(garbledCircuit, garblingContext);
+
 }
 
 
@@ -1258,18 +1454,20 @@ int SET_CONST_FLOAT_CAST_Circuit(GarbledCircuit *garbledCircuit, GarblingContext
 	int sign = const_input < 0 ? 1 : 0;
 
 	int mant_mask = (1 << 23) - 1;
-	int exp_mask = ((1 << 30) - 1) ^ mant_mask;
-	int sign_mask = 1 << 31;
+	int exp_mask = ((1U << 31) - 1) ^ mant_mask;
+
+	int raw;
+	memcpy(&raw, &const_input, sizeof(int));
 
-	int mantissa = (int) ((float) const_input) & mant_mask;
-	int exponent = (int) ((float) const_input) & exp_mask;
+	int mantissa = raw & mant_mask;
+	int exponent = (raw & exp_mask) >> 23;
 
 	SETCONST_Circuit(garbledCircuit, garblingContext, 23, &mantissa, &outputs[MANTISSA]);
 	SETCONST_Circuit(garbledCircuit, garblingContext, 8, &exponent, &outputs[EXPONENT]);
 	SETCONST_Circuit(garbledCircuit, garblingContext, 1, &sign, &outputs[SIGN]);
 
 	outputs[EXP_ZERO_FLAG] = exponent == 0 ? fixedOneWire(garbledCircuit, garblingContext) : fixedZeroWire(garbledCircuit, garblingContext);
-	outputs[EXP_SPEC_FLAG] = exponent == -1 ? fixedOneWire(garbledCircuit, garblingContext) : fixedZeroWire(garbledCircuit, garblingContext);
+	outputs[EXP_SPEC_FLAG] = exponent == (exp_mask >> 23) ? fixedOneWire(garbledCircuit, garblingContext) : fixedZeroWire(garbledCircuit, garblingContext);
 	outputs[MANT_ZERO_FLAG] = mantissa == 0 ? fixedOneWire(garbledCircuit, garblingContext) : fixedZeroWire(garbledCircuit, garblingContext);
 	outputs[ZERO_FLAG] = const_input == 0 ? fixedOneWire(garbledCircuit, garblingContext) : fixedZeroWire(garbledCircuit, garblingContext);
 
@@ -1280,6 +1478,8 @@ int SET_CONST_FLOAT_CAST_Circuit(GarbledCircuit *garbledCircuit, GarblingContext
 
 int INT_TO_FLOAT_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int* inputs, int* outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int old_int_rep = Int_Representation_;
 	Int_Representation_ = UNSIGNED;
 
@@ -1289,62 +1489,51 @@ int INT_TO_FLOAT_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 		SET_CONST_FLOAT_Circuit(garbledCircuit, garblingContext, one, mask, zero, outputs);
 
 		Int_Representation_ = old_int_rep;
+		popProfileRegion(garbledCircuit, garblingContext);
 		return -1;
 	}
 
-	int k = n < 23 ? n : 23;
-	int l = 1 + lg_flr(k - 1);
+	//NOTE the input sits in the top n bits of a w-bit register, and is shifted left until its msb falls off the top,
+	//NOTE leaving the mantissa in the top 23 bits; inputs wider than 23 bits are truncated below those
+	int w = n < 23 ? 23 : n;
+	int l = 1 + lg_flr(n - 1);
+	int l_shift = 1 + lg_flr(n);
 	int nonzero_mant;
 
-	int msb_mask[23];
-	int shifted_input[23];
-	memcpy(shifted_input, &inputs[n-k], k * sizeof(int));
-
-	if (k < 23)
-	{
-		SETCONST_Circuit(garbledCircuit, garblingContext, 23 - k, &zero, &shifted_input[k]);
-		SETCONST_Circuit(garbledCircuit, garblingContext, 23 - k, &zero, &msb_mask[k]);
-	}
+	int msb_mask[n];
+	int shifted_input[w];
+	if (w > n)
+		SETCONST_Circuit(garbledCircuit, garblingContext, w - n, &zero, shifted_input);
+	memcpy(&shifted_input[w - n], inputs, n * sizeof(int));
 
 	int oblv_msb_index[8];
 
-	MSB_Circuit(garbledCircuit, garblingContext, k, MASK_AND_INDEX, shifted_input, msb_mask, oblv_msb_index, &nonzero_mant);
+	MSB_Circuit(garbledCircuit, garblingContext, n, MASK_AND_INDEX, inputs, msb_mask, oblv_msb_index, &nonzero_mant);
 	SETCONST_Circuit(garbledCircuit, garblingContext, 8 - l, &zero, &oblv_msb_index[l]);
 	memcpy(&outputs[EXPONENT], oblv_msb_index, 8 * sizeof(int));
 
-	if (n > k)
-	{
-		int exp_offset = n - k;
-		int exp_offset_bits[8];
-		SETCONST_Circuit(garbledCircuit, garblingContext, 8, &exp_offset, exp_offset_bits);
-		ADD_Circuit_2I(garbledCircuit, garblingContext, 16, NO_OVERFLOW, exp_offset_bits, &outputs[EXPONENT], &outputs[EXPONENT]);
-	}
-
-	if (k < 23)
-		SHIFT_Circuit(garbledCircuit, garblingContext, 23, 23 - k, LEFT, TRUNC, POSITIVE, shifted_input, shifted_input);
-
 	if (Int_Representation_ == SIGNED)
 	{
 		outputs[SIGN] = inputs[n-1];
-		int negative_input[23];
+		int negative_input[w];
 		int pos_sgnd_int;
 		int neg_sgnd_int = outputs[SIGN];
 		NOT_Gate2(garbledCircuit, garblingContext, neg_sgnd_int, &pos_sgnd_int);
-		NEG_Circuit(garbledCircuit, garblingContext, 23, shifted_input, negative_input);
-		BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, shifted_input, pos_sgnd_int, shifted_input);
-		BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, negative_input, neg_sgnd_int, negative_input);
-		MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 46, XOR, shifted_input, negative_input, shifted_input);
+		NEG_Circuit(garbledCircuit, garblingContext, w, shifted_input, negative_input);
+		BITMUL_Circuit_2I(garbledCircuit, garblingContext, w, shifted_input, pos_sgnd_int, shifted_input);
+		BITMUL_Circuit_2I(garbledCircuit, garblingContext, w, negative_input, neg_sgnd_int, negative_input);
+		MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * w, XOR, shifted_input, negative_input, shifted_input);
 	}
 	else
 		outputs[SIGN] = fixedZeroWire(garbledCircuit, garblingContext);
 
 	int shift_offset_bits[8];
-	int shift_offset = k + 1;
+	int shift_offset = n;
 
-	SETCONST_Circuit(garbledCircuit, garblingContext, l, &shift_offset, shift_offset_bits);
-	SETCONST_Circuit(garbledCircuit, garblingContext, 8 - l, &zero, &shift_offset_bits[l]);
-	SUB_Circuit_2I(garbledCircuit, garblingContext, 2*l, NO_UNDERFLOW, shift_offset_bits, oblv_msb_index, shift_offset_bits);
-	OBLV_SHIFT_Circuit(garbledCircuit, garblingContext, 23, LEFT, TRUNC, POSITIVE, k + 1, shift_offset_bits, shifted_input, &outputs[MANTISSA]);
+	SETCONST_Circuit(garbledCircuit, garblingContext, l_shift, &shift_offset, shift_offset_bits);
+	SUB_Circuit_2I(garbledCircuit, garblingContext, 2 * l_shift, NO_UNDERFLOW, shift_offset_bits, oblv_msb_index, shift_offset_bits);
+	OBLV_SHIFT_Circuit(garbledCircuit, garblingContext, w, LEFT, TRUNC, POSITIVE, n, shift_offset_bits, shifted_input, shifted_input);
+	memcpy(&outputs[MANTISSA], &shifted_input[w - 23], 23 * sizeof(int));
 
 	FLOAT_EXP_BIAS_Circuit(garbledCircuit, garblingContext, ADD, outputs, outputs);
 	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 8, &outputs[EXPONENT], nonzero_mant, &outputs[EXPONENT]);
@@ -1355,6 +1544,8 @@ int INT_TO_FLOAT_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 	outputs[ZERO_FLAG] = outputs[MANT_ZERO_FLAG];
 
 	Int_Representation_ = old_int_rep;
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -1517,155 +1708,22 @@ int FLOAT_CHECK_SPECIAL_BATCH_Circuit(GarbledCircuit *garbledCircuit, GarblingCo
 
 
 
-// function to add a vector of floats without normalizing between each addition
-// generalizes floating point representation to an arbitrary length mantissa
-//CAUTION this function is a helper function for FLOAT_SUM and does *not* provide output in 32 bit signle precision form
-
-#define VAR_MANTISSA (MANTISSA)
-#define VAR_MANT_ZERO_FLAG (MANT_ZERO_FLAG + num_overflow_bits)
-#define VAR_EXPONENT (EXPONENT + num_overflow_bits)
-#define VAR_EXP_ZERO_FLAG (EXP_ZERO_FLAG + num_overflow_bits)
-#define VAR_EXP_SPEC_FLAG (EXP_SPEC_FLAG + num_overflow_bits)
-#define VAR_ZERO_FLAG (ZERO_FLAG + num_overflow_bits)
-#define VAR_SIGN (SIGN + num_overflow_bits)
-#define VAR_SINGLE_LENGTH (SINGLE_LENGTH + num_overflow_bits)
-
-int FLOAT_ADD_RAW_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int num_overflow_bits, int *inputA, int *inputB, int *outputs)
-{
-	int old_int_rep = Int_Representation_;
-	Int_Representation_ = UNSIGNED;
-
-	int inputA_copy[VAR_SINGLE_LENGTH];
-	int inputB_copy[VAR_SINGLE_LENGTH];
-	memcpy(inputA_copy, inputA, VAR_SINGLE_LENGTH * sizeof(int));
-	memcpy(inputB_copy, inputB, VAR_SINGLE_LENGTH * sizeof(int));
-
-	int max_shift = 24 + num_overflow_bits;
-
-	int mantA[max_shift];
-	int mantB[max_shift];
-	memcpy(mantA, &inputA[VAR_MANTISSA], max_shift * sizeof(int));
-	memcpy(mantB, &inputB[VAR_MANTISSA], max_shift * sizeof(int));
-
-	int max_shift_bits[8];
-	int expA_minus_expB[8];
-	int expB_minus_expA[8];
-	int expA_geq_expB[2];
-	int expA_les_expB;
-	int overshift_A[2];
-	int overshift_B[2];
-
-	SETCONST_Circuit(garbledCircuit, garblingContext, 8, &max_shift, max_shift_bits);
-
-	SUB_Circuit_2I(garbledCircuit, garblingContext, 16, NO_UNDERFLOW, &inputA_copy[VAR_EXPONENT], &inputB_copy[VAR_EXPONENT], expA_minus_expB);
-	NEG_Circuit(garbledCircuit, garblingContext, 8, expA_minus_expB, expB_minus_expA);
-	CMP_Circuit_2I(garbledCircuit, garblingContext, 16, GEQ, expA_minus_expB, max_shift_bits, overshift_A);
-	CMP_Circuit_2I(garbledCircuit, garblingContext, 16, GEQ, expB_minus_expA, max_shift_bits, overshift_B);
-
-	CMP_Circuit_2I(garbledCircuit, garblingContext, 16, GEQ, &inputA_copy[VAR_EXPONENT], &inputB_copy[VAR_EXPONENT], expA_geq_expB);
-	NOT_Gate2(garbledCircuit, garblingContext, expA_geq_expB[0], &expA_les_expB);
-
-	int mixed_sign;
-	int same_sign;
-
-	MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, inputA_copy[VAR_SIGN], inputB_copy[VAR_SIGN], &mixed_sign);
-	NOT_Gate2(garbledCircuit, garblingContext, mixed_sign, &same_sign);
-
-	int shr_mantA[max_shift];
-	int shr_mantB[max_shift];
-	int mantA_plus_shrmantB[max_shift];
-	int mantB_plus_shrmantA[max_shift];
-	int mantA_minus_shrmantB[max_shift];
-	int mantB_minus_shrmantA[max_shift];
-
-	memcpy(shr_mantA, mantA, max_shift * sizeof(int));
-	memcpy(shr_mantB, mantB, max_shift * sizeof(int));
-
-	int test_case_1[max_shift];
-	int test_case_2[max_shift];
-	int test_condition_1;
-	int test_condition_2;
-	int test_condition_3;
-	int test_condition_4;
-	int mantA_grt_mantB[2];
-	int mantA_leq_mantB;
-	int candidate_mantissa[max_shift];
-	int candidate_sign;
-
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 8, expA_minus_expB, expA_geq_expB[0], test_case_1);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 8, expB_minus_expA, expA_les_expB, test_case_2);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 16, XOR, test_case_1, test_case_2, &outputs[VAR_EXPONENT]);
-
-	OBLV_SHIFT_Circuit(garbledCircuit, garblingContext, max_shift, RIGHT, TRUNC, POSITIVE, max_shift - 1, expA_minus_expB, shr_mantB, shr_mantB);
-	OBLV_SHIFT_Circuit(garbledCircuit, garblingContext, max_shift, RIGHT, TRUNC, POSITIVE, max_shift - 1, expB_minus_expA, shr_mantA, shr_mantA);
-
-	ADD_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, NO_OVERFLOW, mantA, shr_mantB, mantA_plus_shrmantB);
-	ADD_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, NO_OVERFLOW, shr_mantA, mantB, mantB_plus_shrmantA);
-	SUB_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, NO_UNDERFLOW, mantA, shr_mantB, mantA_minus_shrmantB);
-	SUB_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, NO_UNDERFLOW, mantB, shr_mantA, mantB_minus_shrmantA);
-
-	//case: overshift
-
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, max_shift, mantA, overshift_A[0], test_case_1);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, max_shift, mantB, overshift_B[0], test_case_2);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, XOR, test_case_1, test_case_2, candidate_mantissa);
-
-	//case: same sign
-
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, expA_geq_expB[0], same_sign, &test_condition_1);
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, expA_les_expB, same_sign, &test_condition_2);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, max_shift, mantA_plus_shrmantB, test_condition_1, test_case_1);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, max_shift, mantB_plus_shrmantA, test_condition_2, test_case_2);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, XOR, test_case_1, test_case_2, test_case_1);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, XOR, test_case_1, candidate_mantissa, candidate_mantissa);
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, inputB[VAR_SIGN], same_sign, &outputs[VAR_SIGN]);
-
-	//case: mixed sign
-
-	//NOTE computing mantA_grt_mantB is only relevant when expA == expB, but must be considered for the expA >= expB case
-	//NOTE and is used to compute the output sign
-	CMP_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, GRT, mantA, mantB, mantA_grt_mantB);
-	NOT_Gate2(garbledCircuit, garblingContext, expA_geq_expB[0], &mantA_leq_mantB);
-
-	MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, inputB[VAR_SIGN], mantA_grt_mantB[0], &candidate_sign);
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, candidate_sign, mixed_sign, &candidate_sign);
-	MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, candidate_sign, outputs[VAR_SIGN], &outputs[VAR_SIGN]);
-
-	//mixed sign subcase: exp A >= exp B
-
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, expA_geq_expB[0], mixed_sign, &test_condition_1);
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, test_condition_1, mantA_grt_mantB[0], &test_condition_3);
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, test_condition_1, mantA_leq_mantB, &test_condition_4);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, max_shift, mantA_minus_shrmantB, test_condition_3, test_case_1);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, max_shift, mantB_minus_shrmantA, test_condition_4, test_case_2);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, XOR, test_case_1, test_case_2, test_case_1);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, XOR, candidate_mantissa, test_case_1, candidate_mantissa);
-
-	//mixed sign subcase: expB > exp A
-
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, expA_les_expB, mixed_sign, &test_condition_2);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, max_shift, mantB_minus_shrmantA, test_condition_2, test_case_2);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * max_shift, XOR, candidate_mantissa, test_case_2, candidate_mantissa);
-
-	memcpy(&outputs[VAR_MANTISSA], candidate_mantissa, max_shift * sizeof(int));
-	//NOTE VAR_*_ZERO_FLAGs will be set after the call to FLOAT_CHECK_ZERO() and the following values are placeholders
-	//NOTE meanwhile, VAR_EXP_SPEC_FLAG = 0 for assumed normal outputs
-	outputs[VAR_EXP_ZERO_FLAG] = inputA_copy[VAR_EXP_ZERO_FLAG];
-	outputs[VAR_MANT_ZERO_FLAG] = inputA_copy[VAR_MANT_ZERO_FLAG];
-	outputs[VAR_EXP_SPEC_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
-	outputs[VAR_ZERO_FLAG] = inputA_copy[VAR_ZERO_FLAG];
-
-	Int_Representation_ = old_int_rep;
-}
-
-
+// fused multi-operand floating point sum: the largest exponent is found once, every mantissa is aligned to it once,
+// the aligned two's complement terms are added with one carry-save reduction, and the sum is normalized once
+// mantissas are aligned with FLOAT_SUM_GUARD_BITS extra low bits and the result is truncated, as in the other float circuits
+//CAUTION subnormal inputs are read with exponent 1, but a result below the normal range is flushed to zero
+//CAUTION a result above the normal range, like a special input, gives the fixed NaN
 
+#define FLOAT_SUM_GUARD_BITS 3
 
 int FLOAT_SUM_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int num_inputs, int *inputs, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	if (num_inputs < 2)
 	{
 		memcpy(outputs, inputs, SINGLE_LENGTH * sizeof(int));
+		popProfileRegion(garbledCircuit, garblingContext);
 		return 0;
 	}
 
@@ -1676,23 +1734,8 @@ int FLOAT_SUM_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingC
 	memcpy(input_copy, inputs, num_inputs * SINGLE_LENGTH * sizeof(int));
 
 	int num_overflow_bits = 1 + lg_flr(num_inputs - 1);
-
-	int add_pairs[num_inputs][VAR_SINGLE_LENGTH];
-	int num_pairs = num_inputs;
-
-	for (int i = 0; i < num_inputs; i++)
-	{
-		memcpy(&add_pairs[i][VAR_MANTISSA], &inputs[SINGLE_LENGTH*i + MANTISSA], 23 * sizeof(int));
-		memcpy(&add_pairs[i][VAR_EXPONENT], &inputs[SINGLE_LENGTH*i + EXPONENT], 8 * sizeof(int));
-		memcpy(&add_pairs[i][VAR_SIGN], &inputs[SINGLE_LENGTH*i + SIGN], sizeof(int));
-		add_pairs[i][VAR_EXP_ZERO_FLAG] = inputs[SINGLE_LENGTH*i + EXP_ZERO_FLAG];
-		add_pairs[i][VAR_MANT_ZERO_FLAG] = inputs[SINGLE_LENGTH*i + MANT_ZERO_FLAG];
-		add_pairs[i][VAR_EXP_SPEC_FLAG] = inputs[SINGLE_LENGTH*i + EXP_SPEC_FLAG];
-		add_pairs[i][VAR_ZERO_FLAG] = inputs[SINGLE_LENGTH*i + ZERO_FLAG];
-
-		SETCONST_Circuit(garbledCircuit, garblingContext, num_overflow_bits, &zero, &add_pairs[i][VAR_MANTISSA + 24]);
-		NOT_Gate2(garbledCircuit, garblingContext, inputs[SINGLE_LENGTH*i + EXP_ZERO_FLAG], &add_pairs[i][VAR_MANTISSA + 23]);
-	}
+	int aligned_length = 24 + FLOAT_SUM_GUARD_BITS;				//hidden bit at aligned_length - 1
+	int sum_length = aligned_length + num_overflow_bits + 1;	//two's complement, so |sum| < 2^(sum_length - 1)
 
 	int inputs_are_normal;
 	int special_outputs[SINGLE_LENGTH];
@@ -1700,73 +1743,153 @@ int FLOAT_SUM_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingC
 	inputs_are_normal = FLOAT_CHECK_SPECIAL_BATCH_Circuit(garbledCircuit, garblingContext, ADDITION, INFTY_EQ_NAN,
 														  num_inputs, SINGLE_LENGTH, input_copy, special_outputs);
 
-	int l = 1;
-	while (num_pairs > 1)
-	{
-		if (num_pairs % 2)
-			FLOAT_ADD_RAW_Circuit_2I(garbledCircuit, garblingContext, num_overflow_bits,
-									 (int *) &add_pairs[0], (int *) &add_pairs[l * (num_pairs - 1)], (int *) &add_pairs[0]);
-		num_pairs >>= 1;
+	//largest exponent
 
-		for (int i = 0; i < num_pairs; i++)
-			FLOAT_ADD_RAW_Circuit_2I(garbledCircuit, garblingContext, num_overflow_bits,
-									 (int *) &add_pairs[l * (2*i)], (int *) &add_pairs[l * (2*i + 1)], (int *) &add_pairs[l * (2*i)]);
-		l *= 2;
-	}
+	int exponents[num_inputs][8];
+	int max_exponent[8];
+	int exp_geq[2];
+	int max_case_1[8];
+	int max_case_2[8];
 
-	outputs[SIGN] = add_pairs[0][VAR_SIGN];
-	//NOTE VAR_*_ZERO_FLAGs will be set after the call to FLOAT_CHECK_ZERO() and the following values are placeholders
-	//NOTE meanwhile, VAR_EXP_SPEC_FLAG = 0 for assumed normal outputs is set in FLOAT_ADD_RAW*()
-	outputs[EXP_ZERO_FLAG] = add_pairs[0][VAR_EXP_ZERO_FLAG];
-	outputs[MANT_ZERO_FLAG] = add_pairs[0][VAR_MANT_ZERO_FLAG];
-	outputs[EXP_SPEC_FLAG] = add_pairs[0][VAR_EXP_SPEC_FLAG];
-	outputs[ZERO_FLAG] = add_pairs[0][ZERO_FLAG];
+	for (int i = 0; i < num_inputs; i++)
+	{
+		memcpy(exponents[i], &input_copy[SINGLE_LENGTH*i + EXPONENT], 8 * sizeof(int));
+		MIXED_OP_Gate(garbledCircuit, garblingContext, OR, exponents[i][0], input_copy[SINGLE_LENGTH*i + EXP_ZERO_FLAG], &exponents[i][0]);
+	}
 
-	//normalization
+	memcpy(max_exponent, exponents[0], 8 * sizeof(int));
+	for (int i = 1; i < num_inputs; i++)
+	{
+		CMP_Circuit_2I(garbledCircuit, garblingContext, 16, GEQ, max_exponent, exponents[i], exp_geq);
+		MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 16, XOR, max_exponent, exponents[i], max_case_1);
+		BITMUL_Circuit_2I(garbledCircuit, garblingContext, 8, max_case_1, exp_geq[0], max_case_2);
+		MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 16, XOR, exponents[i], max_case_2, max_exponent);
+	}
 
-	int shifted_mantissa[24 + num_overflow_bits];
-	int inc_exponent[9];
+	//alignment, with the sign folded in as (mantissa ^ sign) + sign so that the carry-save reduction adds all terms at once
 
-	memcpy(shifted_mantissa, (int *) &add_pairs[0][VAR_MANTISSA], (24 + num_overflow_bits) * sizeof(int));
-	memcpy(inc_exponent, (int *) &add_pairs[0][VAR_EXPONENT], 8 * sizeof(int));
-	SETCONST_Circuit(garbledCircuit, garblingContext, 1, &zero, &inc_exponent[8]);
+	int shift_bits = 1 + lg_flr(aligned_length);
+	int column_size = 2 * num_inputs + 4;	//column 0 also takes the sign of every term
+	int columns[sum_length * column_size];
+	int column_count[sum_length];
+	memset(column_count, 0, sum_length * sizeof(int));
 
-	int overflow;
-	int msb_mask[num_overflow_bits];
-	int overflow_amt[8];
-	int overflow_repr_size = 1 + lg_flr(num_overflow_bits - 1);
+	for (int i = 0; i < num_inputs; i++)
+	{
+		int aligned[aligned_length];
+		int exp_diff[8];
+		int overshift;
+		int sign = input_copy[SINGLE_LENGTH*i + SIGN];
+
+		SETCONST_Circuit(garbledCircuit, garblingContext, FLOAT_SUM_GUARD_BITS, &zero, aligned);
+		memcpy(&aligned[FLOAT_SUM_GUARD_BITS], &input_copy[SINGLE_LENGTH*i + MANTISSA], 23 * sizeof(int));
+		NOT_Gate2(garbledCircuit, garblingContext, input_copy[SINGLE_LENGTH*i + EXP_ZERO_FLAG], &aligned[aligned_length - 1]);
+
+		SUB_Circuit3_2I(garbledCircuit, garblingContext, 16, NO_UNDERFLOW, max_exponent, exponents[i], exp_diff);
+		OBLV_SHIFT_Circuit(garbledCircuit, garblingContext, aligned_length, RIGHT, TRUNC, POSITIVE, aligned_length, exp_diff, aligned, aligned);
+
+		//NOTE the shift reads the low shift_bits bits of exp_diff, any higher bit shifts the whole mantissa out
+		overshift = exp_diff[shift_bits];
+		for (int j = shift_bits + 1; j < 8; j++)
+			MIXED_OP_Gate(garbledCircuit, garblingContext, OR, overshift, exp_diff[j], &overshift);
+		NOT_Gate2(garbledCircuit, garblingContext, overshift, &overshift);
+		BITMUL_Circuit_2I(garbledCircuit, garblingContext, aligned_length, aligned, overshift, aligned);
+
+		for (int j = 0; j < aligned_length; j++)
+		{
+			int wire;
+			MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, aligned[j], sign, &wire);
+			COLUMN_BIT(columns, column_count, j, wire);
+		}
+		for (int j = aligned_length; j < sum_length; j++)
+			COLUMN_BIT(columns, column_count, j, sign);
+		COLUMN_BIT(columns, column_count, 0, sign);
+	}
 
+	int sum[sum_length];
+	CSA_COLUMNS_Circuit(garbledCircuit, garblingContext, sum_length, column_size, columns, column_count, sum);
 
-	SETCONST_Circuit(garbledCircuit, garblingContext, 8 - overflow_repr_size, &zero, &overflow_amt[overflow_repr_size]);
-	MSB_Circuit(garbledCircuit, garblingContext, num_overflow_bits, MASK_AND_INDEX, &shifted_mantissa[24], msb_mask, overflow_amt, &overflow);
+	//normalization
 
-	OBLV_SHIFT_Circuit(garbledCircuit, garblingContext, 24 + num_overflow_bits, RIGHT, TRUNC, POSITIVE, num_overflow_bits, overflow_amt, shifted_mantissa, shifted_mantissa);
-	memcpy(&outputs[MANTISSA], shifted_mantissa, 23 * sizeof(int));
+	int sum_sign = sum[sum_length - 1];
+	int abs_length = sum_length - 1;
+	int abs_sum[abs_length];
+	int msb_mask[abs_length];
+	int index_length = 1 + lg_flr(abs_length - 1);
+	int msb_index[index_length];
+	int is_not_zero;
+
+	for (int j = 0; j < abs_length; j++)
+		MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, sum[j], sum_sign, &abs_sum[j]);
+	BITADD_Circuit_2I(garbledCircuit, garblingContext, abs_length, NO_OVERFLOW, abs_sum, sum_sign, abs_sum);
+
+	MSB_Circuit(garbledCircuit, garblingContext, abs_length, MASK_AND_INDEX, abs_sum, msb_mask, msb_index, &is_not_zero);
+
+	//NOTE shifting left by (abs_length - 1 - msb_index) puts the hidden bit at abs_length - 1
+	//NOTE and the result exponent is then max_exponent + num_overflow_bits - that shift
+	int top_index = abs_length - 1;
+	int shl_amt[9];
+	int top_bits[9];
+	int shl_amt_bits[9];
+	SETCONST_Circuit(garbledCircuit, garblingContext, 9, &top_index, top_bits);
+	memcpy(shl_amt_bits, msb_index, index_length * sizeof(int));
+	SETCONST_Circuit(garbledCircuit, garblingContext, 9 - index_length, &zero, &shl_amt_bits[index_length]);
+	SUB_Circuit3_2I(garbledCircuit, garblingContext, 18, NO_UNDERFLOW, top_bits, shl_amt_bits, shl_amt);
+
+	OBLV_SHIFT_Circuit(garbledCircuit, garblingContext, abs_length, LEFT, TRUNC, POSITIVE, top_index, shl_amt, abs_sum, abs_sum);
+
+	int biased_exponent[9];
+	int result_exponent[9];
+	int exp_underflow[2];
+	int exp_overflow[2];
+	int max_normal_exponent[9];
+	int max_normal = 254;
+	int overflow_bits_const[9];
+
+	memcpy(biased_exponent, max_exponent, 8 * sizeof(int));
+	SETCONST_Circuit(garbledCircuit, garblingContext, 1, &zero, &biased_exponent[8]);
+	SETCONST_Circuit(garbledCircuit, garblingContext, 9, &num_overflow_bits, overflow_bits_const);
+	ADD_Circuit_2I(garbledCircuit, garblingContext, 18, NO_OVERFLOW, biased_exponent, overflow_bits_const, biased_exponent);
+	CMP_Circuit_2I(garbledCircuit, garblingContext, 18, GEQ, shl_amt, biased_exponent, exp_underflow);
+	SUB_Circuit3_2I(garbledCircuit, garblingContext, 18, NO_UNDERFLOW, biased_exponent, shl_amt, result_exponent);
+	SETCONST_Circuit(garbledCircuit, garblingContext, 9, &max_normal, max_normal_exponent);
+	CMP_Circuit_2I(garbledCircuit, garblingContext, 18, GRT, result_exponent, max_normal_exponent, exp_overflow);
+
+	int nonzero_result;
+	int no_exp_underflow;
+	int no_exp_overflow;
+	NOT_Gate2(garbledCircuit, garblingContext, exp_underflow[0], &no_exp_underflow);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, is_not_zero, no_exp_underflow, &nonzero_result);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, exp_overflow[0], no_exp_underflow, &exp_overflow[0]);
+	NOT_Gate2(garbledCircuit, garblingContext, exp_overflow[0], &no_exp_overflow);
 
-	ADD_Circuit_2I(garbledCircuit, garblingContext, 16, OVERFLOW, inc_exponent, overflow_amt, inc_exponent);
-	memcpy(&outputs[EXPONENT], inc_exponent, 8 * sizeof(int));
+	int zero_bits[23];
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, &abs_sum[abs_length - 24], nonzero_result, &outputs[MANTISSA]);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 8, result_exponent, nonzero_result, &outputs[EXPONENT]);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, sum_sign, nonzero_result, &outputs[SIGN]);
+	SETCONST_Circuit(garbledCircuit, garblingContext, 23, &zero, zero_bits);
+	CMP_Circuit_2I(garbledCircuit, garblingContext, 46, EQ, &outputs[MANTISSA], zero_bits, &outputs[MANT_ZERO_FLAG]);
+	NOT_Gate2(garbledCircuit, garblingContext, nonzero_result, &outputs[EXP_ZERO_FLAG]);
+	outputs[ZERO_FLAG] = outputs[EXP_ZERO_FLAG];
+	outputs[EXP_SPEC_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
 
-	//NOTE exponent underflow is handled by construction of cases
-	//NOTE i.e. though some computation may involve exponent underflow, they will be masked out of the final output
-	int out_1[SINGLE_LENGTH];
-	int out_2[SINGLE_LENGTH];
-	int no_exp_overflow;
-	int exp_overflow = inc_exponent[8];
-	NOT_Gate2(garbledCircuit, garblingContext, exp_overflow, &no_exp_overflow);
+	//NOTE the result is muxed in as special ^ (normal & (result ^ special)), where normal excludes exponent overflow
 
 	int fixed_nan[SINGLE_LENGTH];
+	int mux_diff[SINGLE_LENGTH];
 	SET_CONST_FLOAT_Circuit(garbledCircuit, garblingContext, one, mask, zero, fixed_nan);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, fixed_nan, exp_overflow, out_1);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, outputs, no_exp_overflow, out_2);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, out_1, out_2, outputs);
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, outputs, fixed_nan, mux_diff);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, mux_diff, exp_overflow[0], mux_diff);
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, outputs, mux_diff, outputs);
 
-	FLOAT_CHECK_ZERO_Circuit(garbledCircuit, garblingContext, outputs, outputs);
-
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, inputs_are_normal, no_exp_overflow, &inputs_are_normal);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, outputs, inputs_are_normal, outputs);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, special_outputs, outputs, outputs);
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, outputs, special_outputs, mux_diff);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, mux_diff, inputs_are_normal, mux_diff);
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, special_outputs, mux_diff, outputs);
 
 	Int_Representation_ = old_int_rep;
+
+	popProfileRegion(garbledCircuit, garblingContext);
+	return 0;
 }
 
 
@@ -1785,6 +1908,8 @@ int FLOAT_NEG_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingC
 
 int FLOAT_MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int *inputA, int *inputB, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int old_int_rep = Int_Representation_;
 	Int_Representation_ = UNSIGNED;
 
@@ -1840,17 +1965,17 @@ int FLOAT_MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 
 	int in_xor[46];
 
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, &out_mul[24], no_mantmul_overflow, in_xor);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, &out_mul[25], mantmul_overflow, &in_xor[23]);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, &out_mul[23], no_mantmul_overflow, in_xor);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, &out_mul[24], mantmul_overflow, &in_xor[23]);
 
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 46, XOR, in_xor, &outputs[MANTISSA]);
 	BITADD_Circuit_2I(garbledCircuit, garblingContext, 8, NO_OVERFLOW, &outputs[EXPONENT], mantmul_overflow, &outputs[EXPONENT]);
-	//NOTE *_ZERO_FLAGs will be set after the call to FLOAT_CHECK_ZERO() and the following values are placeholders
-	//NOTE meanwhile, EXP_SPEC_FLAG = 0 for assumed normal outputs
-	outputs[EXP_ZERO_FLAG] = inputA_copy[EXP_ZERO_FLAG];
-	outputs[MANT_ZERO_FLAG] = inputA_copy[MANT_ZERO_FLAG];
+	//NOTE the product of nonzero normal inputs is nonzero, so the zero flags are cleared here, and zero inputs are muxed out below
+	//NOTE MANT_ZERO_FLAG is set once overflow and underflow are handled, and EXP_SPEC_FLAG = 0 for assumed normal outputs
+	outputs[EXP_ZERO_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
+	outputs[MANT_ZERO_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
 	outputs[EXP_SPEC_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
-	outputs[ZERO_FLAG] = inputA_copy[ZERO_FLAG];
+	outputs[ZERO_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
 
 	MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, inputA_copy[SIGN], inputB_copy[SIGN], &outputs[SIGN]);
 
@@ -1867,13 +1992,25 @@ int FLOAT_MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, nan_out, outputs, outputs);
 	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, zero_out, outputs, outputs);
 
-	FLOAT_CHECK_ZERO_Circuit(garbledCircuit, garblingContext, outputs, outputs);
-
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, inputs_are_normal, exp_normal, &inputs_are_normal);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, outputs, inputs_are_normal, outputs);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, special_outputs, outputs, outputs);
+	int zero_mant[23];
+	SETCONST_Circuit(garbledCircuit, garblingContext, 23, &zero, zero_mant);
+	CMP_Circuit_2I(garbledCircuit, garblingContext, 46, EQ, &outputs[MANTISSA], zero_mant, &outputs[MANT_ZERO_FLAG]);
+
+	//NOTE special_outputs is the fixed NaN for a special input and the float zero otherwise, so it is also the product of a zero input
+	//NOTE it is muxed in as special ^ (normal & (result ^ special)), as in FLOAT_SUM_Circuit()
+	int zero_input;
+	int nonzero_inputs;
+	int mux_diff[SINGLE_LENGTH];
+	MIXED_OP_Gate(garbledCircuit, garblingContext, OR, inputA_copy[ZERO_FLAG], inputB_copy[ZERO_FLAG], &zero_input);
+	NOT_Gate2(garbledCircuit, garblingContext, zero_input, &nonzero_inputs);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, inputs_are_normal, nonzero_inputs, &inputs_are_normal);
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, outputs, special_outputs, mux_diff);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, mux_diff, inputs_are_normal, mux_diff);
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, special_outputs, mux_diff, outputs);
 
 	Int_Representation_ = old_int_rep;
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -1881,6 +2018,8 @@ int FLOAT_MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 
 int FLOAT_SQUARE_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int *inputA, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int old_int_rep = Int_Representation_;
 	Int_Representation_ = UNSIGNED;
 
@@ -1892,9 +2031,11 @@ int FLOAT_SQUARE_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 	int inputA_copy[SINGLE_LENGTH];
 	memcpy(inputA_copy, inputA, SINGLE_LENGTH * sizeof(int));
 
+	//NOTE as in FLOAT_MUL_Circuit_2I(), 2 * exponent >= 384 overflows and 2 * exponent <= 126 underflows
 	int inc_exponent[8];
 	int exp_underflow;
-	int exp_overflow = inputA_copy[EXPONENT + 7];
+	int exp_overflow;
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, inputA_copy[EXPONENT + 7], inputA_copy[EXPONENT + 6], &exp_overflow);
 
 	SHIFT_Circuit(garbledCircuit, garblingContext, 8, 1, LEFT, TRUNC, POSITIVE, &inputA_copy[EXPONENT], inc_exponent);
 	memcpy(&outputs[EXPONENT], inc_exponent, 8 * sizeof(int));
@@ -1925,17 +2066,17 @@ int FLOAT_SQUARE_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 
 	int in_xor[46];
 
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, &out_mul[24], no_mantmul_overflow, in_xor);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, &out_mul[25], mantmul_overflow, &in_xor[23]);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, &out_mul[23], no_mantmul_overflow, in_xor);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, 23, &out_mul[24], mantmul_overflow, &in_xor[23]);
 
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 46, XOR, in_xor, &outputs[MANTISSA]);
 	BITADD_Circuit_2I(garbledCircuit, garblingContext, 8, NO_OVERFLOW, &outputs[EXPONENT], mantmul_overflow, &outputs[EXPONENT]);
-	//NOTE *_ZERO_FLAGs will be set after the call to FLOAT_CHECK_ZERO() and the following values are placeholders
-	//NOTE meanwhile, EXP_SPEC_FLAG = 0 for assumed normal outputs
-	outputs[EXP_ZERO_FLAG] = inputA_copy[EXP_ZERO_FLAG];
-	outputs[MANT_ZERO_FLAG] = inputA_copy[MANT_ZERO_FLAG];
+	//NOTE the product of nonzero normal inputs is nonzero, so the zero flags are cleared here, and zero inputs are muxed out below
+	//NOTE MANT_ZERO_FLAG is set once overflow and underflow are handled, and EXP_SPEC_FLAG = 0 for assumed normal outputs
+	outputs[EXP_ZERO_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
+	outputs[MANT_ZERO_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
 	outputs[EXP_SPEC_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
-	outputs[ZERO_FLAG] = inputA_copy[ZERO_FLAG];
+	outputs[ZERO_FLAG] = fixedZeroWire(garbledCircuit, garblingContext);
 
 	outputs[SIGN] = fixedZeroWire(garbledCircuit, garblingContext);
 
@@ -1952,13 +2093,25 @@ int FLOAT_SQUARE_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, nan_out, outputs, outputs);
 	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, zero_out, outputs, outputs);
 
-	FLOAT_CHECK_ZERO_Circuit(garbledCircuit, garblingContext, outputs, outputs);
-
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, inputs_are_normal, exp_normal, &inputs_are_normal);
-	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, outputs, inputs_are_normal, outputs);
-	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, special_outputs, outputs, outputs);
+	int zero_mant[23];
+	SETCONST_Circuit(garbledCircuit, garblingContext, 23, &zero, zero_mant);
+	CMP_Circuit_2I(garbledCircuit, garblingContext, 46, EQ, &outputs[MANTISSA], zero_mant, &outputs[MANT_ZERO_FLAG]);
+
+	//NOTE special_outputs is the fixed NaN for a special input and the float zero otherwise, so it is also the product of a zero input
+	//NOTE it is muxed in as special ^ (normal & (result ^ special)), as in FLOAT_SUM_Circuit()
+	int zero_input;
+	int nonzero_inputs;
+	int mux_diff[SINGLE_LENGTH];
+	zero_input = inputA_copy[ZERO_FLAG];
+	NOT_Gate2(garbledCircuit, garblingContext, zero_input, &nonzero_inputs);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, inputs_are_normal, nonzero_inputs, &inputs_are_normal);
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, outputs, special_outputs, mux_diff);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, mux_diff, inputs_are_normal, mux_diff);
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, special_outputs, mux_diff, outputs);
 
 	Int_Representation_ = old_int_rep;
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -1972,6 +2125,8 @@ int FLOAT_SQUARE_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 
 int FLOAT_CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int comp_type, int ininity_type, int *inputA, int *inputB, int* outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int old_int_rep = Int_Representation_;
 	Int_Representation_ = UNSIGNED;
 
@@ -1999,7 +2154,7 @@ int FLOAT_CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 	memcpy(mantB, &inputB_copy[MANTISSA], 23 * sizeof(int));
 
 	NOT_Gate2(garbledCircuit, garblingContext, inputA_copy[EXP_ZERO_FLAG], &mantA[23]);
-	NOT_Gate2(garbledCircuit, garblingContext, inputA_copy[EXP_ZERO_FLAG], &mantB[23]);
+	NOT_Gate2(garbledCircuit, garblingContext, inputB_copy[EXP_ZERO_FLAG], &mantB[23]);
 
 	int expA_cmp_expB[2];
 	int mantA_cmp_mantB[2];
@@ -2046,17 +2201,22 @@ int FLOAT_CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 		MIXED_OP_Gate(garbledCircuit, garblingContext, AND, outputs[0], no_nan_input_detected, &outputs[0]);
 		MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, outputs[0], nan_input_detected, &outputs[0]);
 
+		popProfileRegion(garbledCircuit, garblingContext);
 		return 0;
 	}
 
-	int true_cmp_by_sign = same_sign;
+	//NOTE with mixed signs the compared operand is greater when the other one is negative; with the same sign the
+	//NOTE magnitude comparison decides, and is reversed for negative operands unless the magnitudes are equal
+	int true_cmp_by_sign = mixed_sign;
 	int true_cmp_by_mant = mantA_cmp_mantB[0];
 	int true_cmp_by_mant_or_exp = expA_cmp_expB[0];
 
 	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, true_cmp_by_sign, branch == 0 ? inputB_copy[SIGN] : inputA_copy[SIGN], &true_cmp_by_sign);
 	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, true_cmp_by_mant, expA_eq_expB, &true_cmp_by_mant);
 	MIXED_OP_Gate(garbledCircuit, garblingContext, OR, true_cmp_by_mant_or_exp, true_cmp_by_mant, &true_cmp_by_mant_or_exp);
-	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, true_cmp_by_mant_or_exp, mixed_sign, &true_cmp_by_mant_or_exp);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, true_cmp_by_mant_or_exp, branch == 0 ? inputA_copy[SIGN] : inputB_copy[SIGN], &true_cmp_by_mant_or_exp);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, true_cmp_by_mant_or_exp, A_neq_B, &true_cmp_by_mant_or_exp);
+	MIXED_OP_Gate(garbledCircuit, garblingContext, AND, true_cmp_by_mant_or_exp, same_sign, &true_cmp_by_mant_or_exp);
 	MIXED_OP_Gate(garbledCircuit, garblingContext, OR, true_cmp_by_mant_or_exp, true_cmp_by_sign, &A_cmp_B);
 
 	if (testing_strict_inequality)
@@ -2078,12 +2238,16 @@ int FLOAT_CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garbli
 	MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, outputs[1], nan_input_detected, &outputs[1]);
 
 	Int_Representation_ = old_int_rep;
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
 
 int FLOAT_SHIFT_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int shift_amount, int direction, int infinity_type, int *inputA, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int old_int_rep = Int_Representation_;
 	Int_Representation_ = UNSIGNED;
 
@@ -2129,9 +2293,264 @@ int FLOAT_SHIFT_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblin
 	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, outputs, no_exp_flow, outputs);
 	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, flowed_outputs, outputs, outputs);
 
+	//NOTE zero is passed through, since shifting its zero exponent would give the smallest normal value
+	int zero_diff[SINGLE_LENGTH];
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, outputs, inputA_copy, zero_diff);
+	BITMUL_Circuit_2I(garbledCircuit, garblingContext, SINGLE_LENGTH, zero_diff, inputA_copy[ZERO_FLAG], zero_diff);
+	MIXED_OP_Circuit_2I(garbledCircuit, garblingContext, 2 * SINGLE_LENGTH, XOR, outputs, zero_diff, outputs);
+
 	Int_Representation_ = old_int_rep;
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
 
 
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/////////	Fixed point functions
+
+//NOTE fixed point values are two's complement ints of any length, read with an implicit number of fraction bits
+//NOTE there is no normalization, exponent alignment or special value handling
+//NOTE products keep all of their bits, so callers size their values such that nothing overflows
+
+
+
+//hardwires value * 2^shift into outputs[0..n-1], sign extended
+
+int FXP_SETCONST_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, long long value, int shift, int* outputs)
+{
+	for (int i = 0; i < n; i++)
+	{
+		int bit_idx = i - shift;
+		int this_bit_is_set;
+
+		if (bit_idx < 0)
+			this_bit_is_set = 0;
+		else if (bit_idx >= 8 * sizeof(long long))
+			this_bit_is_set = value < 0;
+		else
+			this_bit_is_set = (value >> bit_idx) & 1;
+
+		if (this_bit_is_set)
+			outputs[i] = fixedOneWire(garbledCircuit, garblingContext);
+		else
+			outputs[i] = fixedZeroWire(garbledCircuit, garblingContext);
+	}
+}
+
+
+
+//widens an n-bit int to out_length bits, repeating the msb for SIGNED ints and padding with zeros for UNSIGNED ones
+//no gates are needed, and inputs and outputs may be the same array
+
+int FXP_EXTEND_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int out_length, int int_repr, int* inputs, int* outputs)
+{
+	memmove(outputs, inputs, n * sizeof(int));
+
+	for (int i = n; i < out_length; i++)
+	{
+		if (int_repr == SIGNED)
+			outputs[i] = inputs[n - 1];
+		else
+			outputs[i] = fixedZeroWire(garbledCircuit, garblingContext);
+	}
+}
+
+
+
+//computes the full (lenA + lenB)-bit product of a lenA-bit and a lenB-bit signed int, whatever Int_Representation_ is
+//uses the Baugh-Wooley arrangement of the partial products to avoid sign extension, and sums them with CSA_COLUMNS_Circuit()
+//on matching inputs, a_j * a_k and a_k * a_j are merged into one bit one column higher and a_j * a_j == a_j
+//the product of an m-frac-bit value and an n-frac-bit value has m + n fraction bits
+
+int FXP_MUL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int lenA, int lenB, int *inputA, int *inputB, int *outputs)
+{
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
+	int output_length = lenA + lenB;
+	int column_size = (lenA < lenB ? lenA : lenB) + 5;	//bound on the number of bits in a column during reduction
+	int squaring = (inputA == inputB) && (lenA == lenB);
+
+	int *columns = (int*) malloc(sizeof(int) * output_length * column_size);
+	int *column_count = (int*) calloc(output_length, sizeof(int));
+
+	int wire;
+
+	for (int j = 0; j < lenA; j++)
+	{
+		for (int k = squaring ? j : 0; k < lenB; k++)
+		{
+			//partial products with exactly one sign bit carry negative weight, and are complemented
+			int inverted = (j == lenA - 1) != (k == lenB - 1);
+
+			if (squaring && (j == k))
+			{
+				COLUMN_BIT(columns, column_count, 2 * j, inputA[j]);
+				continue;
+			}
+
+			MIXED_OP_Gate(garbledCircuit, garblingContext, AND, inputA[j], inputB[k], &wire);
+			if (inverted)
+				NOT_Gate2(garbledCircuit, garblingContext, wire, &wire);
+
+			if (squaring)
+				COLUMN_BIT(columns, column_count, j + k + 1, wire);
+			else
+				COLUMN_BIT(columns, column_count, j + k, wire);
+		}
+	}
+
+	//Baugh-Wooley correction: 2^(lenA - 1) + 2^(lenB - 1) + 2^(lenA + lenB - 1)
+	COLUMN_BIT(columns, column_count, lenA - 1, fixedOneWire(garbledCircuit, garblingContext));
+	COLUMN_BIT(columns, column_count, lenB - 1, fixedOneWire(garbledCircuit, garblingContext));
+	COLUMN_BIT(columns, column_count, output_length - 1, fixedOneWire(garbledCircuit, garblingContext));
+
+	CSA_COLUMNS_Circuit(garbledCircuit, garblingContext, output_length, column_size, columns, column_count, outputs);
+
+	free(columns);
+	free(column_count);
+
+	popProfileRegion(garbledCircuit, garblingContext);
+	return 0;
+}
+
+
+
+//signed comparison of two n/2-bit ints, with the conventions of CMP_Circuit_2I()
+//inputA and inputB are left untouched
+//NOTE toggles the msbs itself and compares as unsigned, rather than relying on the SIGNED branch of CMP_Circuit_2I()
+
+int FXP_CMP_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int comp_type, int *inputA, int *inputB, int *outputs)
+{
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
+	int old_int_rep = Int_Representation_;
+	Int_Representation_ = UNSIGNED;
+
+	int split = n / 2;
+	int inputA_copy[split];
+	int inputB_copy[split];
+
+	REPR_SW_Circuit(garbledCircuit, garblingContext, 1, split, inputA, inputA_copy);
+	REPR_SW_Circuit(garbledCircuit, garblingContext, 1, split, inputB, inputB_copy);
+
+	CMP_Circuit_2I(garbledCircuit, garblingContext, n, comp_type, inputA_copy, inputB_copy, outputs);
+
+	Int_Representation_ = old_int_rep;
+
+	popProfileRegion(garbledCircuit, garblingContext);
+	return 0;
+}
+
+#undef COLUMN_BIT
+
+
+
+//template-cached routines: same as the routines they are named after, but each parameterization is built once and
+//copied in on later calls, see instantiateTemplate()
+//NOTE parameters hold Int_Representation_ wherever the routine reads it, and squaring (matching inputs) is a
+//NOTE parameter too, since templates only see copies of the input wires
+
+static int INT_TO_FLOAT_Template(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int *params, int *inputs, int *outputs)
+{
+	int old_int_rep = Int_Representation_;
+	Int_Representation_ = params[1];
+
+	INT_TO_FLOAT_Circuit(garbledCircuit, garblingContext, params[0], inputs, outputs);
+
+	Int_Representation_ = old_int_rep;
+
+	return 0;
+}
+
+int INT_TO_FLOAT_TMPL_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int* inputs, int* outputs)
+{
+	int params[] = { n, Int_Representation_ };
+
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+	int status = instantiateTemplate(garbledCircuit, garblingContext, INT_TO_FLOAT_Template, 2, params, n, SINGLE_LENGTH, inputs, outputs);
+	popProfileRegion(garbledCircuit, garblingContext);
+
+	return status;
+}
+
+
+static int FLOAT_MUL_Template(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int *params, int *inputs, int *outputs)
+{
+	FLOAT_MUL_Circuit_2I(garbledCircuit, garblingContext, inputs, &inputs[SINGLE_LENGTH], outputs);
+
+	return 0;
+}
+
+int FLOAT_MUL_TMPL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int *inputA, int *inputB, int *outputs)
+{
+	int inputs[2 * SINGLE_LENGTH];
+	memcpy(inputs, inputA, SINGLE_LENGTH * sizeof(int));
+	memcpy(&inputs[SINGLE_LENGTH], inputB, SINGLE_LENGTH * sizeof(int));
+
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+	int status = instantiateTemplate(garbledCircuit, garblingContext, FLOAT_MUL_Template, 0, NULL, 2 * SINGLE_LENGTH, SINGLE_LENGTH, inputs, outputs);
+	popProfileRegion(garbledCircuit, garblingContext);
+
+	return status;
+}
+
+
+//params: n, squaring, Int_Representation_
+static int MUL_Template(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int *params, int *inputs, int *outputs)
+{
+	int old_int_rep = Int_Representation_;
+	Int_Representation_ = params[2];
+
+	MUL_Circuit_2I(garbledCircuit, garblingContext, params[0], inputs, params[1] ? inputs : &inputs[params[0] / 2], outputs);
+
+	Int_Representation_ = old_int_rep;
+
+	return 0;
+}
+
+int MUL_TMPL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int *inputA, int *inputB, int *outputs)
+{
+	int split = n / 2;
+	int squaring = inputA == inputB;
+	int params[] = { n, squaring, Int_Representation_ };
+	int inputs[n];
+	memcpy(inputs, inputA, split * sizeof(int));
+	memcpy(&inputs[split], inputB, split * sizeof(int));
+
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+	int status = instantiateTemplate(garbledCircuit, garblingContext, MUL_Template, 3, params, squaring ? split : n, n, inputs, outputs);
+	popProfileRegion(garbledCircuit, garblingContext);
+
+	return status;
+}
+
+
+//params: lenA, lenB, squaring
+static int FXP_MUL_Template(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int *params, int *inputs, int *outputs)
+{
+	FXP_MUL_Circuit_2I(garbledCircuit, garblingContext, params[0], params[1], inputs, params[2] ? inputs : &inputs[params[0]], outputs);
+
+	return 0;
+}
+
+int FXP_MUL_TMPL_Circuit_2I(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int lenA, int lenB, int *inputA, int *inputB, int *outputs)
+{
+	int squaring = (inputA == inputB) && (lenA == lenB);
+	int params[] = { lenA, lenB, squaring };
+	int inputs[lenA + lenB];
+	memcpy(inputs, inputA, lenA * sizeof(int));
+	memcpy(&inputs[lenA], inputB, lenB * sizeof(int));
+
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+	int status = instantiateTemplate(garbledCircuit, garblingContext, FXP_MUL_Template, 3, params, squaring ? lenA : lenA + lenB, lenA + lenB, inputs, outputs);
+	popProfileRegion(garbledCircuit, garblingContext);
+
+	return status;
+}
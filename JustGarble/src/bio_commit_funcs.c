@@ -39,53 +39,200 @@
 //TODO make sure AESCircuits has been updated with this and other *_Circuit2() functions
 
 
+static int aes_gate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int type, int input0, int input1) {
+	int output = getNextWire(garblingContext);
+	if (type == XORGATE)
+		XORGate(garbledCircuit, garblingContext, input0, input1, output);
+	else if (type == NOTGATE)
+		NOTGate(garbledCircuit, garblingContext, input0, output);
+	else
+		ANDGate(garbledCircuit, garblingContext, input0, input1, output);
+	return output;
+}
+
+#define SB_XOR(a, b) aes_gate(garbledCircuit, garblingContext, XORGATE, a, b)
+#define SB_AND(a, b) aes_gate(garbledCircuit, garblingContext, ANDGATE, a, b)
+#define SB_XNOR(a, b) aes_gate(garbledCircuit, garblingContext, NOTGATE, SB_XOR(a, b), 0)
+
+//NOTE the AES S-box in 34 AND gates (Boyar and Peralta, "A depth-16 circuit for the AES S-box", 2011)
+//NOTE bytes are least significant bit first, as everywhere in aescircuits.c, and U[0] is the most significant bit
+//NOTE NewSBOXCircuit in circuits.c is not used here, as its outputs do not match the FIPS 197 S-box table
+int AES_SBOX_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int* inputs, int* outputs) {
+
+	int U[8];
+	for (int i = 0; i < 8; i++)
+		U[i] = inputs[7 - i];
+
+	int T1 = SB_XOR(U[0], U[3]);
+	int T2 = SB_XOR(U[0], U[5]);
+	int T3 = SB_XOR(U[0], U[6]);
+	int T4 = SB_XOR(U[3], U[5]);
+	int T5 = SB_XOR(U[4], U[6]);
+	int T6 = SB_XOR(T1, T5);
+	int T7 = SB_XOR(U[1], U[2]);
+	int T8 = SB_XOR(U[7], T6);
+	int T9 = SB_XOR(U[7], T7);
+	int T10 = SB_XOR(T6, T7);
+	int T11 = SB_XOR(U[1], U[5]);
+	int T12 = SB_XOR(U[2], U[5]);
+	int T13 = SB_XOR(T3, T4);
+	int T14 = SB_XOR(T6, T11);
+	int T15 = SB_XOR(T5, T11);
+	int T16 = SB_XOR(T5, T12);
+	int T17 = SB_XOR(T9, T16);
+	int T18 = SB_XOR(U[3], U[7]);
+	int T19 = SB_XOR(T7, T18);
+	int T20 = SB_XOR(T1, T19);
+	int T21 = SB_XOR(U[6], U[7]);
+	int T22 = SB_XOR(T7, T21);
+	int T23 = SB_XOR(T2, T22);
+	int T24 = SB_XOR(T2, T10);
+	int T25 = SB_XOR(T20, T17);
+	int T26 = SB_XOR(T3, T16);
+	int T27 = SB_XOR(T1, T12);
+	int M1 = SB_AND(T13, T6);
+	int M2 = SB_AND(T23, T8);
+	int M3 = SB_XOR(T14, M1);
+	int M4 = SB_AND(T19, U[7]);
+	int M5 = SB_XOR(M4, M1);
+	int M6 = SB_AND(T3, T16);
+	int M7 = SB_AND(T22, T9);
+	int M8 = SB_XOR(T26, M6);
+	int M9 = SB_AND(T20, T17);
+	int M10 = SB_XOR(M9, M6);
+	int M11 = SB_AND(T1, T15);
+	int M12 = SB_AND(T4, T27);
+	int M13 = SB_XOR(M12, M11);
+	int M14 = SB_AND(T2, T10);
+	int M15 = SB_XOR(M14, M11);
+	int M16 = SB_XOR(M3, M2);
+	int M17 = SB_XOR(M5, T24);
+	int M18 = SB_XOR(M8, M7);
+	int M19 = SB_XOR(M10, M15);
+	int M20 = SB_XOR(M16, M13);
+	int M21 = SB_XOR(M17, M15);
+	int M22 = SB_XOR(M18, M13);
+	int M23 = SB_XOR(M19, T25);
+	int M24 = SB_XOR(M22, M23);
+	int M25 = SB_AND(M22, M20);
+	int M26 = SB_XOR(M21, M25);
+	int M27 = SB_XOR(M20, M21);
+	int M28 = SB_XOR(M23, M25);
+	int M29 = SB_AND(M28, M27);
+	int M30 = SB_AND(M26, M24);
+	int M31 = SB_AND(M20, M23);
+	int M32 = SB_AND(M27, M31);
+	int M33 = SB_XOR(M27, M25);
+	int M34 = SB_AND(M21, M22);
+	int M35 = SB_AND(M24, M34);
+	int M36 = SB_XOR(M24, M25);
+	int M37 = SB_XOR(M21, M29);
+	int M38 = SB_XOR(M32, M33);
+	int M39 = SB_XOR(M23, M30);
+	int M40 = SB_XOR(M35, M36);
+	int M41 = SB_XOR(M38, M40);
+	int M42 = SB_XOR(M37, M39);
+	int M43 = SB_XOR(M37, M38);
+	int M44 = SB_XOR(M39, M40);
+	int M45 = SB_XOR(M42, M41);
+	int M46 = SB_AND(M44, T6);
+	int M47 = SB_AND(M40, T8);
+	int M48 = SB_AND(M39, U[7]);
+	int M49 = SB_AND(M43, T16);
+	int M50 = SB_AND(M38, T9);
+	int M51 = SB_AND(M37, T17);
+	int M52 = SB_AND(M42, T15);
+	int M53 = SB_AND(M45, T27);
+	int M54 = SB_AND(M41, T10);
+	int M55 = SB_AND(M44, T13);
+	int M56 = SB_AND(M40, T23);
+	int M57 = SB_AND(M39, T19);
+	int M58 = SB_AND(M43, T3);
+	int M59 = SB_AND(M38, T22);
+	int M60 = SB_AND(M37, T20);
+	int M61 = SB_AND(M42, T1);
+	int M62 = SB_AND(M45, T4);
+	int M63 = SB_AND(M41, T2);
+	int L0 = SB_XOR(M61, M62);
+	int L1 = SB_XOR(M50, M56);
+	int L2 = SB_XOR(M46, M48);
+	int L3 = SB_XOR(M47, M55);
+	int L4 = SB_XOR(M54, M58);
+	int L5 = SB_XOR(M49, M61);
+	int L6 = SB_XOR(M62, L5);
+	int L7 = SB_XOR(M46, L3);
+	int L8 = SB_XOR(M51, M59);
+	int L9 = SB_XOR(M52, M53);
+	int L10 = SB_XOR(M53, L4);
+	int L11 = SB_XOR(M60, L2);
+	int L12 = SB_XOR(M48, M51);
+	int L13 = SB_XOR(M50, L0);
+	int L14 = SB_XOR(M52, M61);
+	int L15 = SB_XOR(M55, L1);
+	int L16 = SB_XOR(M56, L0);
+	int L17 = SB_XOR(M57, L1);
+	int L18 = SB_XOR(M58, L8);
+	int L19 = SB_XOR(M63, L4);
+	int L20 = SB_XOR(L0, L1);
+	int L21 = SB_XOR(L1, L7);
+	int L22 = SB_XOR(L3, L12);
+	int L23 = SB_XOR(L18, L2);
+	int L24 = SB_XOR(L15, L9);
+	int L25 = SB_XOR(L6, L10);
+	int L26 = SB_XOR(L7, L9);
+	int L27 = SB_XOR(L8, L10);
+	int L28 = SB_XOR(L11, L14);
+	int L29 = SB_XOR(L11, L17);
+	outputs[7] = SB_XOR(L6, L24);
+	outputs[6] = SB_XNOR(L16, L26);
+	outputs[5] = SB_XNOR(L19, L28);
+	outputs[4] = SB_XOR(L6, L21);
+	outputs[3] = SB_XOR(L20, L22);
+	outputs[2] = SB_XOR(L25, L29);
+	outputs[1] = SB_XNOR(L13, L27);
+	outputs[0] = SB_XNOR(L6, L23);
+
+	return 0;
+}
+
+#undef SB_XOR
+#undef SB_AND
+#undef SB_XNOR
+
+
+//NOTE words are 4 bytes in order, so RotWord() moves byte 0 to the end and Rcon goes into byte 0
 int AES_expand_key(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int* key, int* expanded_key) {
 
+	int rcon[AES_NUM_ROUNDS] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36};
 	int in_sw[32];
 	int in_xor_1[32];
 	int in_xor_2[64];
-	int temp[32];
 	int offset = 128;
 
 	memcpy(expanded_key, key, 128 * sizeof(int));
 
 	for (int round = 0; round < AES_NUM_ROUNDS; round++) {
 
-		memcpy(temp, &expanded_key[offset - 32], 32 * sizeof(int));
-		memcpy(in_xor_1, &expanded_key[offset - 128], 32 * sizeof(int));
-
 		//RotWord()
-		SHIFT_Circuit(garbledCircuit, garblingContext, 32, 8, LEFT, CIRCULAR, POSITIVE, temp, in_sw);
+		memcpy(in_sw, &expanded_key[offset - 24], 24 * sizeof(int));
+		memcpy(&in_sw[24], &expanded_key[offset - 32], 8 * sizeof(int));
 
 		//SubWord()
-		//TODO integrate NewSBOXCircuit into const-op paradigm
-		NewSBOXCircuit(garbledCircuit, garblingContext, in_sw, in_xor_1);
-		NewSBOXCircuit(garbledCircuit, garblingContext, &in_sw[8], &in_xor_1[8]);
-		NewSBOXCircuit(garbledCircuit, garblingContext, &in_sw[16], &in_xor_1[16]);
-		NewSBOXCircuit(garbledCircuit, garblingContext, &in_sw[24], &in_xor_1[24]);
-
+		for (int i = 0; i < 4; i++)
+			AES_SBOX_Circuit(garbledCircuit, garblingContext, &in_sw[8*i], &in_xor_1[8*i]);
 
 		//XOR with Rcon[i/Nk] indices in words; NIST FIPS 197 Figure 11
 		//See Table A.1 for further details
-		if (round < 8) {
-			NOT_Gate2(garbledCircuit, garblingContext, in_xor_1[24 + round], &in_xor_1[24 + round]);
-		}
-		else {
-			NOT_Gate2(garbledCircuit, garblingContext, in_xor_1[16 + round], &in_xor_1[16 + round]);
-			NOT_Gate2(garbledCircuit, garblingContext, in_xor_1[17 + round], &in_xor_1[17 + round]);
-			NOT_Gate2(garbledCircuit, garblingContext, in_xor_1[19 + round], &in_xor_1[19 + round]);
-			NOT_Gate2(garbledCircuit, garblingContext, in_xor_1[20 + round], &in_xor_1[20 + round]);
+		for (int i = 0; i < 8; i++) {
+			if ((rcon[round] >> i) & 1)
+				NOT_Gate2(garbledCircuit, garblingContext, in_xor_1[i], &in_xor_1[i]);
 		}
 
-		memcpy(in_xor_2, in_xor_1, 32 * sizeof(int));
-		memcpy(&in_xor_2[32], temp, 32 * sizeof(int));
-
 		//W[i] = temp XOR w[i-Nk] indices in words; NIST FIPS 197 Figure 11, Table A.1
 		for (int i = 0; i < 4; i++) {
+			memcpy(in_xor_2, i == 0 ? in_xor_1 : &expanded_key[offset + (i-1)*32], 32 * sizeof(int));
+			memcpy(&in_xor_2[32], &expanded_key[offset - 128 + i*32], 32 * sizeof(int));
 			MIXED_OP_Circuit(garbledCircuit, garblingContext, 64, XOR, in_xor_2, &expanded_key[offset + i*32]);
-			//w[i-1], W[i-Nk] indices in words; NIST FIPS 197 Figure 11
-			memcpy(in_xor_2, &expanded_key[offset - 32], 32 * sizeof(int));
-			memcpy(&in_xor_2[32], &expanded_key[offset - 128], 32 * sizeof(int));
 		}
 
 		offset += 128;
@@ -96,6 +243,7 @@ int AES_expand_key(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 
 //TODO integrate AddRoundKey, SubBytes, ShiftRows, MixColumns into const-op paradigm
 int AESEnc_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int n, int* inputs, int* outputs) {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
 
 	int expanded_key[128 * (AES_NUM_ROUNDS + 1)];
 	int in_add_key[256];
@@ -124,7 +272,7 @@ int AESEnc_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 		for (int round = 0; round < AES_NUM_ROUNDS; round++) {
 
 			for (int i = 0; i < 16; i++) {
-				SubBytes(garbledCircuit, garblingContext, &out_add_key[8*i], &out_sub_bytes[8*i]);
+				AES_SBOX_Circuit(garbledCircuit, garblingContext, &out_add_key[8*i], &out_sub_bytes[8*i]);
 			}
 
 			ShiftRows(garbledCircuit, garblingContext, out_sub_bytes, out_shift_row);
@@ -143,6 +291,8 @@ int AESEnc_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 	}
 
 	memcpy(outputs, out_add_key, AES_BLOCK_SIZE * sizeof(int));
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -178,6 +328,8 @@ int SHA_ROTR_Circuit(int n, int w, int *inputs, int *outputs)
 
 int SHA_SIGMA_0_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int d, int *inputs, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	//CAUTION w is used here where n is normally used within JG, and n instead refers to shift value within ROTR or SHR
 	//CAUTION this is to maintain compatibility with NIST 180.4 notation. For SHA256, input size w = 32 (bit word)
 	int w = d / 8;
@@ -199,12 +351,16 @@ int SHA_SIGMA_0_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblin
 
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_1, &in_xor_2[w]);
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_2, outputs);
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
 
 int SHA_SIGMA_1_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int d, int *inputs, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	//CAUTION w is used here where n is normally used within JG, and n instead refers to shift value within ROTR or SHR
 	//CAUTION this is to maintain compatibility with NIST 180.4 notation. For SHA256, input size w = 32 (bit word)
 	int w = d / 8;
@@ -226,12 +382,16 @@ int SHA_SIGMA_1_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblin
 
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_1, &in_xor_2[w]);
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_2, outputs);
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
 
 int SHA_sigma_0_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int d, int *inputs, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	//CAUTION w is used here where n is normally used within JG, and n instead refers to shift value within ROTR or SHR
 	//CAUTION this is to maintain compatibility with NIST 180.4 notation. For SHA256, input size w = 32 (bit word)
 	int w = d / 8;
@@ -253,12 +413,16 @@ int SHA_sigma_0_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblin
 
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_1, &in_xor_2[w]);
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_2, outputs);
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
 
 int SHA_sigma_1_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int d, int *inputs, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	//CAUTION w is used here where n is normally used within JG, and n instead refers to shift value within ROTR or SHR
 	//CAUTION this is to maintain compatibility with NIST 180.4 notation. For SHA256, input size w = 32 (bit word)
 	int w = d / 8;
@@ -280,12 +444,16 @@ int SHA_sigma_1_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblin
 
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_1, &in_xor_2[w]);
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_2, outputs);
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
 
 int SHA_CH_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int d, int *inx, int *iny, int *inz, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	//CAUTION w is used here where n is normally used within JG, and n instead refers to shift value within ROTR or SHR
 	//CAUTION this is to maintain compatibility with NIST 180.4 notation. For SHA256, input size w = 32 (bit word)
 	int w = d / 8;
@@ -305,12 +473,16 @@ int SHA_CH_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, AND, in_and, &in_xor[w]);
 
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor, outputs);
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
 
 int SHA_MAJ_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int d, int *inx, int *iny, int *inz, int *outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	//CAUTION w is used here where n is normally used within JG, and n instead refers to shift value within ROTR or SHR
 	//CAUTION this is to maintain compatibility with NIST 180.4 notation. For SHA256, input size w = 32 (bit word)
 	int w = d / 8;
@@ -331,6 +503,8 @@ int SHA_MAJ_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingCon
 
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_1, &in_xor_2[w]);
 	MIXED_OP_Circuit(garbledCircuit, garblingContext, 2 * w, XOR, in_xor_2, outputs);
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -344,6 +518,8 @@ int SHA_MAJ_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingCon
 
 int SHA2_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int digest_length, int n, int* inputs, int* outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int word_length = digest_length / 8;
 	int nrep_size = digest_length / 4;
 
@@ -521,6 +697,8 @@ int SHA2_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContex
 
 	for (int u = 0; u < 8; u++)
 		memcpy(&outputs[u * word_length], (int*) &H[u], word_length * sizeof(int));
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -533,6 +711,8 @@ int SHA2_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContex
 
 int SHA_THETA_CIRCUIT(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int (*A)[5][64])
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int C[5][64];
 	int D[5][64];
 
@@ -563,6 +743,8 @@ int SHA_THETA_CIRCUIT(GarbledCircuit *garbledCircuit, GarblingContext *garblingC
 			}
 		}
 	}
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -612,6 +794,8 @@ int SHA_PI_CIRCUIT(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 
 int SHA_CHI_CIRCUIT(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int (*A)[5][64])
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	for (int y = 0; y < 5; y++){
 		for (int x = 0; x < 5; x++){
 			for (int z = 0; z < 64; z++){
@@ -624,6 +808,8 @@ int SHA_CHI_CIRCUIT(GarbledCircuit *garbledCircuit, GarblingContext *garblingCon
 			}
 		}
 	}
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -657,6 +843,8 @@ int SHA_RC(int t)
 
 int SHA_IOTA_CIRCUIT(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int pass_num, int (*A)[5][64])
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int RC[64];
 
 	int k = 0;
@@ -675,12 +863,16 @@ int SHA_IOTA_CIRCUIT(GarbledCircuit *garbledCircuit, GarblingContext *garblingCo
 
 	for (int z = 0; z < 64; z++)
 		MIXED_OP_Gate(garbledCircuit, garblingContext, XOR, A[0][0][z], RC[z], &A[0][0][z]);
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
 
 int SHA3_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int digest_length, int n, int* inputs, int* outputs)
 {
+	pushProfileRegion(garbledCircuit, garblingContext, __func__);
+
 	int b = 1600;				// "width"
 	int c = 2 * digest_length;	// "capacity"
 	int r = b - c;				// "rate"
@@ -730,16 +922,18 @@ int SHA3_Circuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContex
 		}
 	}
 
+	//NOTE the digest is the first digest_length bits of the state, so the copy stops there rather than at the end of a lane
 	int *T = outputs;
-	for (int y = 0; y < 5; y++){
-		for (int x = 0; x < 5; x++){
-			for (int z = 0; z < 64; z++){
+	for (int y = 0; (y < 5) && (T - outputs < digest_length); y++){
+		for (int x = 0; (x < 5) && (T - outputs < digest_length); x++){
+			for (int z = 0; (z < 64) && (T - outputs < digest_length); z++){
 				//CAUTION assignment in line below is equivalent to linear combination above iff the for loops are nested in order {y, x, z}
 				*(T++) = A[x][y][z];
-				if (T - outputs == digest_length) break;
 			}
 		}
 	}
+
+	popProfileRegion(garbledCircuit, garblingContext);
 }
 
 
@@ -32,7 +32,86 @@
 
 
 
-#ifdef TRUNCATED
+#ifdef HALF_GATES
+//NOTE non-free gates are evaluated level by level in batches of EVAL_BATCH_SIZE gates
+//NOTE the 2 * EVAL_BATCH_SIZE hashes of a batch go through AES round by round, so AES-NI latency is hidden by independent blocks
+int evaluate(GarbledCircuit *garbledCircuit, ExtractedLabels extractedLabels,
+		OutputMap outputMap) {
+	PackedGate *packedGate;
+	DKCipherContext dkCipherContext;
+	DKCipherInit(&(garbledCircuit->globalKey), &dkCipherContext);
+	block A[EVAL_BATCH_SIZE];
+	block keys[2 * EVAL_BATCH_SIZE];
+	block mask[2 * EVAL_BATCH_SIZE];
+	GarbledTable *garbledTable = garbledCircuit->garbledTable;
+	GateSchedule *schedule;
+	block *labels;
+	long i, j, l, batchSize;
+	long tableIndex = 0;
+
+	if (garbledCircuit->schedule == NULL && levelizeCircuit(garbledCircuit) == FAILURE)
+		return FAILURE;
+	if (createLabelArena(garbledCircuit) == FAILURE)
+		return FAILURE;
+	schedule = garbledCircuit->schedule;
+	labels = garbledCircuit->labels;
+
+	for (i = 0; i < garbledCircuit->n; i++) {
+		labels[i] = extractedLabels[i];
+	}
+
+	for (l = 0; l < schedule->numLevels; l++) {
+		for (i = schedule->levelStart[l]; i < schedule->levelFree[l]; i += batchSize) {
+			batchSize = schedule->levelFree[l] - i;
+			if (batchSize > EVAL_BATCH_SIZE)
+				batchSize = EVAL_BATCH_SIZE;
+
+			for (j = 0; j < batchSize; j++) {
+				packedGate = &(schedule->gates[i + j]);
+				A[j] = labels[packedGate->input0];
+				keys[2 * j] = xorBlocks(DOUBLE(A[j]), makeBlock(2 * (tableIndex + j), (long) 0));
+				keys[2 * j + 1] = xorBlocks(DOUBLE(labels[packedGate->input1]), makeBlock(2 * (tableIndex + j) + 1, (long) 0));
+				mask[2 * j] = keys[2 * j];
+				mask[2 * j + 1] = keys[2 * j + 1];
+			}
+
+			if (batchSize == EVAL_BATCH_SIZE)
+				AES_ecb_encrypt_blks_8(keys, &(dkCipherContext.K));
+			else
+				AES_ecb_encrypt_blks(keys, 2 * batchSize, &(dkCipherContext.K));
+
+			//NOTE AND and OR gates are evaluated identically, the garbler accounts for the negations
+			for (j = 0; j < batchSize; j++) {
+				packedGate = &(schedule->gates[i + j]);
+				mask[2 * j] = xorBlocks(mask[2 * j], keys[2 * j]);
+				mask[2 * j + 1] = xorBlocks(mask[2 * j + 1], keys[2 * j + 1]);
+
+				if (getLSB(A[j]))
+					mask[2 * j] = xorBlocks(mask[2 * j], garbledTable[tableIndex].table[0]);
+				if (getLSB(labels[packedGate->input1]))
+					mask[2 * j + 1] = xorBlocks(mask[2 * j + 1], xorBlocks(garbledTable[tableIndex].table[1], A[j]));
+
+				labels[packedGate->output] = xorBlocks(mask[2 * j], mask[2 * j + 1]);
+				tableIndex++;
+			}
+		}
+
+		for (i = schedule->levelFree[l]; i < schedule->levelStart[l + 1]; i++) {
+			packedGate = &(schedule->gates[i]);
+			if (packedGate->type == XORGATE)
+				labels[packedGate->output] = xorBlocks(labels[packedGate->input0], labels[packedGate->input1]);
+			else
+				labels[packedGate->output] = labels[packedGate->input1];
+		}
+	}
+
+	for (i = 0; i < garbledCircuit->m; i++) {
+		outputMap[i] = labels[schedule->outputs[i]];
+	}
+	return 0;
+
+}
+#elif defined(TRUNCATED)
 int evaluate(GarbledCircuit *garbledCircuit, ExtractedLabels extractedLabels,
 		OutputMap outputMap) {
 	GarbledGate *garbledGate;
@@ -224,3 +303,4 @@ int evaluate(GarbledCircuit *garbledCircuit, ExtractedLabels extractedLabels,
 
 }
 #endif
+
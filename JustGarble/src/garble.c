@@ -29,9 +29,52 @@
 #include "../include/justGarble.h"
 #include <malloc.h>
 #include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
 
 unsigned long startTime, endTime;
 
+//NOTE labels and keys are drawn from the global AES-counter PRNG (see util.h), so garblers running concurrently on
+//NOTE separate tables, e.g. those of a GarblingPool, take turns on it
+static pthread_mutex_t randomLock = PTHREAD_MUTEX_INITIALIZER;
+
+//NOTE seeded garbling swaps the global PRNG for AES keyed by the seed, in counter mode, so that everything garbling
+//NOTE draws (R and the input labels in createInputLabels, then the table key) is a function of the seed alone
+typedef struct {
+	__m128i randIndex;
+	AES_KEY_JG randKey;
+} RandomState;
+
+static void useSeededRandom(block *seed, RandomState *saved) {
+	seedRandom();
+	saved->randIndex = __current_rand_index;
+	saved->randKey = __rand_aes_key;
+	JGseedRandomCust((unsigned char *) seed);
+}
+
+static void restoreRandom(RandomState *saved) {
+	__current_rand_index = saved->randIndex;
+	__rand_aes_key = saved->randKey;
+}
+
+block createGarblingSeed() {
+	pthread_mutex_lock(&randomLock);
+	seedRandom();
+	block seed = randomBlock();
+	pthread_mutex_unlock(&randomLock);
+	return seed;
+}
+
+int createInputLabelsFromSeed(InputLabels inputLabels, int n, block seed) {
+	RandomState saved;
+	pthread_mutex_lock(&randomLock);
+	useSeededRandom(&seed, &saved);
+	createInputLabels(inputLabels, n);
+	restoreRandom(&saved);
+	pthread_mutex_unlock(&randomLock);
+	return 0;
+}
+
 int FINAL_ROUND = 0;
 
 int createNewWire(Wire *in, GarblingContext *garblingContext, int id) {
@@ -58,19 +101,39 @@ int getNextWire(GarblingContext *garblingContext) {
 	return i;
 }
 
+//NOTE q and r are only the initial gate and wire capacities of a circuit being built: genericGate() and the fixed
+//NOTE wire functions grow the arrays geometrically as needed, and finishBuilding() trims them to the circuit's size
+//NOTE capacities above GC_INITIAL_CAPACITY are not reserved up front, so that a generous estimate costs nothing
+//NOTE with inputLabels == NULL the circuit is built topology-only: there are no wire labels or garbled tables,
+//NOTE only gates and fixed wire metadata, which is all that optimizeCircuit() and writeCircuitToFile() need
+
 int createEmptyGarbledCircuit(GarbledCircuit *garbledCircuit, int n, int m,
 		int q, int r, InputLabels inputLabels) {
 	startTime = RDTSC;
+	if (q > GC_INITIAL_CAPACITY)
+		q = GC_INITIAL_CAPACITY;
+	if (q < 1)
+		q = 1;
+	if (r > n + 1 + GC_INITIAL_CAPACITY)
+		r = n + 1 + GC_INITIAL_CAPACITY;
+	if (r < n + 1)
+		r = n + 1;
+
 	garbledCircuit->id = getNextId();
 	garbledCircuit->garbledGates = (GarbledGate *) memalign(128,
 			sizeof(GarbledGate) * q);
-	garbledCircuit->garbledTable = (GarbledTable *) memalign(128,
-			sizeof(GarbledTable) * q);
-	garbledCircuit->wires = (Wire *) memalign(128, sizeof(Wire) * r);
+	garbledCircuit->garbledTable = NULL;
+	garbledCircuit->wires = NULL;
+	if (inputLabels != NULL) {
+		garbledCircuit->garbledTable = (GarbledTable *) memalign(128,
+				sizeof(GarbledTable) * q);
+		garbledCircuit->wires = (Wire *) memalign(128, sizeof(Wire) * r);
+	}
 	garbledCircuit->outputs = (int *) memalign(128, sizeof(int) * m);
 
 	if (garbledCircuit->garbledGates == NULL
-			|| garbledCircuit->garbledGates == NULL) {
+			|| (inputLabels != NULL && (garbledCircuit->garbledTable == NULL
+			|| garbledCircuit->wires == NULL))) {
 		dbgs("Linux is a cheap miser that refuses to give us memory");
 		exit(1);
 	}
@@ -82,14 +145,20 @@ int createEmptyGarbledCircuit(GarbledCircuit *garbledCircuit, int n, int m,
 	garbledCircuit->qxor = 0;
 	garbledCircuit->qnot = 0;
 	garbledCircuit->r = r;
+	garbledCircuit->schedule = NULL;
+	garbledCircuit->labels = NULL;
+	garbledCircuit->mappedFile = NULL;
+	garbledCircuit->mappedSize = 0;
 	int i;
-	for (i = 0; i < r; i++) {
-		garbledCircuit->wires[i].id = 0;
-	}
 	for (i = 0; i < q; i++) {
 		garbledCircuit->garbledGates[i].id = 0;
 	}
+	if (!hasWireLabels(garbledCircuit))
+		return 0;
 
+	for (i = 0; i < r; i++) {
+		garbledCircuit->wires[i].id = 0;
+	}
 	for (i = 0; i < 2 * n; i += 2) {
 		garbledCircuit->wires[i / 2].id = i + 1;
 		garbledCircuit->wires[i / 2].label0 = inputLabels[i];
@@ -98,10 +167,64 @@ int createEmptyGarbledCircuit(GarbledCircuit *garbledCircuit, int n, int m,
 	return 0;
 }
 
+//NOTE realloc() only keeps the 16 byte alignment that blocks need, not the 128 bytes of memalign(),
+//NOTE but it can move large arrays by remapping pages rather than copying them
+static void *resizeArray(void *array, size_t size) {
+	void *resized = realloc(array, size);
+	if (resized == NULL) {
+		dbgs("Linux is a cheap miser that refuses to give us memory");
+		exit(1);
+	}
+	return resized;
+}
+
+static void resizeGates(GarbledCircuit *garbledCircuit, int q) {
+	garbledCircuit->garbledGates = (GarbledGate *) resizeArray(garbledCircuit->garbledGates, sizeof(GarbledGate) * q);
+	if (garbledCircuit->garbledTable != NULL)
+		garbledCircuit->garbledTable = (GarbledTable *) resizeArray(garbledCircuit->garbledTable, sizeof(GarbledTable) * q);
+	for (int i = garbledCircuit->q; i < q; i++)
+		garbledCircuit->garbledGates[i].id = 0;
+	garbledCircuit->q = q;
+}
+
+static void resizeWires(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int r) {
+	if (hasWireLabels(garbledCircuit))
+		garbledCircuit->wires = (Wire *) resizeArray(garbledCircuit->wires, sizeof(Wire) * r);
+	garblingContext->fixedWires = (int *) resizeArray(garblingContext->fixedWires, sizeof(int) * r);
+	for (int i = garbledCircuit->r; i < r; i++) {
+		if (hasWireLabels(garbledCircuit))
+			garbledCircuit->wires[i].id = 0;
+		garblingContext->fixedWires[i] = VARIABLE_VAL_WIRE;
+	}
+	garbledCircuit->r = r;
+}
+
+//while building, garbledCircuit->q and garbledCircuit->r hold the capacities of the gate and wire arrays
+
+void reserveGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext) {
+	if (garblingContext->gateIndex >= garbledCircuit->q)
+		resizeGates(garbledCircuit, 2 * garbledCircuit->q);
+}
+
+void reserveWire(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int wire) {
+	if (wire >= garbledCircuit->r)
+		resizeWires(garbledCircuit, garblingContext, wire < 2 * garbledCircuit->r ? 2 * garbledCircuit->r : wire + 1);
+}
+
 void removeGarbledCircuit(GarbledCircuit *garbledCircuit) {
 	garbledCircuit->id = getNextId();
-	free(garbledCircuit->garbledGates);
 	free(garbledCircuit->wires);
+	free(garbledCircuit->labels);
+	garbledCircuit->labels = NULL;
+	removeSchedule(garbledCircuit);
+	//NOTE the gates of a circuit read from a packed SCD v2 file live in the file mapping
+	if (garbledCircuit->mappedFile != NULL) {
+		munmap(garbledCircuit->mappedFile, garbledCircuit->mappedSize);
+		garbledCircuit->mappedFile = NULL;
+	}
+	else {
+		free(garbledCircuit->garbledGates);
+	}
 }
 
 int startBuilding(GarbledCircuit *garbledCircuit,
@@ -109,16 +232,19 @@ int startBuilding(GarbledCircuit *garbledCircuit,
 	garblingContext->gateIndex = 0;
 	garblingContext->tableIndex = 0;
 	garblingContext->wireIndex = garbledCircuit->n + 1;
-	block key = randomBlock();
-	garblingContext->R =
-			xorBlocks(garbledCircuit->wires[0].label0, garbledCircuit->wires[0].label1);
 	garblingContext->fixedWires = (int *) malloc(
 			sizeof(int) * garbledCircuit->r);
-	garbledCircuit->globalKey = key;
+	garblingContext->profile = NULL;
 	startTime = RDTSC;
-	DKCipherInit(&key, &(garblingContext->dkCipherContext));
-	for (int i = 0; i < garbledCircuit->n; i++)
-		garblingContext->fixedWires[i] = INPUT_VAL_WIRE;
+	if (hasWireLabels(garbledCircuit)) {
+		block key = randomBlock();
+		garblingContext->R =
+				xorBlocks(garbledCircuit->wires[0].label0, garbledCircuit->wires[0].label1);
+		garbledCircuit->globalKey = key;
+		DKCipherInit(&key, &(garblingContext->dkCipherContext));
+	}
+	for (int i = 0; i < garbledCircuit->r; i++)
+		garblingContext->fixedWires[i] = i < garbledCircuit->n ? INPUT_VAL_WIRE : VARIABLE_VAL_WIRE;
 
 	return 0;
 }
@@ -127,10 +253,12 @@ int finishBuilding(GarbledCircuit *garbledCircuit,
 		GarblingContext *garbledContext, OutputMap outputMap, int *outputs) {
 	int i;
 
+	//NOTE this also covers wire ids handed out by getNextWire() without a gate or fixed value behind them
+	resizeWires(garbledCircuit, garbledContext, garbledContext->wireIndex);
+	resizeGates(garbledCircuit, garbledContext->gateIndex > 0 ? garbledContext->gateIndex : 1);
 	garbledCircuit->q = garbledContext->gateIndex;
-	garbledCircuit->r = garbledContext->wireIndex;
 
-	for (i = 0; i < garbledCircuit->r; i++) {
+	for (i = 0; i < garbledCircuit->r && hasWireLabels(garbledCircuit); i++) {
 		if (garbledContext->fixedWires[i] == FIXED_ZERO_WIRE) {
 			//printf("Wire %i is fixed 0 wire\n", i);
 			garbledCircuit->wires[i].label = garbledCircuit->wires[i].label0;
@@ -141,8 +269,10 @@ int finishBuilding(GarbledCircuit *garbledCircuit,
 		}
 	}
 	for (i = 0; i < garbledCircuit->m; i++) {
-		outputMap[2 * i] = garbledCircuit->wires[outputs[i]].label0;
-		outputMap[2 * i + 1] = garbledCircuit->wires[outputs[i]].label1;
+		if (hasWireLabels(garbledCircuit)) {
+			outputMap[2 * i] = garbledCircuit->wires[outputs[i]].label0;
+			outputMap[2 * i + 1] = garbledCircuit->wires[outputs[i]].label1;
+		}
 		if ((garbledContext->fixedWires[outputs[i]] != FIXED_ZERO_WIRE) && (garbledContext->fixedWires[outputs[i]] != FIXED_ONE_WIRE))
 			garbledContext->fixedWires[outputs[i]] = OUTPUT_VAL_WIRE;
 		garbledCircuit->outputs[i] = outputs[i];
@@ -171,7 +301,242 @@ int extractLabels(ExtractedLabels extractedLabels, InputLabels inputLabels,
 	return 0;
 
 }
-#ifdef TRUNCATED
+#ifdef HALF_GATES
+//NOTE half-gates garbling (Zahur, Rosulek and Evans): two ciphertexts per AND/OR gate, XOR and NOT gates are free
+//NOTE the hash of a label X under tweak j is DOUBLE(X) ^ j passed through the fixed-key DKC, as in the row-reduced scheme below
+//NOTE an OR gate is garbled as an AND gate of the negated inputs with a negated output, i.e. by offsetting the zero labels by R
+//NOTE tables and tweaks follow the order of the circuit's GateSchedule, whichever thread garbles a gate
+static inline void garbleHalfGate(PackedGate *packedGate, block *labels, block R, AES_KEY_JG *K, long tableIndex, GarbledTable *garbledTable) {
+	block keys[4];
+	block mask[4];
+	block A0, B0;
+	block TG, TE, WG0, WE0;
+	long lsb0, lsb1;
+
+	A0 = labels[packedGate->input0];
+	B0 = labels[packedGate->input1];
+	if (packedGate->type == ORGATE) {
+		A0 = xorBlocks(A0, R);
+		B0 = xorBlocks(B0, R);
+	}
+	lsb0 = getLSB(A0);
+	lsb1 = getLSB(B0);
+
+	keys[0] = xorBlocks(DOUBLE(A0), makeBlock(2 * tableIndex, (long)0));
+	keys[1] = xorBlocks(DOUBLE(xorBlocks(A0, R)), makeBlock(2 * tableIndex, (long)0));
+	keys[2] = xorBlocks(DOUBLE(B0), makeBlock(2 * tableIndex + 1, (long)0));
+	keys[3] = xorBlocks(DOUBLE(xorBlocks(B0, R)), makeBlock(2 * tableIndex + 1, (long)0));
+
+	mask[0] = keys[0];
+	mask[1] = keys[1];
+	mask[2] = keys[2];
+	mask[3] = keys[3];
+	AES_ecb_encrypt_blks_4(keys, K);
+	mask[0] = xorBlocks(mask[0], keys[0]);
+	mask[1] = xorBlocks(mask[1], keys[1]);
+	mask[2] = xorBlocks(mask[2], keys[2]);
+	mask[3] = xorBlocks(mask[3], keys[3]);
+
+	//garbler half gate
+	TG = xorBlocks(mask[0], mask[1]);
+	if (lsb1)
+		TG = xorBlocks(TG, R);
+	WG0 = mask[0];
+	if (lsb0)
+		WG0 = xorBlocks(WG0, TG);
+
+	//evaluator half gate
+	TE = xorBlocks(xorBlocks(mask[2], mask[3]), A0);
+	WE0 = mask[2];
+	if (lsb1)
+		WE0 = xorBlocks(WE0, xorBlocks(TE, A0));
+
+	labels[packedGate->output] = xorBlocks(WG0, WE0);
+	if (packedGate->type == ORGATE)
+		labels[packedGate->output] = xorBlocks(labels[packedGate->output], R);
+
+	garbledTable[tableIndex].table[0] = TG;
+	garbledTable[tableIndex].table[1] = TE;
+}
+
+//NOTE the value of a NOT gate is carried on input1, input0 is the dummy wire
+static inline void garbleFreeGate(PackedGate *packedGate, block *labels, block R) {
+	if (packedGate->type == XORGATE)
+		labels[packedGate->output] = xorBlocks(labels[packedGate->input0], labels[packedGate->input1]);
+	else
+		labels[packedGate->output] = xorBlocks(labels[packedGate->input1], R);
+}
+
+
+static int garblingThreads = 1;
+
+void setGarblingThreads(int numThreads) {
+	garblingThreads = numThreads < 1 ? 1 : numThreads;
+}
+
+
+typedef struct {
+	GarbledCircuit *garbledCircuit;
+	GarblingContext *garblingContext;
+	pthread_barrier_t *barrier;
+	int threadId;
+	int numThreads;
+} GarblingThreadArgs;
+
+//NOTE every thread walks all stages; a stage is split across threads only if it has enough non-free gates
+//NOTE the free gates of a stage are garbled by thread 0, the barriers order them against the non-free gates around them
+static void *garbleStages(void *args) {
+	GarblingThreadArgs *threadArgs = (GarblingThreadArgs *) args;
+	GarbledCircuit *garbledCircuit = threadArgs->garbledCircuit;
+	GateSchedule *schedule = garbledCircuit->schedule;
+	block *labels = garbledCircuit->labels;
+	block R = threadArgs->garblingContext->R;
+	AES_KEY_JG *K = &(threadArgs->garblingContext->dkCipherContext.K);
+	int t = threadArgs->threadId;
+	int T = threadArgs->numThreads;
+	long i, l, first, last, count;
+
+	for (l = 0; l < schedule->numStages; l++) {
+		count = schedule->stageFree[l] - schedule->stageStart[l];
+		if (count >= T * MIN_GATES_PER_THREAD) {
+			first = schedule->stageStart[l] + (count * t) / T;
+			last = schedule->stageStart[l] + (count * (t + 1)) / T;
+			pthread_barrier_wait(threadArgs->barrier);
+			for (i = first; i < last; i++)
+				garbleHalfGate(&(schedule->stageGates[i]), labels, R, K, schedule->stageTable[i], garbledCircuit->garbledTable);
+			pthread_barrier_wait(threadArgs->barrier);
+		}
+		else if (t == 0) {
+			for (i = schedule->stageStart[l]; i < schedule->stageFree[l]; i++)
+				garbleHalfGate(&(schedule->stageGates[i]), labels, R, K, schedule->stageTable[i], garbledCircuit->garbledTable);
+		}
+
+		if (t == 0) {
+			for (i = schedule->stageFree[l]; i < schedule->stageStart[l + 1]; i++)
+				garbleFreeGate(&(schedule->stageGates[i]), labels, R);
+		}
+	}
+	return NULL;
+}
+
+
+int prepareGarbling(GarbledCircuit *garbledCircuit) {
+	if (garbledCircuit->schedule == NULL && levelizeCircuit(garbledCircuit) == FAILURE)
+		return FAILURE;
+	if (garblingThreads > 1 && garbledCircuit->schedule->stageGates == NULL)
+		return buildGarblingStages(garbledCircuit);
+	return SUCCESS;
+}
+
+
+//NOTE seed is NULL for fresh labels from the global PRNG
+static long garbleScheduled(GarbledCircuit *garbledCircuit, block *seed, InputLabels inputLabels, OutputMap outputMap,
+		long chunkRows, TableSink sink, void *sinkContext) {
+
+	GarblingContext garblingContext;
+	RandomState saved;
+	GateSchedule *schedule;
+	block *labels;
+	long i, l;
+
+	if (prepareGarbling(garbledCircuit) == FAILURE)
+		return FAILURE;
+	schedule = garbledCircuit->schedule;
+	if (createLabelArena(garbledCircuit) == FAILURE)
+		return FAILURE;
+	labels = garbledCircuit->labels;
+
+	//NOTE timed locally rather than through startTime/endTime, as pool workers garble concurrently
+	unsigned long garblingStart = RDTSC;
+
+	pthread_mutex_lock(&randomLock);
+	if (seed != NULL)
+		useSeededRandom(seed, &saved);
+	else
+		seedRandom();
+	createInputLabels(inputLabels, garbledCircuit->n);
+	block key = randomBlock();
+	if (seed != NULL)
+		restoreRandom(&saved);
+	garbledCircuit->id = getFreshId();
+	pthread_mutex_unlock(&randomLock);
+
+	for (i = 0; i < garbledCircuit->n; i++) {
+		labels[i] = inputLabels[2 * i];
+	}
+	garblingContext.R = xorBlocks(inputLabels[0], inputLabels[1]);
+	garbledCircuit->globalKey = key;
+	DKCipherInit(&key, &(garblingContext.dkCipherContext));
+
+	if (garblingThreads > 1) {
+		pthread_t threads[garblingThreads];
+		GarblingThreadArgs threadArgs[garblingThreads];
+		pthread_barrier_t barrier;
+		pthread_barrier_init(&barrier, NULL, garblingThreads);
+
+		for (i = 0; i < garblingThreads; i++) {
+			threadArgs[i].garbledCircuit = garbledCircuit;
+			threadArgs[i].garblingContext = &garblingContext;
+			threadArgs[i].barrier = &barrier;
+			threadArgs[i].threadId = i;
+			threadArgs[i].numThreads = garblingThreads;
+		}
+		for (i = 1; i < garblingThreads; i++)
+			pthread_create(&threads[i], NULL, garbleStages, &threadArgs[i]);
+		garbleStages(&threadArgs[0]);
+		for (i = 1; i < garblingThreads; i++)
+			pthread_join(threads[i], NULL);
+
+		pthread_barrier_destroy(&barrier);
+
+		//NOTE stages fill the table out of order, so rows can only be released once all of them are done
+		if (sink != NULL) {
+			long numRows = 0;
+			for (l = 0; l < schedule->numLevels; l++)
+				numRows += schedule->levelFree[l] - schedule->levelStart[l];
+			sink(sinkContext, numRows);
+		}
+	}
+	else {
+		long tableIndex = 0;
+		long reportedRows = 0;
+		for (l = 0; l < schedule->numLevels; l++) {
+			for (i = schedule->levelStart[l]; i < schedule->levelFree[l]; i++)
+				garbleHalfGate(&(schedule->gates[i]), labels, garblingContext.R, &(garblingContext.dkCipherContext.K), tableIndex++, garbledCircuit->garbledTable);
+			for (i = schedule->levelFree[l]; i < schedule->levelStart[l + 1]; i++)
+				garbleFreeGate(&(schedule->gates[i]), labels, garblingContext.R);
+
+			if (sink != NULL && tableIndex - reportedRows >= chunkRows) {
+				sink(sinkContext, tableIndex);
+				reportedRows = tableIndex;
+			}
+		}
+		if (sink != NULL && tableIndex > reportedRows)
+			sink(sinkContext, tableIndex);
+	}
+
+	int *outputs = garblingThreads > 1 ? schedule->stageOutputs : schedule->outputs;
+	for (i = 0; i < garbledCircuit->m; i++) {
+		outputMap[2 * i] = labels[outputs[i]];
+		outputMap[2 * i + 1] = xorBlocks(outputMap[2 * i], garblingContext.R);
+	}
+	return RDTSC - garblingStart;
+}
+
+long garbleCircuitStreaming(GarbledCircuit *garbledCircuit, InputLabels inputLabels, OutputMap outputMap,
+		long chunkRows, TableSink sink, void *sinkContext) {
+	return garbleScheduled(garbledCircuit, NULL, inputLabels, outputMap, chunkRows, sink, sinkContext);
+}
+
+long garbleCircuitFromSeed(GarbledCircuit *garbledCircuit, block seed, InputLabels inputLabels, OutputMap outputMap) {
+	return garbleScheduled(garbledCircuit, &seed, inputLabels, outputMap, 0, NULL, NULL);
+}
+
+long garbleCircuit(GarbledCircuit *garbledCircuit, InputLabels inputLabels, OutputMap outputMap) {
+	return garbleScheduled(garbledCircuit, NULL, inputLabels, outputMap, 0, NULL, NULL);
+}
+
+#elif defined(TRUNCATED)
 #ifdef ROW_REDUCTION
 long garbleCircuit(GarbledCircuit *garbledCircuit, InputLabels inputLabels, OutputMap outputMap) {
 
@@ -308,7 +673,7 @@ long garbleCircuit(GarbledCircuit *garbledCircuit, InputLabels inputLabels, Outp
 		}
 
 		if (garbledGate->type == NOTGATE) {
-			if (lsb0 == 0) {
+			if (lsb1 == 0) {
 				garbledCircuit->wires[garbledGate->output].label1 = newToken;
 				garbledCircuit->wires[garbledGate->output].label0 = newToken2;
 			} else {
@@ -740,7 +1105,7 @@ long garbleCircuit(GarbledCircuit *garbledCircuit, InputLabels inputLabels, Outp
 		}
 
 		if (garbledGate->type == NOTGATE) {
-			if (lsb0 ==0) {
+			if (lsb1 ==0) {
 				garbledCircuit->wires[garbledGate->output].label1 = newToken;
 				garbledCircuit->wires[garbledGate->output].label0 = newToken2;
 			}
@@ -940,6 +1305,38 @@ long garbleCircuit(GarbledCircuit *garbledCircuit, InputLabels inputLabels,
 #endif
 #endif
 
+#ifndef HALF_GATES
+//NOTE the legacy garblers are single-threaded and walk the gates in file order
+void setGarblingThreads(int numThreads) {
+}
+
+int prepareGarbling(GarbledCircuit *garbledCircuit) {
+	return SUCCESS;
+}
+
+//NOTE the legacy garblers are not levelized, so their table is reported in one piece
+//NOTE they draw randomness throughout, so concurrent calls are serialized as a whole
+long garbleCircuitStreaming(GarbledCircuit *garbledCircuit, InputLabels inputLabels, OutputMap outputMap,
+		long chunkRows, TableSink sink, void *sinkContext) {
+	pthread_mutex_lock(&randomLock);
+	long garblingTime = garbleCircuit(garbledCircuit, inputLabels, outputMap);
+	pthread_mutex_unlock(&randomLock);
+	if (sink != NULL)
+		sink(sinkContext, getTableRows(garbledCircuit));
+	return garblingTime;
+}
+
+long garbleCircuitFromSeed(GarbledCircuit *garbledCircuit, block seed, InputLabels inputLabels, OutputMap outputMap) {
+	RandomState saved;
+	pthread_mutex_lock(&randomLock);
+	useSeededRandom(&seed, &saved);
+	long garblingTime = garbleCircuit(garbledCircuit, inputLabels, outputMap);
+	restoreRandom(&saved);
+	pthread_mutex_unlock(&randomLock);
+	return garblingTime;
+}
+#endif
+
 int blockEqual(block a, block b) {
 	long *ap = (long*) &a;
 	long *bp = (long*) &b;
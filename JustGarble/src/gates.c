@@ -32,10 +32,14 @@ extern int NOTGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingCont
 #ifdef ROW_REDUCTION
 
 int genericGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int input0, int input1, int output, int *vals, int type) {
-	createNewWire(&(garbledCircuit->wires[output]), garblingContext, output);
+	reserveGate(garbledCircuit, garblingContext);
+	reserveWire(garbledCircuit, garblingContext, output);
+	if (hasWireLabels(garbledCircuit))
+		createNewWire(&(garbledCircuit->wires[output]), garblingContext, output);
+	else
+		garblingContext->fixedWires[output] = VARIABLE_VAL_WIRE;
 
 	GarbledGate *garbledGate = &(garbledCircuit->garbledGates[garblingContext->gateIndex]);
-	GarbledTable *garbledTable = &(garbledCircuit->garbledTable[garblingContext->tableIndex]);
 
 	garbledGate->id = garblingContext->gateIndex;
 	garbledGate->type = type;
@@ -43,14 +47,6 @@ int genericGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext
 	garbledGate->input1 = input1;
 	garbledGate->output = output;
 
-	block blocks[4];
-	block keys[4];
-	long lsb0 = getLSB(garbledCircuit->wires[input0].label0);
-	long lsb1 = getLSB(garbledCircuit->wires[input1].label0);
-	block tweak;
-	block keyToEncrypt;
-
-	tweak = makeBlock(garblingContext->gateIndex, (long)0);
 	garblingContext->gateIndex++;
 	garblingContext->tableIndex++;
 
@@ -59,7 +55,12 @@ int genericGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext
 #else
 
 int genericGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, int input0, int input1, int output, int *vals, int type) {
-	createNewWire(&(garbledCircuit->wires[output]), garblingContext, output);
+	reserveGate(garbledCircuit, garblingContext);
+	reserveWire(garbledCircuit, garblingContext, output);
+	if (hasWireLabels(garbledCircuit))
+		createNewWire(&(garbledCircuit->wires[output]), garblingContext, output);
+	else
+		garblingContext->fixedWires[output] = VARIABLE_VAL_WIRE;
 	GarbledGate *garbledGate = &(garbledCircuit->garbledGates[garblingContext->gateIndex]);
 
 	garbledGate->id = garblingContext->gateIndex;
@@ -77,7 +78,10 @@ int genericGate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext
 
 int fixedZeroWire(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext) {
 	int ind = getNextWire(garblingContext);
+	reserveWire(garbledCircuit, garblingContext, ind);
 	garblingContext->fixedWires[ind] = FIXED_ZERO_WIRE;
+	if (!hasWireLabels(garbledCircuit))
+		return ind;
 	Wire *wire = &garbledCircuit->wires[ind];
 	if (wire->id != 0)
 		printf("ERROR: Reusing output at wire %d\n", ind);
@@ -89,7 +93,10 @@ int fixedZeroWire(GarbledCircuit *garbledCircuit, GarblingContext *garblingConte
 }
 int fixedOneWire(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext) {
 	int ind = getNextWire(garblingContext);
+	reserveWire(garbledCircuit, garblingContext, ind);
 	garblingContext->fixedWires[ind] = FIXED_ONE_WIRE;
+	if (!hasWireLabels(garbledCircuit))
+		return ind;
 	Wire *wire = &garbledCircuit->wires[ind];
 	wire->id = ind;
 	wire->label0 = randomBlock();
@@ -0,0 +1,247 @@
+/*
+	Privacy Preserving Biometric Authentication for Fingerprints and Beyond
+	Copyright (C) 2024  Marina Blanton and Dennis Murphy,
+	University at Buffalo, State University of New York.
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "../include/justGarble.h"
+#include "../include/garble.h"
+#include <malloc.h>
+
+
+//NOTE every wire of the built circuit is mapped to a reference: one of the two constants or a wire of the optimized one
+#define REF_ZERO -1
+#define REF_ONE -2
+#define REF_UNDEFINED -3
+
+//NOTE the value of gate type t on inputs (x, y) is bit 2x + y of t, see gates.h
+#define gateValue(t, x, y) (((t) >> (2 * (x) + (y))) & 1)
+
+
+typedef struct {
+	GarbledGate *gates;
+	int numGates;
+	int n;
+	//NOTE open-addressing table of emitted gates, keyed on (type, input0, input1)
+	int *hashSlots;
+	unsigned long hashMask;
+	//NOTE notInput[w - n - 1] is the input of the NOT gate driving w, or -1
+	int *notInput;
+} OptimizedCircuit;
+
+
+static unsigned long gateHash(int type, int input0, int input1) {
+	unsigned long h = (unsigned long) type * 0x9E3779B97F4A7C15UL;
+	h ^= (unsigned long) input0 + 0x7F4A7C159E3779B9UL + (h << 6) + (h >> 2);
+	h ^= (unsigned long) input1 + 0x9E3779B97F4A7C15UL + (h << 6) + (h >> 2);
+	return h;
+}
+
+//NOTE gates are emitted in topological order, the output of the i-th one is wire n + 1 + i as in SCD files
+static int emitGate(OptimizedCircuit *opt, int type, int input0, int input1) {
+	unsigned long h = gateHash(type, input0, input1) & opt->hashMask;
+	int g;
+	while ((g = opt->hashSlots[h]) >= 0) {
+		if (opt->gates[g].type == type && opt->gates[g].input0 == input0 && opt->gates[g].input1 == input1)
+			return opt->gates[g].output;
+		h = (h + 1) & opt->hashMask;
+	}
+	g = opt->numGates++;
+	opt->hashSlots[h] = g;
+	opt->gates[g].type = type;
+	opt->gates[g].input0 = input0;
+	opt->gates[g].input1 = input1;
+	opt->gates[g].output = opt->n + 1 + g;
+	opt->gates[g].id = 0;
+	opt->notInput[g] = type == NOTGATE ? input1 : -1;
+	return opt->gates[g].output;
+}
+
+static int emitNot(OptimizedCircuit *opt, int input) {
+	if (input == REF_ZERO)
+		return REF_ONE;
+	if (input == REF_ONE)
+		return REF_ZERO;
+	if (input > opt->n && opt->notInput[input - opt->n - 1] >= 0)
+		return opt->notInput[input - opt->n - 1];
+	return emitGate(opt, NOTGATE, 0, input);
+}
+
+//NOTE a gate with one variable input computes g(v) with g(0) = g0 and g(1) = g1
+static int emitUnary(OptimizedCircuit *opt, int g0, int g1, int input) {
+	if (g0 == g1)
+		return g0 ? REF_ONE : REF_ZERO;
+	return g0 ? emitNot(opt, input) : input;
+}
+
+static int emitFolded(OptimizedCircuit *opt, int type, int a, int b) {
+	int aConst = a == REF_ZERO || a == REF_ONE;
+	int bConst = b == REF_ZERO || b == REF_ONE;
+	int x = a == REF_ONE, y = b == REF_ONE;
+
+	if (type == NOTGATE)
+		return emitNot(opt, b);
+	if (aConst && bConst)
+		return gateValue(type, x, y) ? REF_ONE : REF_ZERO;
+	if (aConst)
+		return emitUnary(opt, gateValue(type, x, 0), gateValue(type, x, 1), b);
+	if (bConst)
+		return emitUnary(opt, gateValue(type, 0, y), gateValue(type, 1, y), a);
+	if (a == b)
+		return emitUnary(opt, gateValue(type, 0, 0), gateValue(type, 1, 1), a);
+
+	//NOTE inputs of symmetric gates (AND, OR, XOR) are ordered so that swapped duplicates hash alike
+	if (gateValue(type, 0, 1) == gateValue(type, 1, 0) && a > b) {
+		int t = a;
+		a = b;
+		b = t;
+	}
+	return emitGate(opt, type, a, b);
+}
+
+//NOTE constants that reach an output are rebuilt from input wire 0 with free gates: 0 = w0 ^ w0, 1 = NOT 0
+static int materializeConstant(OptimizedCircuit *opt, int ref) {
+	int zero = emitGate(opt, XORGATE, 0, 0);
+	return ref == REF_ZERO ? zero : emitGate(opt, NOTGATE, 0, zero);
+}
+
+
+int optimizeCircuit(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext) {
+	int n = garbledCircuit->n;
+	int m = garbledCircuit->m;
+	int q = garbledCircuit->q;
+	int r = garbledCircuit->r;
+	int i, w;
+	OptimizedCircuit opt;
+
+	opt.n = n;
+	opt.numGates = 0;
+	opt.gates = (GarbledGate *) memalign(128, sizeof(GarbledGate) * (q + 2));
+	opt.notInput = (int *) malloc(sizeof(int) * (q + 2));
+	opt.hashMask = 1;
+	while (opt.hashMask < 2 * (unsigned long) (q + 2))
+		opt.hashMask <<= 1;
+	opt.hashSlots = (int *) malloc(sizeof(int) * opt.hashMask);
+	opt.hashMask--;
+	int *ref = (int *) malloc(sizeof(int) * r);
+	if (opt.gates == NULL || opt.notInput == NULL || opt.hashSlots == NULL || ref == NULL) {
+		printf("Error allocating circuit optimizer\n");
+		free(opt.gates);
+		free(opt.notInput);
+		free(opt.hashSlots);
+		free(ref);
+		return FAILURE;
+	}
+	memset(opt.hashSlots, -1, sizeof(int) * (opt.hashMask + 1));
+
+	for (w = 0; w < r; w++) {
+		if (w < n)
+			ref[w] = w;
+		else if (garblingContext->fixedWires[w] == FIXED_ZERO_WIRE)
+			ref[w] = REF_ZERO;
+		else if (garblingContext->fixedWires[w] == FIXED_ONE_WIRE)
+			ref[w] = REF_ONE;
+		else
+			ref[w] = REF_UNDEFINED;
+	}
+
+	//NOTE gates are added by the builder after their inputs, so one pass in gate order propagates constants globally
+	int status = SUCCESS;
+	GarbledGate *gate;
+	for (i = 0; i < q && status == SUCCESS; i++) {
+		gate = &(garbledCircuit->garbledGates[i]);
+		int a = gate->type == NOTGATE ? REF_ZERO : ref[gate->input0];
+		int b = ref[gate->input1];
+		if (a == REF_UNDEFINED || b == REF_UNDEFINED) {
+			printf("Optimizer: gate %d reads a wire that is not driven\n", i);
+			status = FAILURE;
+		}
+		else {
+			ref[gate->output] = emitFolded(&opt, gate->type, a, b);
+		}
+	}
+
+	int *outputs = (int *) malloc(sizeof(int) * m);
+	for (i = 0; i < m && status == SUCCESS; i++) {
+		outputs[i] = ref[garbledCircuit->outputs[i]];
+		if (outputs[i] == REF_UNDEFINED) {
+			printf("Optimizer: output %d is not driven\n", i);
+			status = FAILURE;
+		}
+		else if (outputs[i] < 0) {
+			outputs[i] = materializeConstant(&opt, outputs[i]);
+		}
+	}
+	free(ref);
+	free(opt.hashSlots);
+	free(opt.notInput);
+	if (status == FAILURE) {
+		free(opt.gates);
+		free(outputs);
+		return FAILURE;
+	}
+
+	//NOTE dead gates are swept backwards from the outputs, the live ones keep their order and are renumbered densely
+	int numGates = opt.numGates;
+	char *live = (char *) calloc(n + 1 + numGates, 1);
+	int *renamed = (int *) malloc(sizeof(int) * (n + 1 + numGates));
+	for (i = 0; i < m; i++)
+		live[outputs[i]] = 1;
+	for (i = numGates - 1; i >= 0; i--) {
+		if (live[opt.gates[i].output]) {
+			live[opt.gates[i].input0] = 1;
+			live[opt.gates[i].input1] = 1;
+		}
+	}
+	for (w = 0; w <= n; w++)
+		renamed[w] = w;
+
+	int numLive = 0;
+	garbledCircuit->qand = garbledCircuit->qor = garbledCircuit->qxor = garbledCircuit->qnot = 0;
+	for (i = 0; i < numGates; i++) {
+		gate = &(opt.gates[i]);
+		if (!live[gate->output])
+			continue;
+		renamed[gate->output] = n + 1 + numLive;
+		gate->input0 = renamed[gate->input0];
+		gate->input1 = renamed[gate->input1];
+		gate->output = renamed[gate->output];
+		opt.gates[numLive++] = *gate;
+		if (gate->type == ANDGATE)
+			garbledCircuit->qand++;
+		else if (gate->type == ORGATE)
+			garbledCircuit->qor++;
+		else if (gate->type == XORGATE)
+			garbledCircuit->qxor++;
+		else if (gate->type == NOTGATE)
+			garbledCircuit->qnot++;
+	}
+	for (i = 0; i < m; i++)
+		garbledCircuit->outputs[i] = renamed[outputs[i]];
+	free(live);
+	free(renamed);
+	free(outputs);
+
+	printf("Optimized circuit: %d -> %d gates (AND %d, OR %d, XOR %d, NOT %d)\n", q, numLive,
+			garbledCircuit->qand, garbledCircuit->qor, garbledCircuit->qxor, garbledCircuit->qnot);
+
+	free(garbledCircuit->garbledGates);
+	garbledCircuit->garbledGates = opt.gates;
+	garbledCircuit->q = numLive;
+	garbledCircuit->r = n + 1 + numLive;
+	return SUCCESS;
+}
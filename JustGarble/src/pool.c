@@ -0,0 +1,221 @@
+/*
+	Privacy Preserving Biometric Authentication for Fingerprints and Beyond
+	Copyright (C) 2024  Marina Blanton and Dennis Murphy,
+	University at Buffalo, State University of New York.
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "../include/justGarble.h"
+#include <malloc.h>
+#include <pthread.h>
+
+
+//NOTE every worker garbles through its own shallow copy of the circuit, which shares the gates and the schedule
+//NOTE but has its own label arena (and Wire records for the legacy garblers), with the table switched per instance
+//NOTE input labels only live in the worker's scratch buffer, an instance keeps the seed they come from
+typedef struct {
+	GarblingPool *pool;
+	GarbledCircuit garbledCircuit;
+	InputLabels inputLabels;
+	pthread_t thread;
+} PoolWorker;
+
+//NOTE each instance index is in exactly one place at a time: the free ring (to be garbled), a worker, the ready
+//NOTE ring (garbled, oldest first) or the caller; both rings hold numInstances indices, so they never overflow
+struct GarblingPool {
+	GarbledCircuit *garbledCircuit;
+	GarbledInstance *instances;
+	int numInstances;
+	int *freeRing;
+	int freeHead;
+	int freeCount;
+	int *readyRing;
+	int readyHead;
+	int readyCount;
+	PoolWorker *workers;
+	int numWorkers;
+	int stopping;
+	pthread_mutex_t lock;
+	pthread_cond_t freeAvailable;
+	pthread_cond_t readyAvailable;
+};
+
+
+static void *refillPool(void *args) {
+	PoolWorker *worker = (PoolWorker *) args;
+	GarblingPool *pool = worker->pool;
+	GarbledInstance *instance;
+	int index;
+
+	while (1) {
+		pthread_mutex_lock(&pool->lock);
+		while (pool->freeCount == 0 && !pool->stopping)
+			pthread_cond_wait(&pool->freeAvailable, &pool->lock);
+		if (pool->stopping) {
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+		index = pool->freeRing[pool->freeHead];
+		pool->freeHead = (pool->freeHead + 1) % pool->numInstances;
+		pool->freeCount--;
+		pthread_mutex_unlock(&pool->lock);
+
+		instance = &(pool->instances[index]);
+		worker->garbledCircuit.garbledTable = instance->garbledTable;
+		instance->seed = createGarblingSeed();
+		garbleCircuitFromSeed(&(worker->garbledCircuit), instance->seed, worker->inputLabels, instance->outputMap);
+		instance->globalKey = worker->garbledCircuit.globalKey;
+
+		pthread_mutex_lock(&pool->lock);
+		pool->readyRing[(pool->readyHead + pool->readyCount) % pool->numInstances] = index;
+		pool->readyCount++;
+		pthread_cond_signal(&pool->readyAvailable);
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+
+
+static void freePoolMemory(GarblingPool *pool) {
+	int i;
+	if (pool->instances != NULL) {
+		for (i = 0; i < pool->numInstances; i++) {
+			free(pool->instances[i].garbledTable);
+			free(pool->instances[i].outputMap);
+		}
+	}
+	if (pool->workers != NULL) {
+		for (i = 0; i < pool->numWorkers; i++) {
+			free(pool->workers[i].inputLabels);
+			free(pool->workers[i].garbledCircuit.labels);
+			free(pool->workers[i].garbledCircuit.wires);
+		}
+	}
+	free(pool->instances);
+	free(pool->workers);
+	free(pool->freeRing);
+	free(pool->readyRing);
+	free(pool);
+}
+
+
+GarblingPool *createGarblingPool(GarbledCircuit *garbledCircuit, int numInstances, int numWorkers) {
+	int i;
+	if (numInstances < 1 || numWorkers < 1 || prepareGarbling(garbledCircuit) == FAILURE)
+		return NULL;
+
+	GarblingPool *pool = (GarblingPool *) calloc(1, sizeof(GarblingPool));
+	if (pool == NULL) {
+		printf("Error allocating garbling pool\n");
+		return NULL;
+	}
+	pool->garbledCircuit = garbledCircuit;
+	pool->numInstances = numInstances;
+	pool->numWorkers = numWorkers;
+	pool->instances = (GarbledInstance *) calloc(numInstances, sizeof(GarbledInstance));
+	pool->workers = (PoolWorker *) calloc(numWorkers, sizeof(PoolWorker));
+	pool->freeRing = (int *) malloc(sizeof(int) * numInstances);
+	pool->readyRing = (int *) malloc(sizeof(int) * numInstances);
+	if (pool->instances == NULL || pool->workers == NULL || pool->freeRing == NULL || pool->readyRing == NULL) {
+		printf("Error allocating garbling pool\n");
+		freePoolMemory(pool);
+		return NULL;
+	}
+
+	long tableBytes = sizeof(GarbledTable) * (long) getTableRows(garbledCircuit);
+	for (i = 0; i < numInstances; i++) {
+		pool->instances[i].garbledTable = (GarbledTable *) memalign(128, tableBytes);
+		pool->instances[i].outputMap = (block *) memalign(128, sizeof(block) * 2 * garbledCircuit->m);
+		if (pool->instances[i].garbledTable == NULL || pool->instances[i].outputMap == NULL) {
+			printf("Error allocating garbling pool\n");
+			freePoolMemory(pool);
+			return NULL;
+		}
+		pool->freeRing[i] = i;
+	}
+	pool->freeCount = numInstances;
+
+	for (i = 0; i < numWorkers; i++) {
+		GarbledCircuit *workerCircuit = &(pool->workers[i].garbledCircuit);
+		pool->workers[i].pool = pool;
+		pool->workers[i].inputLabels = (block *) memalign(128, sizeof(block) * 2 * garbledCircuit->n);
+		*workerCircuit = *garbledCircuit;
+		workerCircuit->labels = NULL;
+		workerCircuit->wires = NULL;
+		if (pool->workers[i].inputLabels == NULL) {
+			printf("Error allocating garbling pool\n");
+			freePoolMemory(pool);
+			return NULL;
+		}
+#ifdef HALF_GATES
+		if (createLabelArena(workerCircuit) == FAILURE) {
+			freePoolMemory(pool);
+			return NULL;
+		}
+#else
+		workerCircuit->wires = (Wire *) malloc(sizeof(Wire) * garbledCircuit->r);
+		if (workerCircuit->wires == NULL) {
+			printf("Error allocating garbling pool\n");
+			freePoolMemory(pool);
+			return NULL;
+		}
+		memcpy(workerCircuit->wires, garbledCircuit->wires, sizeof(Wire) * garbledCircuit->r);
+#endif
+	}
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->freeAvailable, NULL);
+	pthread_cond_init(&pool->readyAvailable, NULL);
+	for (i = 0; i < numWorkers; i++)
+		pthread_create(&(pool->workers[i].thread), NULL, refillPool, &(pool->workers[i]));
+	return pool;
+}
+
+
+GarbledInstance *takeGarbledInstance(GarblingPool *pool) {
+	pthread_mutex_lock(&pool->lock);
+	while (pool->readyCount == 0)
+		pthread_cond_wait(&pool->readyAvailable, &pool->lock);
+	int index = pool->readyRing[pool->readyHead];
+	pool->readyHead = (pool->readyHead + 1) % pool->numInstances;
+	pool->readyCount--;
+	pthread_mutex_unlock(&pool->lock);
+	return &(pool->instances[index]);
+}
+
+
+void releaseGarbledInstance(GarblingPool *pool, GarbledInstance *instance) {
+	pthread_mutex_lock(&pool->lock);
+	pool->freeRing[(pool->freeHead + pool->freeCount) % pool->numInstances] = instance - pool->instances;
+	pool->freeCount++;
+	pthread_cond_signal(&pool->freeAvailable);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+
+void removeGarblingPool(GarblingPool *pool) {
+	int i;
+	pthread_mutex_lock(&pool->lock);
+	pool->stopping = 1;
+	pthread_cond_broadcast(&pool->freeAvailable);
+	pthread_mutex_unlock(&pool->lock);
+	for (i = 0; i < pool->numWorkers; i++)
+		pthread_join(pool->workers[i].thread, NULL);
+
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->freeAvailable);
+	pthread_cond_destroy(&pool->readyAvailable);
+	freePoolMemory(pool);
+}
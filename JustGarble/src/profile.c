@@ -0,0 +1,249 @@
+/*
+	Privacy Preserving Biometric Authentication for Fingerprints and Beyond
+	Copyright (C) 2024  Marina Blanton and Dennis Murphy,
+	University at Buffalo, State University of New York.
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "../include/justGarble.h"
+#include "../include/garble.h"
+#include <malloc.h>
+
+
+//NOTE regions with the same name and parent are merged, so a routine called many times from one place is one node
+//NOTE counts are inclusive (children included) and summed over calls, depth is the largest over calls
+typedef struct {
+	const char *name;
+	int parent;
+	int firstChild;
+	int lastChild;
+	int nextSibling;
+	long calls;
+	long nonFreeGates;
+	long xorGates;
+	long notGates;
+	long wires;
+	int depth;
+} ProfileRegion;
+
+typedef struct {
+	int region;
+	long gateStart;
+	long wireStart;
+} OpenRegion;
+
+//NOTE wireDepth[w] is the AND-depth of wire w within the region being closed, see regionDepth()
+struct CircuitProfile {
+	ProfileRegion *regions;
+	int numRegions;
+	int maxRegions;
+	OpenRegion *stack;
+	int stackSize;
+	int maxStack;
+	int *wireDepth;
+	long maxWires;
+};
+
+
+static void *growArray(void *array, int *capacity, size_t size) {
+	*capacity = *capacity > 0 ? 2 * *capacity : 16;
+	void *grown = realloc(array, size * *capacity);
+	if (grown == NULL) {
+		dbgs("Linux is a cheap miser that refuses to give us memory");
+		exit(1);
+	}
+	return grown;
+}
+
+static int findChild(CircuitProfile *profile, int parent, const char *name) {
+	int c = parent >= 0 ? profile->regions[parent].firstChild : -1;
+	while (c >= 0 && strcmp(profile->regions[c].name, name) != 0)
+		c = profile->regions[c].nextSibling;
+	if (c >= 0)
+		return c;
+
+	if (profile->numRegions == profile->maxRegions)
+		profile->regions = (ProfileRegion *) growArray(profile->regions, &profile->maxRegions, sizeof(ProfileRegion));
+	c = profile->numRegions++;
+	memset(&(profile->regions[c]), 0, sizeof(ProfileRegion));
+	profile->regions[c].name = name;
+	profile->regions[c].parent = parent;
+	profile->regions[c].firstChild = -1;
+	profile->regions[c].lastChild = -1;
+	profile->regions[c].nextSibling = -1;
+	if (parent >= 0) {
+		if (profile->regions[parent].lastChild >= 0)
+			profile->regions[profile->regions[parent].lastChild].nextSibling = c;
+		else
+			profile->regions[parent].firstChild = c;
+		profile->regions[parent].lastChild = c;
+	}
+	return c;
+}
+
+//NOTE wires from before the region count as depth 0, so this is the AND-depth the region adds on its own
+static int regionDepth(GarbledCircuit *garbledCircuit, CircuitProfile *profile, long gateStart, long gateEnd, long wireStart, long wireEnd) {
+	long i, w;
+	int d0, d1, d, depth = 0;
+	GarbledGate *gate;
+
+	if (wireEnd > profile->maxWires) {
+		profile->maxWires = wireEnd > 2 * profile->maxWires ? wireEnd : 2 * profile->maxWires;
+		free(profile->wireDepth);
+		profile->wireDepth = (int *) malloc(sizeof(int) * profile->maxWires);
+	}
+	for (w = wireStart; w < wireEnd; w++)
+		profile->wireDepth[w] = 0;
+
+	for (i = gateStart; i < gateEnd; i++) {
+		gate = &(garbledCircuit->garbledGates[i]);
+		d0 = gate->input0 >= wireStart && gate->input0 < wireEnd ? profile->wireDepth[gate->input0] : 0;
+		d1 = gate->input1 >= wireStart && gate->input1 < wireEnd ? profile->wireDepth[gate->input1] : 0;
+		d = (d0 > d1 ? d0 : d1) + (gate->type != XORGATE && gate->type != NOTGATE);
+		if (gate->output >= wireStart && gate->output < wireEnd)
+			profile->wireDepth[gate->output] = d;
+		if (d > depth)
+			depth = d;
+	}
+	return depth;
+}
+
+
+int startProfiling(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, const char *name) {
+	CircuitProfile *profile = (CircuitProfile *) calloc(1, sizeof(CircuitProfile));
+	if (profile == NULL)
+		return FAILURE;
+	garblingContext->profile = profile;
+	pushProfileRegion(garbledCircuit, garblingContext, name);
+	return SUCCESS;
+}
+
+void pushProfileRegion(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, const char *name) {
+	CircuitProfile *profile = garblingContext->profile;
+	if (profile == NULL)
+		return;
+
+	int parent = profile->stackSize > 0 ? profile->stack[profile->stackSize - 1].region : -1;
+	if (profile->stackSize == profile->maxStack)
+		profile->stack = (OpenRegion *) growArray(profile->stack, &profile->maxStack, sizeof(OpenRegion));
+	OpenRegion *open = &(profile->stack[profile->stackSize++]);
+	open->region = findChild(profile, parent, name);
+	open->gateStart = garblingContext->gateIndex;
+	open->wireStart = garblingContext->wireIndex;
+}
+
+void popProfileRegion(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext) {
+	CircuitProfile *profile = garblingContext->profile;
+	if (profile == NULL || profile->stackSize == 0)
+		return;
+
+	OpenRegion *open = &(profile->stack[--profile->stackSize]);
+	ProfileRegion *region = &(profile->regions[open->region]);
+	long i;
+	int type, depth;
+
+	for (i = open->gateStart; i < garblingContext->gateIndex; i++) {
+		type = garbledCircuit->garbledGates[i].type;
+		if (type == XORGATE)
+			region->xorGates++;
+		else if (type == NOTGATE)
+			region->notGates++;
+		else
+			region->nonFreeGates++;
+	}
+	region->wires += garblingContext->wireIndex - open->wireStart;
+	region->calls++;
+	depth = regionDepth(garbledCircuit, profile, open->gateStart, garblingContext->gateIndex, open->wireStart, garblingContext->wireIndex);
+	if (depth > region->depth)
+		region->depth = depth;
+}
+
+
+static long selfNonFreeGates(CircuitProfile *profile, int r) {
+	long self = profile->regions[r].nonFreeGates;
+	for (int c = profile->regions[r].firstChild; c >= 0; c = profile->regions[c].nextSibling)
+		self -= profile->regions[c].nonFreeGates;
+	return self;
+}
+
+static void printRegion(CircuitProfile *profile, int r, int level) {
+	ProfileRegion *region = &(profile->regions[r]);
+	printf("%*s%-*s %8ld %11ld %11ld %11ld %9ld %11ld %7d\n", 2 * level, "", 48 - 2 * level, region->name, region->calls,
+			region->nonFreeGates, selfNonFreeGates(profile, r), region->xorGates, region->notGates, region->wires, region->depth);
+	for (int c = region->firstChild; c >= 0; c = profile->regions[c].nextSibling)
+		printRegion(profile, c, level + 1);
+}
+
+//NOTE one line per region with its stack of region names, then its own non-free gates: the collapsed stack
+//NOTE format that flamegraph.pl and speedscope read
+static void writeFolded(FILE *f, CircuitProfile *profile, int r, char *stack, int length) {
+	long self = selfNonFreeGates(profile, r);
+	int c;
+	length += sprintf(stack + length, "%s%s", length > 0 ? ";" : "", profile->regions[r].name);
+	if (self > 0)
+		fprintf(f, "%s %ld\n", stack, self);
+	for (c = profile->regions[r].firstChild; c >= 0; c = profile->regions[c].nextSibling)
+		writeFolded(f, profile, c, stack, length);
+}
+
+static int stackLength(CircuitProfile *profile, int r) {
+	int length = 0, c;
+	for (c = profile->regions[r].firstChild; c >= 0; c = profile->regions[c].nextSibling) {
+		int l = stackLength(profile, c);
+		if (l > length)
+			length = l;
+	}
+	return length + strlen(profile->regions[r].name) + 1;
+}
+
+int finishProfiling(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, char *reportFile) {
+	CircuitProfile *profile = garblingContext->profile;
+	if (profile == NULL)
+		return FAILURE;
+
+	if (profile->stackSize != 1)
+		printf("Profiler: %d regions left open, closing them\n", profile->stackSize - 1);
+	while (profile->stackSize > 0)
+		popProfileRegion(garbledCircuit, garblingContext);
+
+	printf("\nGate profile, as built (before optimization):\n");
+	printf("%-48s %8s %11s %11s %11s %9s %11s %7s\n", "region", "calls", "AND/OR", "AND/OR self", "XOR", "NOT", "wires", "depth");
+	printRegion(profile, 0, 0);
+
+	int status = SUCCESS;
+	if (reportFile != NULL) {
+		FILE *f = fopen(reportFile, "w");
+		char *stack = (char *) malloc(stackLength(profile, 0) + 1);
+		if (f == NULL || stack == NULL) {
+			printf("Profiler: could not write %s\n", reportFile);
+			status = FAILURE;
+		}
+		else {
+			writeFolded(f, profile, 0, stack, 0);
+			printf("Folded stacks of non-free gates written to %s\n", reportFile);
+		}
+		if (f != NULL)
+			fclose(f);
+		free(stack);
+	}
+
+	free(profile->regions);
+	free(profile->stack);
+	free(profile->wireDepth);
+	free(profile);
+	garblingContext->profile = NULL;
+	return status;
+}
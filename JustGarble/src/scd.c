@@ -28,7 +28,11 @@
 #include <ctype.h>
 #include <msgpack.h>
 #include <malloc.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 long fsize(const char *filename) {
 	struct stat st;
@@ -39,6 +43,351 @@ long fsize(const char *filename) {
 	return -1;
 }
 
+//NOTE SCD v2: a fixed header followed by sections at 64-byte aligned offsets, see SCD_Format
+//NOTE the packed encoding stores GarbledGate, PackedGate and int arrays exactly as laid out in memory, so files are only
+//NOTE portable between builds with the same struct sizes and byte order, which the header records and the reader checks
+#define SCD2_MAGIC "JGSCD2\n"
+#define SCD2_VERSION 2
+#define SCD2_ALIGNMENT 64
+#define SCD2_BYTE_ORDER 0x01020304
+
+typedef struct {
+	char magic[8];
+	int byteOrder;	//SCD2_BYTE_ORDER as stored by the writer
+	int version;
+	int encoding;
+	int headerSize;
+	int gateSize;
+	int packedGateSize;
+	int scheduleWindow;	//SCHEDULE_WINDOW_SIZE of the writer, packed schedule only
+	int freeGateMask;	//bit t set if gate type t is free for the writer, packed schedule only
+	int n, m, q, r;
+	int numLevels;	//-1 if no schedule is stored
+	int numSlots;
+	long gatesOffset, gatesSize;
+	long outputsOffset;
+	long levelStartOffset, levelFreeOffset, scheduleGatesOffset, scheduleOutputsOffset;
+	long fileSize;
+} SCD2Header;
+
+static long scd2Align(long offset) {
+	return (offset + SCD2_ALIGNMENT - 1) & ~((long) SCD2_ALIGNMENT - 1);
+}
+
+static int scd2FreeGateMask() {
+	int type, mask = 0;
+	for (type = 0; type < 16; type++)
+		if (isFreeGate(type))
+			mask |= 1 << type;
+	return mask;
+}
+
+//NOTE zigzag varints, so that small negative deltas stay short
+static long scd2PutVarint(unsigned char *out, long value) {
+	unsigned long v = ((unsigned long) value << 1) ^ (unsigned long) (value >> 63);
+	long len = 0;
+	while (v >= 0x80) {
+		out[len++] = (unsigned char) (v | 0x80);
+		v >>= 7;
+	}
+	out[len++] = (unsigned char) v;
+	return len;
+}
+
+//NOTE a varint running past end, or longer than 64 bits, leaves *in past end
+static long scd2GetVarint(unsigned char **in, unsigned char *end) {
+	unsigned long v = 0;
+	int shift = 0;
+	while (*in < end && (**in & 0x80)) {
+		if (shift > 63) {
+			*in = end + 1;
+			return 0;
+		}
+		v |= (unsigned long) (*(*in)++ & 0x7f) << shift;
+		shift += 7;
+	}
+	if (*in >= end || shift > 63) {
+		*in = end + 1;
+		return 0;
+	}
+	v |= (unsigned long) *(*in)++ << shift;
+	return (long) (v >> 1) ^ -(long) (v & 1);
+}
+
+//NOTE varint gate i is (output - (n + i + 1), output - input0, output - input1, type), so circuits numbered as in SCD v1
+//NOTE cost one byte for the output and short deltas for nearby inputs
+static long scd2EncodeGates(GarbledCircuit *garbledCircuit, unsigned char *out) {
+	long len = 0;
+	int i;
+	GarbledGate *garbledGate;
+	for (i = 0; i < garbledCircuit->q; i++) {
+		garbledGate = &(garbledCircuit->garbledGates[i]);
+		len += scd2PutVarint(out + len, garbledGate->output - (garbledCircuit->n + i + 1));
+		len += scd2PutVarint(out + len, garbledGate->output - garbledGate->input0);
+		len += scd2PutVarint(out + len, garbledGate->output - garbledGate->input1);
+		out[len++] = (unsigned char) garbledGate->type;
+	}
+	return len;
+}
+
+static int scd2DecodeGates(GarbledCircuit *garbledCircuit, unsigned char *in, unsigned char *end) {
+	int i;
+	GarbledGate *garbledGate;
+	for (i = 0; i < garbledCircuit->q; i++) {
+		garbledGate = &(garbledCircuit->garbledGates[i]);
+		garbledGate->id = 0;
+		garbledGate->output = garbledCircuit->n + i + 1 + scd2GetVarint(&in, end);
+		garbledGate->input0 = garbledGate->output - scd2GetVarint(&in, end);
+		garbledGate->input1 = garbledGate->output - scd2GetVarint(&in, end);
+		if (in >= end)
+			return FAILURE;
+		garbledGate->type = *in++;
+	}
+	return SUCCESS;
+}
+
+int writeCircuitToFileSCD2(GarbledCircuit *garbledCircuit, char *fileName, int encoding) {
+	SCD2Header header;
+	int n = garbledCircuit->n;
+	int m = garbledCircuit->m;
+	int q = garbledCircuit->q;
+	unsigned char *encodedGates = NULL;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SCD2_MAGIC, sizeof(header.magic));
+	header.byteOrder = SCD2_BYTE_ORDER;
+	header.version = SCD2_VERSION;
+	header.encoding = encoding;
+	header.headerSize = sizeof(SCD2Header);
+	header.gateSize = sizeof(GarbledGate);
+	header.packedGateSize = sizeof(PackedGate);
+	header.n = n;
+	header.m = m;
+	header.q = q;
+	header.r = garbledCircuit->r;
+	header.numLevels = -1;
+
+	header.gatesOffset = scd2Align(sizeof(SCD2Header));
+	if (encoding == SCD2_VARINT) {
+		//at most 3 varints of 10 bytes and a type byte per gate
+		encodedGates = (unsigned char *) malloc(31L * q + 1);
+		if (encodedGates == NULL) {
+			printf("Write: Error allocating encoding buffer.\n");
+			return FAILURE;
+		}
+		header.gatesSize = scd2EncodeGates(garbledCircuit, encodedGates);
+	}
+	else {
+		header.gatesSize = sizeof(GarbledGate) * (long) q;
+	}
+	header.outputsOffset = scd2Align(header.gatesOffset + header.gatesSize);
+	header.fileSize = header.outputsOffset + sizeof(int) * (long) m;
+
+	GateSchedule *schedule = NULL;
+	if (encoding == SCD2_PACKED) {
+		if (garbledCircuit->schedule == NULL && levelizeCircuit(garbledCircuit) == FAILURE)
+			return FAILURE;
+		schedule = garbledCircuit->schedule;
+		header.scheduleWindow = SCHEDULE_WINDOW_SIZE;
+		header.freeGateMask = scd2FreeGateMask();
+		header.numLevels = schedule->numLevels;
+		header.numSlots = schedule->numSlots;
+		header.scheduleGatesOffset = scd2Align(header.fileSize);
+		header.levelStartOffset = scd2Align(header.scheduleGatesOffset + sizeof(PackedGate) * (long) q);
+		header.levelFreeOffset = scd2Align(header.levelStartOffset + sizeof(int) * (long) (schedule->numLevels + 1));
+		header.scheduleOutputsOffset = scd2Align(header.levelFreeOffset + sizeof(int) * (long) schedule->numLevels);
+		header.fileSize = header.scheduleOutputsOffset + sizeof(int) * (long) m;
+	}
+
+	FILE *f = fopen(fileName, "wb");
+	if (f == NULL) {
+		printf("Write: Error in opening file.\n");
+		free(encodedGates);
+		return FAILURE;
+	}
+
+	//NOTE sections are written in offset order, padding with zeros up to each offset
+	long written = 0;
+	char padding[SCD2_ALIGNMENT] = { 0 };
+#define SCD2_WRITE_SECTION(offset, data, size) \
+	do { \
+		fwrite(padding, (offset) - written, 1, f); \
+		fwrite((data), (size), 1, f); \
+		written = (offset) + (size); \
+	} while (0)
+
+	SCD2_WRITE_SECTION(0, &header, sizeof(SCD2Header));
+	if (encoding == SCD2_VARINT)
+		SCD2_WRITE_SECTION(header.gatesOffset, encodedGates, header.gatesSize);
+	else
+		SCD2_WRITE_SECTION(header.gatesOffset, garbledCircuit->garbledGates, header.gatesSize);
+	SCD2_WRITE_SECTION(header.outputsOffset, garbledCircuit->outputs, sizeof(int) * (long) m);
+	if (schedule != NULL) {
+		SCD2_WRITE_SECTION(header.scheduleGatesOffset, schedule->gates, sizeof(PackedGate) * (long) q);
+		SCD2_WRITE_SECTION(header.levelStartOffset, schedule->levelStart, sizeof(int) * (long) (schedule->numLevels + 1));
+		SCD2_WRITE_SECTION(header.levelFreeOffset, schedule->levelFree, sizeof(int) * (long) schedule->numLevels);
+		SCD2_WRITE_SECTION(header.scheduleOutputsOffset, schedule->outputs, sizeof(int) * (long) m);
+	}
+#undef SCD2_WRITE_SECTION
+
+	fclose(f);
+	free(encodedGates);
+	return SUCCESS;
+}
+
+//NOTE a section must lie between the header and the end of the file
+static int scd2SectionFits(long offset, long size, long fileSize) {
+	return offset >= (long) sizeof(SCD2Header) && size >= 0 && offset <= fileSize && size <= fileSize - offset;
+}
+
+//NOTE undoes a partial read, releasing the schedule, the decoded gates and the file mapping
+static int scd2ReadFailed(GarbledCircuit *garbledCircuit, char *file, long fileSize) {
+	removeSchedule(garbledCircuit);
+	if (garbledCircuit->mappedFile == NULL) {
+		free(garbledCircuit->garbledGates);
+		free(garbledCircuit->outputs);
+	}
+	garbledCircuit->garbledGates = NULL;
+	garbledCircuit->outputs = NULL;
+	garbledCircuit->mappedFile = NULL;
+	garbledCircuit->mappedSize = 0;
+	if (file != NULL)
+		munmap(file, fileSize);
+	return FAILURE;
+}
+
+static int readCircuitFromFileSCD2(GarbledCircuit *garbledCircuit, char *fileName) {
+	int fd = open(fileName, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0 || st.st_size < (long) sizeof(SCD2Header)) {
+		printf("READ:Error in opening file %s.\n", fileName);
+		if (fd >= 0)
+			close(fd);
+		return FAILURE;
+	}
+	//NOTE private writable mapping: pages stay shared with other readers unless written to
+	char *file = (char *) mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (file == MAP_FAILED) {
+		printf("READ:Error in mapping file %s.\n", fileName);
+		return FAILURE;
+	}
+
+	SCD2Header *header = (SCD2Header *) file;
+	if (header->byteOrder != SCD2_BYTE_ORDER || header->version != SCD2_VERSION || header->headerSize != sizeof(SCD2Header)
+			|| header->gateSize != sizeof(GarbledGate) || header->packedGateSize != sizeof(PackedGate)
+			|| header->fileSize != st.st_size) {
+		printf("READ:Incompatible SCD v2 file %s.\n", fileName);
+		munmap(file, st.st_size);
+		return FAILURE;
+	}
+
+	long fileSize = st.st_size;
+	int sectionsFit = header->n >= 0 && header->m >= 0 && header->q >= 0 && header->r >= 0 && header->numLevels >= -1
+			&& (header->encoding == SCD2_VARINT || header->encoding == SCD2_PACKED)
+			&& scd2SectionFits(header->gatesOffset, header->gatesSize, fileSize)
+			&& scd2SectionFits(header->outputsOffset, sizeof(int) * (long) header->m, fileSize);
+	if (sectionsFit && header->encoding == SCD2_PACKED) {
+		sectionsFit = header->gatesSize == sizeof(GarbledGate) * (long) header->q;
+		if (sectionsFit && header->numLevels >= 0)
+			sectionsFit = scd2SectionFits(header->scheduleGatesOffset, sizeof(PackedGate) * (long) header->q, fileSize)
+					&& scd2SectionFits(header->levelStartOffset, sizeof(int) * ((long) header->numLevels + 1), fileSize)
+					&& scd2SectionFits(header->levelFreeOffset, sizeof(int) * (long) header->numLevels, fileSize)
+					&& scd2SectionFits(header->scheduleOutputsOffset, sizeof(int) * (long) header->m, fileSize);
+	}
+	if (!sectionsFit) {
+		printf("READ:Corrupt SCD v2 file %s.\n", fileName);
+		munmap(file, st.st_size);
+		return FAILURE;
+	}
+
+	int n = header->n;
+	int m = header->m;
+	int q = header->q;
+	garbledCircuit->n = n;
+	garbledCircuit->m = m;
+	garbledCircuit->q = q;
+	garbledCircuit->r = header->r;
+	garbledCircuit->schedule = NULL;
+	garbledCircuit->labels = NULL;
+	garbledCircuit->mappedFile = file;
+	garbledCircuit->mappedSize = st.st_size;
+	garbledCircuit->garbledTable = NULL;
+
+	if (header->encoding == SCD2_VARINT) {
+		garbledCircuit->mappedFile = NULL;
+		garbledCircuit->mappedSize = 0;
+		garbledCircuit->outputs = (int *) memalign(128, sizeof(int) * m);
+		garbledCircuit->garbledGates = (GarbledGate *) memalign(128,
+				sizeof(GarbledGate) * q);
+		if (garbledCircuit->garbledGates == NULL || garbledCircuit->outputs == NULL) {
+			printf("Linux is a cheap miser that refuses to give us memory\n");
+			return scd2ReadFailed(garbledCircuit, file, fileSize);
+		}
+		unsigned char *encodedGates = (unsigned char *) (file + header->gatesOffset);
+		if (scd2DecodeGates(garbledCircuit, encodedGates, encodedGates + header->gatesSize) == FAILURE) {
+			printf("READ:Corrupt SCD v2 file %s.\n", fileName);
+			return scd2ReadFailed(garbledCircuit, file, fileSize);
+		}
+		memcpy(garbledCircuit->outputs, file + header->outputsOffset, sizeof(int) * m);
+		munmap(file, st.st_size);
+		file = NULL;
+	}
+	else {
+		garbledCircuit->garbledGates = (GarbledGate *) (file + header->gatesOffset);
+		garbledCircuit->outputs = (int *) (file + header->outputsOffset);
+
+		//NOTE a stored schedule is only valid for builds that levelize the same way
+		if (header->numLevels >= 0 && header->scheduleWindow == SCHEDULE_WINDOW_SIZE
+				&& header->freeGateMask == scd2FreeGateMask()) {
+			GateSchedule *schedule = (GateSchedule *) calloc(1, sizeof(GateSchedule));
+			if (schedule == NULL) {
+				printf("Error allocating gate schedule\n");
+				return scd2ReadFailed(garbledCircuit, file, fileSize);
+			}
+			schedule->mapped = 1;
+			schedule->numLevels = header->numLevels;
+			schedule->numSlots = header->numSlots;
+			schedule->gates = (PackedGate *) (file + header->scheduleGatesOffset);
+			schedule->levelStart = (int *) (file + header->levelStartOffset);
+			schedule->levelFree = (int *) (file + header->levelFreeOffset);
+			schedule->outputs = (int *) (file + header->scheduleOutputsOffset);
+			int l;
+			for (l = 0; l < schedule->numLevels; l++)
+				schedule->numTables += schedule->levelFree[l] - schedule->levelStart[l];
+			garbledCircuit->schedule = schedule;
+		}
+	}
+
+	if (garbledCircuit->schedule == NULL && levelizeCircuit(garbledCircuit) == FAILURE)
+		return scd2ReadFailed(garbledCircuit, file, fileSize);
+	if (createGarbledTable(garbledCircuit) == FAILURE)
+		return scd2ReadFailed(garbledCircuit, file, fileSize);
+#ifdef HALF_GATES
+	garbledCircuit->wires = NULL;
+	if (createLabelArena(garbledCircuit) == FAILURE) {
+		free(garbledCircuit->garbledTable);
+		garbledCircuit->garbledTable = NULL;
+		return scd2ReadFailed(garbledCircuit, file, fileSize);
+	}
+	return SUCCESS;
+#else
+	garbledCircuit->wires = (Wire *) malloc(sizeof(Wire) * garbledCircuit->r);
+	if (garbledCircuit->wires == NULL) {
+		printf("Linux is a cheap miser that refuses to give us memory\n");
+		free(garbledCircuit->garbledTable);
+		garbledCircuit->garbledTable = NULL;
+		return scd2ReadFailed(garbledCircuit, file, fileSize);
+	}
+	int i;
+	for (i = 0; i < garbledCircuit->r; i++) {
+		garbledCircuit->wires[i].id = 0;
+	}
+	return SUCCESS;
+#endif
+}
+
+
 int writeCircuitToFile(GarbledCircuit *garbledCircuit, char *fileName) {
 	FILE *f = fopen(fileName, "wb");
 	if (f == NULL) {
@@ -77,6 +426,8 @@ int writeCircuitToFile(GarbledCircuit *garbledCircuit, char *fileName) {
 	}
 	fwrite(buffer->data, (buffer->size), 1, f);
 	fclose(f);
+	msgpack_packer_free(pk);
+	msgpack_sbuffer_free(buffer);
 	return SUCCESS;
 }
 
@@ -87,6 +438,12 @@ int readCircuitFromFile(GarbledCircuit *garbledCircuit, char *fileName) {
 		printf("READ:Error in opening file %s.\n", fileName);
 		return FAILURE;
 	}
+	char magic[sizeof(SCD2_MAGIC)];
+	if (fread(magic, sizeof(magic), 1, f) == 1 && memcmp(magic, SCD2_MAGIC, sizeof(magic)) == 0) {
+		fclose(f);
+		return readCircuitFromFileSCD2(garbledCircuit, fileName);
+	}
+	rewind(f);
 	msgpack_sbuffer* buffer = msgpack_sbuffer_new();
 	void *storage = malloc(fs);
 	if (fread(storage, fs, 1, f) != 1) {
@@ -111,12 +468,25 @@ int readCircuitFromFile(GarbledCircuit *garbledCircuit, char *fileName) {
 	garbledCircuit->n = n;
 	garbledCircuit->q = q;
 	garbledCircuit->r = r;
+	garbledCircuit->schedule = NULL;
+	garbledCircuit->labels = NULL;
+	garbledCircuit->mappedFile = NULL;
+	garbledCircuit->mappedSize = 0;
 
 	garbledCircuit->outputs = (int *) memalign(128, sizeof(int) * m);
 	garbledCircuit->garbledGates = (GarbledGate *) memalign(128,
 			sizeof(GarbledGate) * q);
-	garbledCircuit->garbledTable = (GarbledTable *) memalign(128,
-			sizeof(GarbledTable) * q);
+	//NOTE the table is sized once the circuit is levelized, see createGarbledTable()
+	garbledCircuit->garbledTable = NULL;
+#ifdef HALF_GATES
+	//NOTE the half-gates garbler and evaluator only touch the label arena, so no Wire records are needed
+	garbledCircuit->wires = NULL;
+	if (garbledCircuit->garbledGates == NULL || garbledCircuit->outputs == NULL) {
+		printf("Linux is a cheap miser that refuses to give us memory\n");
+		return FAILURE;
+	}
+	int i;
+#else
 	garbledCircuit->wires = (Wire *) malloc(sizeof(Wire) * garbledCircuit->r);
 	if (garbledCircuit->garbledGates == NULL
 			|| garbledCircuit->garbledGates == NULL
@@ -128,6 +498,7 @@ int readCircuitFromFile(GarbledCircuit *garbledCircuit, char *fileName) {
 	for (i = 0; i < garbledCircuit->r; i++) {
 		garbledCircuit->wires[i].id = 0;
 	}
+#endif
 	for (i = 0; i < q; i++) {
 		garbledCircuit->garbledGates[i].id = 0;
 		garbledCircuit->garbledGates[i].output = n+i+1;
@@ -148,6 +519,15 @@ int readCircuitFromFile(GarbledCircuit *garbledCircuit, char *fileName) {
 		++p;
 		garbledCircuit->outputs[i] = (*p).via.i64;
 	}
+	//NOTE this also frees storage, which the sbuffer took over above
+	msgpack_unpacked_destroy(&msg);
+	msgpack_sbuffer_free(buffer);
+	if (levelizeCircuit(garbledCircuit) == FAILURE || createGarbledTable(garbledCircuit) == FAILURE)
+		return FAILURE;
+#ifdef HALF_GATES
+	return createLabelArena(garbledCircuit);
+#else
 	return SUCCESS;
+#endif
 }
 
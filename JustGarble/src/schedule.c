@@ -0,0 +1,385 @@
+/*
+ This file is part of JustGarble.
+
+    JustGarble is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    JustGarble is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with JustGarble.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/* NOTE This file has been introduced into justGarble for use in the applied-crypto-lab/biom-auth codebase */
+
+
+#include "../include/common.h"
+#include "../include/garble.h"
+#include "../include/justGarble.h"
+
+#include <malloc.h>
+#include <limits.h>
+#include <string.h>
+
+
+//NOTE renames the wires of gates[0] to gates[count - 1], taken in this order, onto label slots that are recycled
+//NOTE once the last gate reading a wire is done; every wire below numWires is assumed to be written at most once
+//NOTE gates sharing a group number (group == NULL: every gate on its own) may run concurrently, so the slots read by
+//NOTE a group are released only after all of its outputs have been placed
+//NOTE wires below n keep their ids, the m wires in outputs are never released and are renamed in place
+//NOTE returns the number of slots used, or FAILURE
+static int renameWires(PackedGate *gates, int count, int *group, int numWires, int n, int *outputs, int m) {
+	int i, j, k, g, end, w;
+	int *lastUse = (int *) malloc(sizeof(int) * numWires);
+	int *slot = (int *) malloc(sizeof(int) * numWires);
+	int *freeSlots = (int *) malloc(sizeof(int) * numWires);
+	int numFree = 0, numSlots = n;
+
+	if (lastUse == NULL || slot == NULL || freeSlots == NULL) {
+		printf("Error allocating wire slots\n");
+		return FAILURE;
+	}
+
+	for (w = 0; w < numWires; w++) {
+		lastUse[w] = -1;
+		slot[w] = w < n ? w : -1;
+	}
+	for (i = 0; i < count; i++) {
+		g = group == NULL ? i : group[i];
+		lastUse[gates[i].input0] = g;
+		lastUse[gates[i].input1] = g;
+	}
+	for (k = 0; k < m; k++)
+		lastUse[outputs[k]] = INT_MAX;
+	for (w = n - 1; w >= 0; w--)
+		if (lastUse[w] < 0)
+			freeSlots[numFree++] = w;
+
+	int *wireIds[3];
+	for (i = 0; i < count; i = end) {
+		g = group == NULL ? i : group[i];
+		for (end = i + 1; end < count && group != NULL && group[end] == g; end++)
+			;
+
+		//wires read before being written (e.g. unused fixed wires) still need a slot of their own
+		for (j = i; j < end; j++) {
+			if (slot[gates[j].input0] < 0)
+				slot[gates[j].input0] = numFree > 0 ? freeSlots[--numFree] : numSlots++;
+			if (slot[gates[j].input1] < 0)
+				slot[gates[j].input1] = numFree > 0 ? freeSlots[--numFree] : numSlots++;
+		}
+		for (j = i; j < end; j++)
+			slot[gates[j].output] = numFree > 0 ? freeSlots[--numFree] : numSlots++;
+
+		for (j = i; j < end; j++) {
+			wireIds[0] = &(gates[j].input0);
+			wireIds[1] = &(gates[j].input1);
+			wireIds[2] = &(gates[j].output);
+			for (k = 0; k < 3; k++) {
+				w = *wireIds[k];
+				*wireIds[k] = slot[w];
+				//NOTE a wire nobody reads is released right after it is written
+				if (lastUse[w] == g || (k == 2 && lastUse[w] < 0)) {
+					freeSlots[numFree++] = slot[w];
+					lastUse[w] = INT_MIN;
+				}
+			}
+		}
+	}
+
+	for (k = 0; k < m; k++)
+		outputs[k] = slot[outputs[k]];
+
+	free(freeSlots);
+	free(slot);
+	free(lastUse);
+	return numSlots;
+}
+
+
+static int countTables(GateSchedule *schedule) {
+	int l, numTables = 0;
+	for (l = 0; l < schedule->numLevels; l++)
+		numTables += schedule->levelFree[l] - schedule->levelStart[l];
+	return numTables;
+}
+
+
+int getTableRows(GarbledCircuit *garbledCircuit) {
+	return garbledCircuit->schedule != NULL ? garbledCircuit->schedule->numTables : garbledCircuit->q;
+}
+
+
+int levelizeCircuit(GarbledCircuit *garbledCircuit) {
+	int i, l, w;
+	int q = garbledCircuit->q;
+	int numWindows = (q + SCHEDULE_WINDOW_SIZE - 1) / SCHEDULE_WINDOW_SIZE;
+	GarbledGate *garbledGate;
+
+	removeSchedule(garbledCircuit);
+	//NOTE the label arena is sized for the schedule, see createLabelArena()
+	free(garbledCircuit->labels);
+	garbledCircuit->labels = NULL;
+
+	GateSchedule *schedule = (GateSchedule *) malloc(sizeof(GateSchedule));
+	int *wireLevel = (int *) malloc(sizeof(int) * garbledCircuit->r);
+	int *wireWindow = (int *) malloc(sizeof(int) * garbledCircuit->r);
+	int *gateLevel = (int *) malloc(sizeof(int) * q);
+	int *windowBase = (int *) malloc(sizeof(int) * (numWindows + 1));
+	schedule->gates = (PackedGate *) memalign(128, sizeof(PackedGate) * q);
+
+	if (schedule == NULL || wireLevel == NULL || wireWindow == NULL || gateLevel == NULL || windowBase == NULL
+			|| schedule->gates == NULL) {
+		printf("Error allocating gate schedule\n");
+		return FAILURE;
+	}
+
+	for (i = 0; i < garbledCircuit->r; i++)
+		wireWindow[i] = -1;
+
+	//NOTE levels are computed within windows of SCHEDULE_WINDOW_SIZE consecutive gates, wires from earlier windows count as level 0
+	//NOTE this keeps the wires touched by a level close together instead of sweeping the whole circuit once per level
+	for (w = 0; w < numWindows; w++)
+		windowBase[w] = 0;
+	for (i = 0; i < q; i++) {
+		w = i / SCHEDULE_WINDOW_SIZE;
+		garbledGate = &(garbledCircuit->garbledGates[i]);
+		l = wireWindow[garbledGate->input0] == w ? wireLevel[garbledGate->input0] : 0;
+		if (wireWindow[garbledGate->input1] == w && wireLevel[garbledGate->input1] > l)
+			l = wireLevel[garbledGate->input1];
+
+		if (!isFreeGate(garbledGate->type))
+			l++;
+
+		gateLevel[i] = l;
+		wireLevel[garbledGate->output] = l;
+		wireWindow[garbledGate->output] = w;
+		if (l + 1 > windowBase[w])
+			windowBase[w] = l + 1;
+	}
+
+	//turn per-window level counts into offsets of each window's first level
+	schedule->numLevels = 0;
+	for (w = 0; w < numWindows; w++) {
+		l = windowBase[w];
+		windowBase[w] = schedule->numLevels;
+		schedule->numLevels += l;
+	}
+	for (i = 0; i < q; i++)
+		gateLevel[i] += windowBase[i / SCHEDULE_WINDOW_SIZE];
+
+	//stable counting sort on (level, is free), so that each level lists its non-free gates first
+	int numBuckets = 2 * schedule->numLevels;
+	int *bucketStart = (int *) calloc(numBuckets + 1, sizeof(int));
+	for (i = 0; i < q; i++)
+		bucketStart[2 * gateLevel[i] + isFreeGate(garbledCircuit->garbledGates[i].type) + 1]++;
+	for (i = 0; i < numBuckets; i++)
+		bucketStart[i + 1] += bucketStart[i];
+
+	schedule->levelStart = (int *) malloc(sizeof(int) * (schedule->numLevels + 1));
+	schedule->levelFree = (int *) malloc(sizeof(int) * schedule->numLevels);
+	for (l = 0; l < schedule->numLevels; l++) {
+		schedule->levelStart[l] = bucketStart[2 * l];
+		schedule->levelFree[l] = bucketStart[2 * l + 1];
+	}
+	schedule->levelStart[schedule->numLevels] = q;
+	schedule->numTables = countTables(schedule);
+
+	schedule->mapped = 0;
+	schedule->numStages = 0;
+	schedule->stageStart = NULL;
+	schedule->stageFree = NULL;
+	schedule->stageGates = NULL;
+	schedule->stageTable = NULL;
+	schedule->stageOutputs = NULL;
+
+	PackedGate *packedGate;
+	for (i = 0; i < q; i++) {
+		garbledGate = &(garbledCircuit->garbledGates[i]);
+		packedGate = &(schedule->gates[bucketStart[2 * gateLevel[i] + isFreeGate(garbledGate->type)]++]);
+		packedGate->input0 = garbledGate->input0;
+		packedGate->input1 = garbledGate->input1;
+		packedGate->output = garbledGate->output;
+		packedGate->type = garbledGate->type;
+	}
+
+	free(bucketStart);
+	free(windowBase);
+	free(gateLevel);
+	free(wireWindow);
+	free(wireLevel);
+
+	garbledCircuit->schedule = schedule;
+
+	schedule->outputs = (int *) malloc(sizeof(int) * garbledCircuit->m);
+	if (schedule->outputs == NULL) {
+		printf("Error allocating gate schedule\n");
+		return FAILURE;
+	}
+	memcpy(schedule->outputs, garbledCircuit->outputs, sizeof(int) * garbledCircuit->m);
+	schedule->numSlots = renameWires(schedule->gates, q, NULL, garbledCircuit->r, garbledCircuit->n,
+			schedule->outputs, garbledCircuit->m);
+	return schedule->numSlots == FAILURE ? FAILURE : SUCCESS;
+}
+
+
+//NOTE the evaluation levels of a GateSchedule are local to windows of SCHEDULE_WINDOW_SIZE gates, which is too fine for threads
+//NOTE the garbling stages regroup the scheduled gates by their AND-depth over the whole circuit, each stage listing
+//NOTE its non-free gates (stageGates[stageStart[s]] to stageGates[stageFree[s] - 1]) before its free gates, both in schedule order
+//NOTE the gates of a schedule already share recycled label slots, so the stages rename them onto slots of their own
+int buildGarblingStages(GarbledCircuit *garbledCircuit) {
+	GateSchedule *schedule = garbledCircuit->schedule;
+	int q = garbledCircuit->q;
+	int i, l, maxStage = 0;
+	PackedGate *packedGate;
+
+	//NOTE value v < numSlots is whatever slot v holds before the first gate, value numSlots + i is the output of gates[i]
+	int numValues = schedule->numSlots + q;
+	int *slotStage = (int *) calloc(schedule->numSlots, sizeof(int));
+	int *slotValue = (int *) malloc(sizeof(int) * schedule->numSlots);
+	int *gateStage = (int *) malloc(sizeof(int) * q);
+	int *gateTable = (int *) malloc(sizeof(int) * q);
+	PackedGate *valueGates = (PackedGate *) malloc(sizeof(PackedGate) * q);
+	schedule->stageGates = (PackedGate *) memalign(128, sizeof(PackedGate) * q);
+	schedule->stageTable = (int *) malloc(sizeof(int) * q);
+	schedule->stageOutputs = (int *) malloc(sizeof(int) * garbledCircuit->m);
+	if (slotStage == NULL || slotValue == NULL || gateStage == NULL || gateTable == NULL || valueGates == NULL
+			|| schedule->stageGates == NULL || schedule->stageTable == NULL || schedule->stageOutputs == NULL) {
+		printf("Error allocating garbling stages\n");
+		return FAILURE;
+	}
+
+	for (i = 0; i < schedule->numSlots; i++)
+		slotValue[i] = i;
+
+	int tableIndex = 0;
+	for (i = 0; i < q; i++) {
+		packedGate = &(schedule->gates[i]);
+		l = slotStage[packedGate->input0];
+		if (slotStage[packedGate->input1] > l)
+			l = slotStage[packedGate->input1];
+		if (isFreeGate(packedGate->type)) {
+			gateTable[i] = -1;
+		}
+		else {
+			gateTable[i] = tableIndex++;
+			l++;
+		}
+		gateStage[i] = l;
+		if (l > maxStage)
+			maxStage = l;
+
+		valueGates[i].input0 = slotValue[packedGate->input0];
+		valueGates[i].input1 = slotValue[packedGate->input1];
+		valueGates[i].output = schedule->numSlots + i;
+		valueGates[i].type = packedGate->type;
+		slotStage[packedGate->output] = l;
+		slotValue[packedGate->output] = schedule->numSlots + i;
+	}
+	for (i = 0; i < garbledCircuit->m; i++)
+		schedule->stageOutputs[i] = slotValue[schedule->outputs[i]];
+
+	schedule->numStages = maxStage + 1;
+	int numBuckets = 2 * schedule->numStages;
+	int *bucketStart = (int *) calloc(numBuckets + 1, sizeof(int));
+	for (i = 0; i < q; i++)
+		bucketStart[2 * gateStage[i] + isFreeGate(schedule->gates[i].type) + 1]++;
+	for (i = 0; i < numBuckets; i++)
+		bucketStart[i + 1] += bucketStart[i];
+
+	schedule->stageStart = (int *) malloc(sizeof(int) * (schedule->numStages + 1));
+	schedule->stageFree = (int *) malloc(sizeof(int) * schedule->numStages);
+	for (l = 0; l < schedule->numStages; l++) {
+		schedule->stageStart[l] = bucketStart[2 * l];
+		schedule->stageFree[l] = bucketStart[2 * l + 1];
+	}
+	schedule->stageStart[schedule->numStages] = q;
+
+	for (i = 0; i < q; i++) {
+		l = bucketStart[2 * gateStage[i] + isFreeGate(schedule->gates[i].type)]++;
+		schedule->stageGates[l] = valueGates[i];
+		schedule->stageTable[l] = gateTable[i];
+	}
+
+	//the non-free gates of a stage run concurrently, its free gates one by one
+	int *stageGroup = gateStage;
+	int numGroups = 0;
+	for (l = 0; l < schedule->numStages; l++) {
+		for (i = schedule->stageStart[l]; i < schedule->stageFree[l]; i++)
+			stageGroup[i] = numGroups;
+		numGroups++;
+		for (i = schedule->stageFree[l]; i < schedule->stageStart[l + 1]; i++)
+			stageGroup[i] = numGroups++;
+	}
+	int numStageSlots = renameWires(schedule->stageGates, q, stageGroup, numValues, garbledCircuit->n,
+			schedule->stageOutputs, garbledCircuit->m);
+
+	free(bucketStart);
+	free(valueGates);
+	free(gateTable);
+	free(gateStage);
+	free(slotValue);
+	free(slotStage);
+
+	if (numStageSlots == FAILURE)
+		return FAILURE;
+	//NOTE grow the label arena if the stages need more slots than the schedule
+	if (numStageSlots > schedule->numSlots) {
+		schedule->numSlots = numStageSlots;
+		free(garbledCircuit->labels);
+		garbledCircuit->labels = NULL;
+	}
+	return SUCCESS;
+}
+
+
+void removeSchedule(GarbledCircuit *garbledCircuit) {
+	GateSchedule *schedule = garbledCircuit->schedule;
+	if (schedule == NULL)
+		return;
+
+	if (!schedule->mapped) {
+		free(schedule->gates);
+		free(schedule->levelStart);
+		free(schedule->levelFree);
+		free(schedule->outputs);
+	}
+	free(schedule->stageStart);
+	free(schedule->stageFree);
+	free(schedule->stageGates);
+	free(schedule->stageTable);
+	free(schedule->stageOutputs);
+	free(schedule);
+	garbledCircuit->schedule = NULL;
+}
+
+
+int createLabelArena(GarbledCircuit *garbledCircuit) {
+	if (garbledCircuit->labels != NULL)
+		return SUCCESS;
+
+	int numLabels = garbledCircuit->schedule != NULL ? garbledCircuit->schedule->numSlots : garbledCircuit->r;
+	garbledCircuit->labels = (block *) memalign(128, sizeof(block) * numLabels);
+	if (garbledCircuit->labels == NULL) {
+		printf("Error allocating label arena\n");
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+
+
+int createGarbledTable(GarbledCircuit *garbledCircuit) {
+	garbledCircuit->garbledTable = (GarbledTable *) memalign(128,
+			sizeof(GarbledTable) * getTableRows(garbledCircuit));
+	if (garbledCircuit->garbledTable == NULL) {
+		printf("Error allocating garbled table\n");
+		return FAILURE;
+	}
+	return SUCCESS;
+}
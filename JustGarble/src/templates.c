@@ -0,0 +1,160 @@
+/*
+	Privacy Preserving Biometric Authentication for Fingerprints and Beyond
+	Copyright (C) 2024  Marina Blanton and Dennis Murphy,
+	University at Buffalo, State University of New York.
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "../include/justGarble.h"
+#include "../include/garble.h"
+#include "../include/gates.h"
+#include "../include/util.h"
+#include <malloc.h>
+
+
+//NOTE a template is the optimized form of a sub-circuit built on its own: wires 0 to numInputs - 1 are its inputs
+//NOTE and the output of gates[i] is wire numInputs + 1 + i, so every other wire is an offset away from a fresh one
+typedef struct CircuitTemplate {
+	TemplateBuilder build;
+	int numParams;
+	int params[MAX_TEMPLATE_PARAMS];
+	int numInputs;
+	int numOutputs;
+	int numGates;
+	PackedGate *gates;
+	int *outputs;
+	struct CircuitTemplate *next;
+} CircuitTemplate;
+
+//NOTE circuits are built by one thread at a time, so the cache is not locked
+static CircuitTemplate *templateCache = NULL;
+
+
+static CircuitTemplate *findTemplate(TemplateBuilder build, int numParams, int *params, int numInputs, int numOutputs) {
+	CircuitTemplate *t;
+	for (t = templateCache; t != NULL; t = t->next) {
+		if (t->build == build && t->numParams == numParams && t->numInputs == numInputs && t->numOutputs == numOutputs
+				&& (numParams == 0 || memcmp(t->params, params, sizeof(int) * numParams) == 0))
+			return t;
+	}
+	return NULL;
+}
+
+static CircuitTemplate *buildTemplate(TemplateBuilder build, int numParams, int *params, int numInputs, int numOutputs) {
+	GarbledCircuit garbledCircuit;
+	GarblingContext garblingContext;
+	int inputs[numInputs];
+	int outputs[numOutputs];
+	int i;
+
+	createEmptyGarbledCircuit(&garbledCircuit, numInputs, numOutputs, 0, 0, NULL);
+	startBuilding(&garbledCircuit, &garblingContext);
+	countToN(inputs, numInputs);
+	build(&garbledCircuit, &garblingContext, params, inputs, outputs);
+	finishBuilding(&garbledCircuit, &garblingContext, NULL, outputs);
+
+	CircuitTemplate *t = NULL;
+	if (optimizeCircuit(&garbledCircuit, &garblingContext) == SUCCESS) {
+		t = (CircuitTemplate *) malloc(sizeof(CircuitTemplate));
+		t->build = build;
+		t->numParams = numParams;
+		if (numParams > 0)
+			memcpy(t->params, params, sizeof(int) * numParams);
+		t->numInputs = numInputs;
+		t->numOutputs = numOutputs;
+		t->numGates = garbledCircuit.q;
+		t->gates = (PackedGate *) malloc(sizeof(PackedGate) * (garbledCircuit.q > 0 ? garbledCircuit.q : 1));
+		t->outputs = (int *) malloc(sizeof(int) * numOutputs);
+		for (i = 0; i < garbledCircuit.q; i++) {
+			t->gates[i].input0 = garbledCircuit.garbledGates[i].input0;
+			t->gates[i].input1 = garbledCircuit.garbledGates[i].input1;
+			t->gates[i].output = garbledCircuit.garbledGates[i].output;
+			t->gates[i].type = garbledCircuit.garbledGates[i].type;
+		}
+		memcpy(t->outputs, garbledCircuit.outputs, sizeof(int) * numOutputs);
+		t->next = templateCache;
+		templateCache = t;
+	}
+
+	free(garblingContext.fixedWires);
+	free(garbledCircuit.outputs);
+	removeGarbledCircuit(&garbledCircuit);
+	return t;
+}
+
+
+int instantiateTemplate(GarbledCircuit *garbledCircuit, GarblingContext *garblingContext, TemplateBuilder build,
+		int numParams, int *params, int numInputs, int numOutputs, int *inputs, int *outputs) {
+	if (numParams > MAX_TEMPLATE_PARAMS || numInputs < 1) {
+		return build(garbledCircuit, garblingContext, params, inputs, outputs);
+	}
+
+	CircuitTemplate *t = findTemplate(build, numParams, params, numInputs, numOutputs);
+	if (t == NULL)
+		t = buildTemplate(build, numParams, params, numInputs, numOutputs);
+	//NOTE a sub-circuit the optimizer cannot handle is built in place as usual
+	if (t == NULL) {
+		return build(garbledCircuit, garblingContext, params, inputs, outputs);
+	}
+
+	//NOTE gate outputs get consecutive fresh wires, so template wire w >= numInputs + 1 becomes w + offset
+	int offset = garblingContext->wireIndex - (numInputs + 1);
+	int i, input0, input1, output;
+	PackedGate *gate;
+
+	if (t->numGates > 0)
+		reserveWire(garbledCircuit, garblingContext, garblingContext->wireIndex + t->numGates - 1);
+	for (i = 0; i < t->numGates; i++) {
+		gate = &(t->gates[i]);
+		input0 = gate->input0 < numInputs ? inputs[gate->input0] : gate->input0 + offset;
+		input1 = gate->input1 < numInputs ? inputs[gate->input1] : gate->input1 + offset;
+		output = getNextWire(garblingContext);
+		//NOTE gates are counted by type as in MIXED_OP_Gate() and NOT_Gate2(), so qand and qor cover copied gates too
+		if (gate->type == XORGATE) {
+			garbledCircuit->qxor++;
+			XORGate(garbledCircuit, garblingContext, input0, input1, output);
+		}
+		else if (gate->type == NOTGATE) {
+			garbledCircuit->qnot++;
+			NOTGate(garbledCircuit, garblingContext, input1, output);
+		}
+		else if (gate->type == ANDGATE) {
+			garbledCircuit->qand++;
+			ANDGate(garbledCircuit, garblingContext, input0, input1, output);
+		}
+		else if (gate->type == ORGATE) {
+			garbledCircuit->qor++;
+			ORGate(garbledCircuit, garblingContext, input0, input1, output);
+		}
+		else
+			genericGate(garbledCircuit, garblingContext, input0, input1, output, NULL, gate->type);
+	}
+	for (i = 0; i < numOutputs; i++)
+		outputs[i] = t->outputs[i] < numInputs ? inputs[t->outputs[i]] : t->outputs[i] + offset;
+
+	return 0;
+}
+
+void clearTemplateCache() {
+	CircuitTemplate *t;
+	while (templateCache != NULL) {
+		t = templateCache;
+		templateCache = t->next;
+		free(t->gates);
+		free(t->outputs);
+		free(t);
+	}
+}
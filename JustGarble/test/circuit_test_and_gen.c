@@ -35,28 +35,37 @@
 #define CIRCUIT_FILE 3
 #define FILE_ALG (Num_Algs - 2)
 #define ALL_ALGS (Num_Algs - 1)
+#define PRECOMPUTED_CHECK_TRIALS 100
+#define FLOAT_CHECK_TRIALS 100
 
 
 const char *alg_str[] = {"cust", "hd", "cs", "ed", "file", "all"};
 
-const char *opt_str[] = {"new", "mal", "sha3-256"};
+const char *opt_str[] = {"new", "prof", "mal", "sha3-256", "fxp", "pre"};
 
 const char *alg_descr[] = {"Custom Alg", "Hamming Distance", "Cosine Similarity", "Euclidean Distance", "Alg loaded from file", "All Algs"};
 
 const char *opt_descr[] = {
 	"if you wish to force a new circuit build rather than automatically read from file.",
+	"if you wish to profile gate counts and AND-depth by builder routine (implies new); the tree is printed and folded stacks for flamegraph.pl are written to <circuit file>.folded",
 	//NOTE biometric_auth-specific options beging here; if altered, first_bio_specific_opt_idx should be updated just below
 	"if you wish to include commitment checking and output the result as a second bit.",
 	"if you wish to use SHA3-256 as the commitment function (default is SHA2-256)",
+	"if you wish cs and ed to use fixed point rather than float arithmetic; fxp<L>.<F> reads range and min as L-bit ints, min with F fraction bits and range with F + input length (default is fxp26.24)",
+	"if you wish cs and ed to read the terms that depend on the enrollment input alone as extra inputs computed at enrollment, see precompute_enrollment_inputs(); with fxp, the outputs are checked against the circuit without pre, and float circuits against the exact distance either way",
 };
-int first_bio_specific_opt_idx = 1;
+int first_bio_specific_opt_idx = 2;
 
 
 void (*build_func[])(int, int, char*, int) = {NULL, *build_hamming, *build_cosine, *build_euclidean};
 
+//distance function of cs and ed, whose circuits are value checked and may precompute enrollment-only terms, -1 for the others
+int alg_dist_func[] = {-1, -1, CS_DIST, ED_DIST};
+
 
 int Int_Representation_ = UNSIGNED;
 int Running_Consistency_Checks_ = 0;
+int Profile_Circuits_ = 0;
 
 int Num_Algs = sizeof(alg_str) / sizeof(char*);
 int Num_Opts = sizeof(opt_str) / sizeof(char*);
@@ -89,9 +98,18 @@ int arg_check(int argc, char **argv, int *task, int *chosen_alg, int *num_inputs
 		*new_build = 0;
 		for (int i = 4; i < argc; i++) {
 			*new_build |= (strcmp(argv[i], "new") == 0) ? 1 : 0;
+			Profile_Circuits_ |= (strcmp(argv[i], "prof") == 0) ? 1 : 0;
+			*new_build |= Profile_Circuits_;
 			Malicious_Security_ |= (strcmp(argv[i], "mal") == 0) ? 1 : 0;
 			if (strcmp(argv[i], "sha3-256") == 0)
 				Commit_Func_ = SHA3_256;
+			Precomputed_Enrollment_ |= (strcmp(argv[i], "pre") == 0) ? 1 : 0;
+			if (strncmp(argv[i], "fxp", 3) == 0) {
+				Fixed_Point_ = 1;
+				if ((argv[i][3] != '\0') && ((sscanf(&argv[i][3], "%u.%u", &Fixed_Point_Length_, &Fixed_Point_Frac_Bits_) != 2)
+						|| (Fixed_Point_Length_ > 32) || (Fixed_Point_Frac_Bits_ >= Fixed_Point_Length_)))
+					return -1;
+			}
 		}
 	}
 
@@ -206,6 +224,29 @@ int main(int argc, char **argv) {
 					build_func[this_alg](num_inputs, input_length, circuit_file, BUILD_CIRCUIT);
 					new_build = 1;
 				}
+
+				//NOTE a fixed point pre_ circuit is checked against the circuit it replaces, built if not on file
+				if (Precomputed_Enrollment_ && Fixed_Point_ && (alg_dist_func[this_alg] >= 0)) {
+					char full_circuit_file[FNAME_LEN_];
+					Precomputed_Enrollment_ = 0;
+					build_func[this_alg](num_inputs, input_length, full_circuit_file, RETURN_FILE_NAME);
+					if (access(full_circuit_file, F_OK) == FAILURE)
+						build_func[this_alg](num_inputs, input_length, full_circuit_file, BUILD_CIRCUIT);
+					Precomputed_Enrollment_ = 1;
+					if (precomputed_enrollment_check(alg_dist_func[this_alg], num_inputs, input_length,
+							circuit_file, full_circuit_file, PRECOMPUTED_CHECK_TRIALS) != 0) {
+						printf("The pre_ circuit does not match the circuit it replaces.\n");
+						return -1;
+					}
+				}
+
+				//NOTE float cs and ed circuits are checked against the exact distance and norm of their inputs
+				if (!Fixed_Point_ && (alg_dist_func[this_alg] >= 0)) {
+					if (float_value_check(alg_dist_func[this_alg], num_inputs, input_length, circuit_file, FLOAT_CHECK_TRIALS) != 0) {
+						printf("The float circuit does not compute the expected outputs.\n");
+						return -1;
+					}
+				}
 			}
 
 			GarbledCircuit garbledCircuit;
@@ -0,0 +1,52 @@
+/*
+	Privacy Preserving Biometric Authentication for Fingerprints and Beyond
+	Copyright (C) 2024  Marina Blanton and Dennis Murphy,
+	University at Buffalo, State University of New York.
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+#include "../include/justGarble.h"
+
+
+//NOTE converts an SCD file (v1 msgpack or v2) into an SCD v2 file; the output must not be the input file, which stays mapped
+int main(int argc, char **argv) {
+
+	if (argc < 3 || (argc > 3 && strcmp(argv[3], "varint") != 0)) {
+		printf("Usage: %s <input scd file> <output scd file> [varint]\n", argv[0]);
+		printf("Writes a packed SCD v2 file that is mapped on load, or a smaller varint-encoded one.\n");
+		return 1;
+	}
+
+	GarbledCircuit garbledCircuit;
+	if (readCircuitFromFile(&garbledCircuit, argv[1]) == FAILURE) {
+		printf("Could not read %s\n", argv[1]);
+		return 1;
+	}
+
+	int encoding = argc > 3 ? SCD2_VARINT : SCD2_PACKED;
+	if (writeCircuitToFileSCD2(&garbledCircuit, argv[2], encoding) == FAILURE) {
+		printf("Could not write %s\n", argv[2]);
+		removeGarbledCircuit(&garbledCircuit);
+		return 1;
+	}
+
+	printf("%s: n = %d, m = %d, q = %d -> %s (%s)\n", argv[1], garbledCircuit.n, garbledCircuit.m,
+			garbledCircuit.q, argv[2], encoding == SCD2_VARINT ? "varint" : "packed");
+	removeGarbledCircuit(&garbledCircuit);
+	return 0;
+}
@@ -49,6 +49,15 @@ PeerNet::PeerNet(int num_peers_in, int my_id_in, std::string& rsa_prv_keyfile_in
 }
 
 
+PeerNet::PeerNet(int num_peers_in, int my_id_in, std::string& rsa_prv_keyfile_in, std::string& config_file_in, int base_port_in, int bcr_limit_in, int bcr_delay_in, int port_offset_in)
+
+: num_peers(num_peers_in), my_id(my_id_in), rsa_prv_keyfile(rsa_prv_keyfile_in), config_file(config_file_in), base_port(base_port_in), base_conn_retry_limit(bcr_limit_in), base_conn_retry_delay(bcr_delay_in), port_offset(port_offset_in)
+
+{
+	initialize_peernet();
+}
+
+
 
 
 PeerNet::~PeerNet()
@@ -152,6 +161,7 @@ int PeerNet::load_config()
 				peers_[peer_id].port = std::stoi(substrings[2]);
 				if ((peers_[peer_id].port < 1024) || (peers_[peer_id].port > 65535))
 					peers_[peer_id].port = base_port + peer_id;
+				peers_[peer_id].port += port_offset;
 				if (peer_id == my_id)
 					peers_[peer_id].rsa_key_fname = rsa_prv_keyfile;
 				else
@@ -175,6 +185,7 @@ int PeerNet::load_config()
 void PeerNet::initialize_peernet()
 {
 	timer = new Timer();
+	FD_ZERO(&peerfds_);
 	reset_timeout(&conn_retry_timeout, &ref_timeslice, (double) 2304);
 	reset_timeout(&flush_read_timeout, &ref_timeslice, (double) 96);
 
@@ -574,6 +585,44 @@ int PeerNet::multicast_ack(int *participant_roster, int num_rounds)
 
 
 
+// for long-lived peers: only the link to peer_id (which may be a new process) is set up again, key exchange included,
+// the other links are kept; the group is then synchronized as after initialization
+int PeerNet::reconnect_peer(int peer_id)
+{
+	if (peer_id == my_id)
+		return 0;
+
+	FD_CLR(peers_[peer_id].sock_fd, &peerfds_);
+	close(peers_[peer_id].sock_fd);
+	RSA_free(peers_[peer_id].rsa_pub_key);
+	EVP_CIPHER_CTX_free(peers_[peer_id].aes_enc_ctx);
+	EVP_CIPHER_CTX_free(peers_[peer_id].aes_dec_ctx);
+	peers_[peer_id].rsa_pub_key = NULL;
+	peers_[peer_id].aes_enc_ctx = NULL;
+	peers_[peer_id].aes_dec_ctx = NULL;
+
+	num_conn_tries = 0;
+	retries_remain = true;
+	int connected = 0;
+	while (retries_remain & !connected)
+	{
+		if (my_id < peer_id)
+			connected = serve(peer_id, peers_[peer_id].port);
+		else
+			connected = request(peer_id);
+	}
+
+	is_connected_ = connected;
+	if (is_connected_)
+		multicast_ack(PASS_RIGHT_, 1);
+	else
+		fprintf(stderr, "Could not reconnect to peer %i\n", peer_id);
+
+	return is_connected_;
+}
+
+
+
 int PeerNet::flush_read_buffer(int peer_id)
 {
 	int buf_cleared = 0;
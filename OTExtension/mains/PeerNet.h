@@ -90,6 +90,8 @@ public:
 	PeerNet(int num_peers_in, int my_id_in, std::string& rsa_prv_keyfile_in, std::string& config_file_in);
 	PeerNet(int num_peers_in, int my_id_in, std::string& rsa_prv_keyfile_in, std::string& config_file_in, int base_port_in);
 	PeerNet(int num_peers_in, int my_id_in, std::string& rsa_prv_keyfile_in, std::string& config_file_in, int bcr_limit_in, int bcr_delay_in);
+	//NOTE 0 leaves base_port and the retry parameters at their defaults; port_offset is added to every configured port
+	PeerNet(int num_peers_in, int my_id_in, std::string& rsa_prv_keyfile_in, std::string& config_file_in, int base_port_in, int bcr_limit_in, int bcr_delay_in, int port_offset_in);
 
 	~PeerNet();
 
@@ -127,6 +129,8 @@ public:
 
 	int multicast_ack(int *participant_roster, int num_rounds);
 
+	int reconnect_peer(int peer_id);
+
 	int flush_read_buffer(int peer_id);
 	int register_my_socket(int sock_fd);
 	int unregister_my_socket();
@@ -223,6 +227,7 @@ private:
 	std::string rsa_prv_keyfile;
 
 	int base_port = PN_DEFAULT_BASE_PORT;
+	int port_offset = 0;
 	int using_unique_ports = false;
 
 };
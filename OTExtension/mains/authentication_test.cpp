@@ -28,6 +28,11 @@
 #include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
 
 #include <gmp.h>
 
@@ -72,18 +77,20 @@ uint32_t ot_stat_param = 40;
 
 int my_id = S1_ID;
 field_type ftype = ECC_FIELD;;
-MaskingFunction* mask_func;
+
+//NOTE thread_local: every session worker has its own OT extension, peer links and timer; see serve_sessions in main()
+thread_local MaskingFunction* mask_func;
 
 // Naor-Pinkas OT
 //BaseOT* bot;
-OTExtSnd *sender;
-OTExtRec *receiver;
+thread_local OTExtSnd *sender;
+thread_local OTExtRec *receiver;
 
-SndThread* sndthread;
-RcvThread* rcvthread;
+SndThread* sndthread = NULL;	//shared by all session workers, each on its own channels
+RcvThread* rcvthread = NULL;
 
-PeerNet *peer_net;
-Timer *timer;
+thread_local PeerNet *peer_net;
+thread_local Timer *timer;
 
 int tcount = 0;
 
@@ -125,6 +132,13 @@ uint32_t num_dfs = sizeof(df_str) / sizeof(std::string);
 std::string chosen_df_str = "cs";
 uint32_t chosen_df = 1;
 
+//"float", or "fxp" / "fxp<L>.<F>" for the JG fixed point cs and ed circuits (see circuit_test_and_gen fxp option)
+std::string chosen_ar_str = "float";
+
+//cs and ed circuits built with the JG pre option read enrollment-only terms right after the enrollment input
+int precomputed_enrollment = 0;
+int num_precomputed_bits = 0;
+
 std::string vf_str[] = {"sha2-256", "sha3-256"};
 uint32_t num_vfs = sizeof(vf_str) / sizeof(std::string);
 std::string chosen_vf_str = "sha2-256";
@@ -143,6 +157,30 @@ int input_length = 8;	//bio-vector component length; same meaning as in JustGarb
 int computing_offline = 1;
 int computing_online = 1;
 
+int garbling_threads = 1;	//S1 only; see setGarblingThreads() in JG
+int pregarbled_instances = 0;	//S1 only; 0 garbles within the session, see createGarblingPool() in JG
+int pregarbling_workers = 1;	//S1 only
+
+int serving_sessions = 1;	//S1 and S2 only; 0 keeps serving sessions until stopped
+
+int random_OT_sessions = 0;	//S1 and S2 only, must match; 0 runs the OTs in session, see fill_random_ot_pool()
+
+std::string OT_state_file = "";	//S1 and S2 only; empty runs the base OTs at every start, see ComputeOrResumeBaseOTs()
+
+int session_workers = 1;	//S1 and S2 only, must match; worker w serves the clients of session slot w
+int session_slot = 0;	//C only
+std::mutex results_mtx;	//session workers share the results files
+
+//NOTE session slot w is reached on the configured PeerNet ports plus w * SESSION_SLOT_PORT_STRIDE
+#define SESSION_SLOT_PORT_STRIDE 16
+//NOTE OT channels of one session worker, see nchans in the OT extension routines
+#define OT_CHANNELS_PER_WORKER (3 * num_OT_threads)
+//NOTE worker w runs its base OTs and OT verification on this channel, counting down from the OT admin channel
+#define OT_WORKER_ADMIN_CHANNEL(w) (OT_ADMIN_CHANNEL - (w))
+
+//NOTE the garbled table is streamed from S1 to S2 in chunks of this many table rows
+#define GC_STREAM_CHUNK_ROWS 4096
+
 int verbose = 1;
 double elapsed;
 std::vector<double> test_results;
@@ -220,17 +258,156 @@ void print_block(block *b, int bracketing)
 
 
 
+/**
+ * garbled table rows released by the garbler (S1) and not yet sent to S2
+ */
+
+struct table_stream
+{
+	std::mutex mtx;
+	std::condition_variable rows_ready;
+	long num_rows = 0;
+	bool done = false;
+};
+
+void table_stream_sink(void *stream_ctx, long num_rows)
+{
+	table_stream *stream = (table_stream*) stream_ctx;
+	std::lock_guard<std::mutex> lock(stream->mtx);
+	stream->num_rows = num_rows;
+	stream->rows_ready.notify_one();
+}
+
+/**
+ * sends the first table_bytes bytes of the garbled table to S2 over net as the garbler releases them; returns the number of bytes sent
+ * runs on its own thread, so the worker's peer links are passed in rather than read from the thread_local peer_net
+ */
+
+long send_table_stream(PeerNet *net, table_stream *stream, GarbledTable *garbled_table, long table_bytes)
+{
+	long sent_bytes = 0;
+	while (sent_bytes < table_bytes)
+	{
+		long ready_bytes;
+		{
+			std::unique_lock<std::mutex> lock(stream->mtx);
+			stream->rows_ready.wait(lock, [&] { return stream->done || stream->num_rows * (long) sizeof(GarbledTable) > sent_bytes; });
+			//NOTE once garbling is done, the rest of the table (rows not used by the circuit, if any) goes out too
+			ready_bytes = stream->done ? table_bytes : std::min(stream->num_rows * (long) sizeof(GarbledTable), table_bytes);
+		}
+		int chunk_bytes = ready_bytes - sent_bytes;
+		if (net->send_to_peer(S2_ID, (unsigned char*) garbled_table + sent_bytes, chunk_bytes, PLAINTEXT, NULL) != chunk_bytes)
+			break;
+		sent_bytes = ready_bytes;
+	}
+	return sent_bytes;
+}
+
+
+
+//NOTE the width of the precomputed enrollment terms depends on the circuit arithmetic, so it is read off the circuit;
+//NOTE they are shared like the enrollment input, whose OT bits they extend
+
+void read_precomputed_bits(GarbledCircuit *garbledCircuit, int *num_OT_bits, int *gc_input_size)
+{
+	if (precomputed_enrollment && (chosen_df != HD))
+		num_precomputed_bits = garbledCircuit->n - *gc_input_size;
+	*num_OT_bits += num_precomputed_bits;
+	*gc_input_size += num_precomputed_bits;
+}
+
+
+
+/**
+ * the OT extension of each session worker is kept in a file of its own
+ */
+
+std::string OT_state_filename(int worker)
+{
+	return (worker == 0) ? OT_state_file : OT_state_file + "." + std::to_string(worker);
+}
+
+
+
+/**
+ * runs the base OTs once per S1-S2 pairing rather than once per start: when both S1 and S2 hold an OT state file
+ * for the same pairing and counter, they resume the OT extension from it, otherwise both run the base OTs and
+ * start a new pairing, with an id from S1
+ */
+
+void ComputeOrResumeBaseOTs(OTExt *ot_ext, int worker)
+{
+	std::string state_file = OT_state_filename(worker);
+	//NOTE exchanged as: has state, pairing id, counter
+	unsigned char state_buf[1 + OT_STATE_ID_BYTES + sizeof(uint64_t)];
+	unsigned char peer_state_buf[sizeof(state_buf)];
+	uint64_t counter = 0;
+	int peer_id = (my_id == S1_ID) ? S2_ID : S1_ID;
+
+	memset(state_buf, 0, sizeof(state_buf));
+	if (OT_state_file != "")
+		state_buf[0] = ot_ext->ReadState(state_file.c_str(), &state_buf[1], &counter);
+	memcpy(&state_buf[1 + OT_STATE_ID_BYTES], &counter, sizeof(uint64_t));
+
+	peer_net->send_to_peer(peer_id, state_buf, sizeof(state_buf), ENCRYPTED, NULL);
+	peer_net->receive_from_peer(peer_id, peer_state_buf, sizeof(peer_state_buf), ENCRYPTED, NULL);
+
+	//NOTE both sides reach the same decision from the same two messages
+	bool resuming = state_buf[0] && peer_state_buf[0] && (memcmp(state_buf, peer_state_buf, sizeof(state_buf)) == 0);
+	if (resuming && !ot_ext->LoadState(state_file.c_str()))
+	{
+		std::cerr << "Error loading OT state file " << state_file << "\n";
+		std::exit(1);
+	}
+
+	if (!resuming)
+	{
+		ot_ext->ComputeBaseOTs(ftype);
+
+		if (OT_state_file != "")
+		{
+			unsigned char state_id[OT_STATE_ID_BYTES];
+			if (my_id == S1_ID)
+			{
+				uc_prng(state_id, 8 * OT_STATE_ID_BYTES);
+				peer_net->send_to_peer(S2_ID, state_id, OT_STATE_ID_BYTES, ENCRYPTED, NULL);
+			}
+			else
+			{
+				peer_net->receive_from_peer(S1_ID, state_id, OT_STATE_ID_BYTES, ENCRYPTED, NULL);
+			}
+			ot_ext->SetStateId(state_id);
+		}
+	}
+	else if (verbose)
+	{
+		printf("Resumed OT extension state from %s\n", state_file.c_str());
+	}
+
+	//NOTE a resumed state is saved right away, so a crash before the next save still cannot rewind its counter
+	if ((OT_state_file != "") && !ot_ext->SaveState(state_file.c_str()))
+	{
+		printf("Error saving OT state file %s\n", state_file.c_str());
+	}
+}
+
+
+
 /**
  * the following two functions set up OT sender and reciver, respectively
  */
 
-void InitOTSender(crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& lsock, bool verifying_ot)
+void InitOTSender(crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& lsock, bool verifying_ot, int worker)
 {
-	sndthread = new SndThread(lsock.get(), glock);
-	rcvthread = new RcvThread(lsock.get(), glock);
+	//NOTE the socket threads are started once and shared by the OT extensions of all session workers
+	if (sndthread == NULL)
+	{
+		sndthread = new SndThread(lsock.get(), glock);
+		rcvthread = new RcvThread(lsock.get(), glock);
 
-	rcvthread->Start();
-	sndthread->Start();
+		rcvthread->Start();
+		sndthread->Start();
+	}
 
 	switch(prot)
 	{
@@ -241,21 +418,27 @@ void InitOTSender(crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& lsock,
 		default: sender = new ALSZOTExtSnd(crypt, rcvthread, sndthread, num_baseOTs, num_checks); break;
 	}
 
+	sender->SetChannelBase(worker * OT_CHANNELS_PER_WORKER);
+	sender->SetAdminChannel(OT_WORKER_ADMIN_CHANNEL(worker));
 	if(use_min_ent_cor_rob)
 		sender->EnableMinEntCorrRobustness();
-	sender->ComputeBaseOTs(ftype);
+	ComputeOrResumeBaseOTs(sender, worker);
 }
 
 
 
 
-void InitOTReceiver(crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& csock, bool verifying_ot)
+void InitOTReceiver(crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& csock, bool verifying_ot, int worker)
 {
-	sndthread = new SndThread(csock.get(), glock);
-	rcvthread = new RcvThread(csock.get(), glock);
+	//NOTE the socket threads are started once and shared by the OT extensions of all session workers
+	if (sndthread == NULL)
+	{
+		sndthread = new SndThread(csock.get(), glock);
+		rcvthread = new RcvThread(csock.get(), glock);
 
-	rcvthread->Start();
-	sndthread->Start();
+		rcvthread->Start();
+		sndthread->Start();
+	}
 
 
 	switch(prot)
@@ -267,10 +450,12 @@ void InitOTReceiver(crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& csock
 		default: receiver = new ALSZOTExtRec(crypt, rcvthread, sndthread, num_baseOTs, num_checks); break;
 	}
 
+	receiver->SetChannelBase(worker * OT_CHANNELS_PER_WORKER);
+	receiver->SetAdminChannel(OT_WORKER_ADMIN_CHANNEL(worker));
 	if(use_min_ent_cor_rob)
 		receiver->EnableMinEntCorrRobustness();
 
-	receiver->ComputeBaseOTs(ftype);
+	ComputeOrResumeBaseOTs(receiver, worker);
 }
 
 
@@ -321,6 +506,238 @@ int OTRecv(CBitVector* OT_recv_buf, CBitVector* OT_bits, uint32_t num_inputs, ui
 
 
 
+/**
+ * random OTs extended ahead of the sessions that use them: S1 keeps both pads of each, S2 its random choice and the pad it chose
+ */
+
+struct random_ot_pool
+{
+	CBitVector pads[2];	//S2 uses pads[0] only
+	CBitVector choices;	//S2 only
+	uint32_t num_OTs = 0;
+	uint32_t next_OT = 0;
+};
+
+/**
+ * the following two functions extend random OTs, in which the OT extension itself picks the sender's pads
+ */
+
+int RandomOTSend(OTExtSnd *ot_sender, CBitVector** OT_pads, uint32_t num_OTs, uint32_t bitlength, crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& lsock)
+{
+	mask_func = new XORMasking(ot_sec_param);
+
+	bool success = FALSE;
+	lsock->ResetSndCnt();
+	lsock->ResetRcvCnt();
+
+	success = ot_sender->send(num_OTs, bitlength, 2, OT_pads, Snd_R_OT, Rec_OT, num_OT_threads, mask_func);
+
+	delete mask_func;
+
+	return success;
+}
+
+
+
+int RandomOTRecv(OTExtRec *ot_receiver, CBitVector* OT_pads, CBitVector* OT_choices, uint32_t num_OTs, uint32_t bitlength, crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& csock)
+{
+	mask_func = new XORMasking(ot_sec_param);
+
+	bool success = FALSE;
+	csock->ResetSndCnt();
+	csock->ResetRcvCnt();
+
+	success = ot_receiver->receive(num_OTs, bitlength, 2, OT_choices, OT_pads, Snd_R_OT, Rec_OT, num_OT_threads, mask_func);
+
+	delete mask_func;
+
+	return success;
+}
+
+
+
+/**
+ * extends num_OTs random OTs of one label each into pool, on the OT extension of ot_ext
+ */
+
+int extend_random_OTs(random_ot_pool *pool, uint32_t num_OTs, OTExt *ot_ext, crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& sock)
+{
+	pool->num_OTs = num_OTs;
+	pool->next_OT = 0;
+
+	bool success = FALSE;
+	if (my_id == S1_ID)
+	{
+		CBitVector *OT_pads[2] = {&pool->pads[0], &pool->pads[1]};
+		pool->pads[0].Create(pool->num_OTs, 8 * sizeof(block));
+		pool->pads[1].Create(pool->num_OTs, 8 * sizeof(block));
+		success = RandomOTSend((OTExtSnd*) ot_ext, OT_pads, pool->num_OTs, 8 * sizeof(block), crypt, glock, sock);
+	}
+	else
+	{
+		//NOTE the choices must be secret, so they are drawn from /dev/urandom rather than crypt, which is seeded from
+		//NOTE the public local_const_seed and so would let S1 predict them
+		pool->choices.Create(pool->num_OTs);
+		uc_prng(pool->choices.GetArr(), pool->num_OTs);
+		pool->pads[0].Create(pool->num_OTs, 8 * sizeof(block));
+		success = RandomOTRecv((OTExtRec*) ot_ext, &pool->pads[0], &pool->choices, pool->num_OTs, 8 * sizeof(block), crypt, glock, sock);
+	}
+	if (!success)
+		pool->num_OTs = 0;
+
+	return success;
+}
+
+
+
+/**
+ * random OTs are extended in batches of session_workers shares of random_OT_sessions sessions each, so that the fixed
+ * cost of an extension (consistency checks, hashing setup) is paid once per batch; S1 hands the shares out in order, to
+ * whichever worker runs short, and names each share to S2 over the link of that worker; S1 and S2 both extend the
+ * batches in order, on the OT extension of worker 0, S1 once it hands out the first share of a batch and S2 once one
+ * is named to it, so a worker that gets no clients takes no shares and holds back no batch
+ */
+
+struct random_ot_batcher
+{
+	std::mutex mtx;
+	OTExt *ot_ext = NULL;
+	std::deque<random_ot_pool*> batches;	//those with a share yet to be taken
+	std::deque<uint32_t> shares_taken;	//of each of batches
+	uint64_t first_batch = 0;	//number of batches.front()
+	uint64_t next_share = 0;	//S1 only, counted over all batches
+};
+
+random_ot_batcher ot_batcher;	//S1 and S2 only
+
+
+
+/**
+ * leaves at least num_OTs unused random OTs of one label each in the pool of session worker worker; when fewer remain,
+ * they are dropped and replaced by the next share S1 hands out, so S1 and S2 must call this at the same points;
+ * S1 keeps only the batch it hands out shares of, and S2 also those with a share named to a worker that has yet to
+ * take it, so neither holds more batches than one plus the number of session workers
+ */
+
+int fill_random_ot_pool(random_ot_pool *pool, uint32_t num_OTs, int worker, crypto* crypt, CLock *glock, std::unique_ptr<CSocket>& sock)
+{
+	if (pool->next_OT + num_OTs <= pool->num_OTs)
+		return TRUE;
+
+	//NOTE shares are whole bytes of S2's choice bits
+	uint32_t share_OTs = ceil_divide(random_OT_sessions * num_OTs, 8) * 8;
+	pool->num_OTs = 0;
+	pool->next_OT = 0;
+
+	//NOTE S1 names the share (batch, share in batch) before extending, since S2 only extends a batch once named one of it
+	uint64_t share_name[2];
+	std::unique_lock<std::mutex> lock(ot_batcher.mtx, std::defer_lock);
+	if (my_id == S1_ID)
+	{
+		lock.lock();
+		share_name[0] = ot_batcher.next_share / session_workers;
+		share_name[1] = ot_batcher.next_share % session_workers;
+		ot_batcher.next_share++;
+		if (peer_net->send_to_peer(S2_ID, (unsigned char*) share_name, sizeof(share_name), ENCRYPTED, NULL) != sizeof(share_name))
+			return FALSE;
+	}
+	else
+	{
+		if (peer_net->receive_from_peer(S1_ID, (unsigned char*) share_name, sizeof(share_name), ENCRYPTED, NULL) != sizeof(share_name))
+			return FALSE;
+		lock.lock();
+	}
+
+	uint64_t b = share_name[0];
+	while (b >= ot_batcher.first_batch + ot_batcher.batches.size())
+	{
+		random_ot_pool *batch = new random_ot_pool;
+		extend_random_OTs(batch, session_workers * share_OTs, ot_batcher.ot_ext, crypt, glock, sock);
+		ot_batcher.batches.push_back(batch);
+		ot_batcher.shares_taken.push_back(0);
+
+		if ((OT_state_file != "") && !ot_batcher.ot_ext->SaveState(OT_state_filename(0).c_str()))
+			printf("Error saving OT state file %s\n", OT_state_filename(0).c_str());
+	}
+	random_ot_pool *batch = ot_batcher.batches[b - ot_batcher.first_batch];
+	ot_batcher.shares_taken[b - ot_batcher.first_batch]++;
+
+	//NOTE a failed extension leaves every share of the batch empty
+	bool success = batch->num_OTs > 0;
+	if (success)
+	{
+		pool->num_OTs = share_OTs;
+		uint64_t first_OT = share_name[1] * share_OTs;
+		pool->pads[0].Copy(batch->pads[0].GetArr() + first_OT * sizeof(block), 0, share_OTs * sizeof(block));
+		if (my_id == S1_ID)
+			pool->pads[1].Copy(batch->pads[1].GetArr() + first_OT * sizeof(block), 0, share_OTs * sizeof(block));
+		else
+			pool->choices.Copy(batch->choices.GetArr() + first_OT / 8, 0, share_OTs / 8);
+	}
+
+	while (!ot_batcher.batches.empty() && (ot_batcher.shares_taken.front() == session_workers))
+	{
+		delete ot_batcher.batches.front();
+		ot_batcher.batches.pop_front();
+		ot_batcher.shares_taken.pop_front();
+		ot_batcher.first_batch++;
+	}
+
+	return success;
+}
+
+/**
+ * the following three functions turn the next num_OTs random OTs of the pool into OTs of S1's labels (Beaver):
+ * S2 sends its actual choices XORed with the random ones, and S1 sends each label pair under the pads, swapped where they differ;
+ * with too few OTs left in the pool (their extension failed), the messages are still sent, but zeroed, and FALSE returned
+ */
+
+int random_OT_corrections(random_ot_pool *pool, CBitVector *OT_bits, uint32_t num_OTs, unsigned char *corrections_buf)
+{
+	memset(corrections_buf, 0, ceil_divide(num_OTs, 8));
+	if (pool->next_OT + num_OTs > pool->num_OTs)
+		return FALSE;
+
+	for (uint32_t i = 0; i < num_OTs; i++)
+	{
+		int d_i = OT_bits->GetBitNoMask(i) ^ pool->choices.GetBitNoMask(pool->next_OT + i);
+		corrections_buf[i / 8] |= d_i << (i % 8);
+	}
+	return TRUE;
+}
+
+
+
+int derandomize_OT_send(random_ot_pool *pool, unsigned char *corrections_buf, block *OT_zero_buf, block *OT_one_buf, uint32_t num_OTs, block *masked_labels)
+{
+	if (pool->next_OT + num_OTs > pool->num_OTs)
+	{
+		memset(masked_labels, 0, 2 * num_OTs * sizeof(block));
+		return FALSE;
+	}
+
+	block *pads_0 = (block*) pool->pads[0].GetArr() + pool->next_OT;
+	block *pads_1 = (block*) pool->pads[1].GetArr() + pool->next_OT;
+	for (uint32_t i = 0; i < num_OTs; i++)
+	{
+		int d_i = (corrections_buf[i / 8] >> (i % 8)) & 1;
+		masked_labels[2*i] = xorBlocks(OT_zero_buf[i], d_i ? _mm_loadu_si128(&pads_1[i]) : _mm_loadu_si128(&pads_0[i]));
+		masked_labels[2*i + 1] = xorBlocks(OT_one_buf[i], d_i ? _mm_loadu_si128(&pads_0[i]) : _mm_loadu_si128(&pads_1[i]));
+	}
+	return TRUE;
+}
+
+
+
+void derandomize_OT_recv(random_ot_pool *pool, block *masked_labels, CBitVector *OT_bits, uint32_t num_OTs, block *labels)
+{
+	block *pads = (block*) pool->pads[0].GetArr() + pool->next_OT;
+	for (uint32_t i = 0; i < num_OTs; i++)
+		labels[i] = xorBlocks(masked_labels[2*i + OT_bits->GetBitNoMask(i)], _mm_loadu_si128(&pads[i]));
+}
+
+
+
 /**
  * command line argument parser
  */
@@ -334,6 +751,9 @@ int32_t read_test_options(int32_t* argcp, char*** argvp, int* role, int *verbose
 	uint32_t loc_num_checks = 0;
 	uint32_t loc_secparam = 0;
 	uint32_t loc_statparam = 0;
+	uint32_t loc_garbling_threads = 0;
+	uint32_t loc_pregarbled_instances = 0;
+	uint32_t loc_pregarbling_workers = 0;
 
 	parsing_ctx options[] =
 	{
@@ -344,7 +764,9 @@ int32_t read_test_options(int32_t* argcp, char*** argvp, int* role, int *verbose
 		{ (void*) &pn_config_file, T_STR, "fc", "PeerNet configuration filename", false, false },
 		{ (void*) &rsa_prv_keyfile, T_STR, "fr", "RSA private key file name", false, false },
 		{ (void*) &chosen_df_str, T_STR, "df", "Distance function, default: cs (cosine similarity)", false, false },
-		{ (void*) &chosen_vf_str, T_STR, "vf", "Commitment verification function, default: sha2_256)", false, false },
+		{ (void*) &chosen_vf_str, T_STR, "vf", "Commitment verification function: sha2-256 or sha3-256, default: sha2-256", false, false },
+		{ (void*) &chosen_ar_str, T_STR, "ar", "Distance arithmetic for cs and ed: float or fxp<L>.<F>, default: float", false, false },
+		{ (void*) &precomputed_enrollment, T_NUM, "pe", "Enrollment-only terms precomputed for cs and ed?, default: false", false, false },
 		{ (void*) &loc_num_inputs, T_NUM, "in", "Number of biometric inputs (i.e. vector size), default: 192", false, false },
 		{ (void*) &loc_input_length, T_NUM, "il", "Input length (biometric input vector), default: 8", false, false },
 		{ (void*) &loc_num_baseOTs, T_NUM, "nbo", "Number of base OTs, default: 190", false, false },
@@ -354,6 +776,14 @@ int32_t read_test_options(int32_t* argcp, char*** argvp, int* role, int *verbose
 		{ (void*) verifying_ot, T_NUM, "v", "Verifying OTs?, default: true", false, false },
 		{ (void*) &loc_computing_offline, T_NUM, "coff", "Computing offline times and comm?, default: true", false, false },
 		{ (void*) &loc_computing_online, T_NUM, "con", "Computing online times and comm?, default: true", false, false },
+		{ (void*) &loc_garbling_threads, T_NUM, "gt", "Garbling threads (S1 only), default: 1", false, false },
+		{ (void*) &loc_pregarbled_instances, T_NUM, "pg", "Pre-garbled circuits kept ready (S1 only), default: 0 (garble in session)", false, false },
+		{ (void*) &loc_pregarbling_workers, T_NUM, "pw", "Pre-garbling worker threads (S1 only), default: 1", false, false },
+		{ (void*) &serving_sessions, T_NUM, "ns", "Client sessions served before exiting (S1 and S2 only), 0 for no limit, default: 1", false, false },
+		{ (void*) &random_OT_sessions, T_NUM, "ro", "Sessions of random OTs precomputed at a time (S1 and S2 only), default: 0 (OTs in session)", false, false },
+		{ (void*) &session_workers, T_NUM, "sw", "Concurrent session workers, one per session slot (S1 and S2 only), default: 1", false, false },
+		{ (void*) &session_slot, T_NUM, "sl", "Session slot to authenticate in (C only), default: 0", false, false },
+		{ (void*) &OT_state_file, T_STR, "os", "OT extension state file prefix, kept across runs (S1 and S2 only), default: none (base OTs at every start)", false, false },
 		{ (void*) &printhelp, T_FLAG, "h", "Print help", false, false }
 	};
 
@@ -431,6 +861,18 @@ int32_t read_test_options(int32_t* argcp, char*** argvp, int* role, int *verbose
 		assert(loc_computing_online == 0);
 		*computing_online = loc_computing_online;
 	}
+	if(loc_garbling_threads != 0)
+	{
+		garbling_threads = loc_garbling_threads;
+	}
+	if(loc_pregarbled_instances != 0)
+	{
+		pregarbled_instances = loc_pregarbled_instances;
+	}
+	if(loc_pregarbling_workers != 0)
+	{
+		pregarbling_workers = loc_pregarbling_workers;
+	}
 
 	return 1;
 }
@@ -441,12 +883,27 @@ int main(int argc, char** argv)
 
 	read_test_options(&argc, &argv, &my_id, &verbose, &test_run_num, &num_inputs, &input_length, &verifying_ot, &computing_offline, &computing_online);
 
+	//NOTE S1 and S2 hold different halves of the OT state, so each keeps its own file even when they share a directory
+	if (OT_state_file != "")
+		OT_state_file += "." + id_str[my_id];
+
+	//NOTE each session worker of S1 and S2 has its own OT channels, counting up from 0, and its own admin channel, counting down from the OT admin channel
+	if ((session_workers < 1) || (session_workers * OT_CHANNELS_PER_WORKER > OT_WORKER_ADMIN_CHANNEL(session_workers - 1)))
+	{
+		std::cerr << "Session workers must be between 1 and " << (OT_ADMIN_CHANNEL + 1) / (OT_CHANNELS_PER_WORKER + 1) << "\n";
+		std::exit(EXIT_FAILURE);
+	}
+
 	int num_input_bits = (num_inputs * input_length) + 64;
 	int num_input_bytes = ceil_divide(num_input_bits, 8);
 
 	std::string gc_file = "circuit_files/bio_auth_" + df_str[chosen_df] + "_";
 	if (chosen_tm == MALICIOUS)
 		gc_file += "mal_" + chosen_vf_str + "_";
+	if ((chosen_df != HD) && (chosen_ar_str.compare(0, 3, "fxp") == 0))
+		gc_file += (chosen_ar_str.compare("fxp") == 0 ? "fxp26.24" : chosen_ar_str) + "_";
+	if ((chosen_df != HD) && precomputed_enrollment)
+		gc_file += "pre_";
 	gc_file += std::to_string(num_inputs) + "_" + std::to_string(input_length) + ".scd";
 	//NOTE for compatibility with JG function readCircuitFromFile()
 	char* gc_file_c = const_cast<char*>(gc_file.c_str());
@@ -508,13 +965,6 @@ int main(int argc, char** argv)
 		ot_ext_prot prot = ALSZ;
 	}
 
-	BYTE failure, decision;
-	BYTE errors_detected = false;
-	int bytes_in = 0;
-	int bytes_out = 0;
-	int tot_bytes_in = 0;
-	int tot_bytes_out = 0;
-
 	//in blocks, 1 block per bit
 
 	int num_OT_bits = chosen_df == HD ? num_input_bits : 2 * num_input_bits;
@@ -529,7 +979,6 @@ int main(int argc, char** argv)
 	CLock *glock = new CLock(); // pass this to sender and receiver constructors
 
 	bool resetting_OT_addrs = false;
-	unsigned char ack_buf[1];
 
 	if (rsa_prv_keyfile != "")
 		resetting_OT_addrs = true;
@@ -545,7 +994,9 @@ int main(int argc, char** argv)
 
 	timer = new Timer();
 
-	peer_net = new PeerNet(3, my_id, rsa_prv_keyfile, pn_config_file);
+	//NOTE S1 and S2 connect session slot 0 here, the slots of further session workers are connected by those workers
+	int port_offset = (my_id == C_ID) ? session_slot * SESSION_SLOT_PORT_STRIDE : 0;
+	peer_net = new PeerNet(3, my_id, rsa_prv_keyfile, pn_config_file, 0, 0, 0, port_offset);
 
 	if (resetting_OT_addrs)
 	{
@@ -555,21 +1006,15 @@ int main(int argc, char** argv)
 
 	if (test_run_num >= 0) verbose = false;
 
-	int debug_ctr = 0;
+	//NOTE S1 and S2 set up the OT link, base OTs and circuit once, and keep them for every session they serve
+	GarbledCircuit garbledCircuit;
+	long gtable_bytes = 0;
+	GarblingPool *garbling_pool = NULL;	//S1 only
+	std::vector<OTExt*> worker_OT_exts;
+	std::vector<GarbledCircuit> worker_circuits;	//session workers other than the first garble or evaluate their own copy
 
-	//NOTE begin individual party branches
 	if (my_id == S1_ID)
 	{
-		//generate runtime random value for S1's share of enrollment biometric (B1)
-
-		mpz_t b_1;
-		mpz_init2(b_1, num_input_bits);
-		aby_prng(b_1, num_input_bits);
-
-		mpz_t c_1;
-		mpz_init2(c_1, num_input_bits);
-		aby_prng(c_1, num_input_bits);
-
 		OT_socket = Listen(OT_send_addr, OT_port);
 		if (!OT_socket)
 		{
@@ -577,668 +1022,939 @@ int main(int argc, char** argv)
 			std::exit(1);
 		}
 
-	 	InitOTSender(crypt, glock, OT_socket, verifying_ot);
-
-		GarbledCircuit garbledCircuit;
-		errors_detected = readCircuitFromFile(&garbledCircuit, gc_file_c) < 0;
+		//NOTE the base OTs of all session workers are run here, one after the other, in the same order as S2
+		for (int worker = 0; worker < session_workers; worker++)
+		{
+			InitOTSender(crypt, glock, OT_socket, verifying_ot, worker);
+			worker_OT_exts.push_back(sender);
+		}
 
-		if (errors_detected)
+		if (readCircuitFromFile(&garbledCircuit, gc_file_c) < 0)
 		{
 			printf("Error reading GC scd file\n");
 		}
 
+		read_precomputed_bits(&garbledCircuit, &num_OT_bits, &gc_input_size);
 		assert(garbledCircuit.n == gc_input_size);
 		assert(garbledCircuit.m == 2 + chosen_tm);
 
-#ifdef ROW_REDUCTION
-		int gtable_size = 3 * garbledCircuit.q;	//in blocks
-#else
-		int gtable_size = 4 * garbledCircuit.q;	//in blocks
-#endif
+		//NOTE only non-free gates have table rows, see getTableRows() in JG
+		gtable_bytes = getTableRows(&garbledCircuit) * sizeof(GarbledTable);
 
-		group_ACK();
+		setGarblingThreads(garbling_threads);
 
-		if (computing_offline)
+		//NOTE with a pool, circuits are garbled by its workers ahead of the sessions rather than after group_ACK()
+		if (pregarbled_instances > 0)
 		{
-			//NOTE test run timer starts now; offline time included
-			timer->process_timestamp(false, verbose, NULL);
-			//NOTE test run timer starts now; offline time included
+			garbling_pool = createGarblingPool(&garbledCircuit, pregarbled_instances, pregarbling_workers);
+			if (garbling_pool == NULL)
+				printf("Error starting pre-garbling pool, garbling in session\n");
+		}
+	}
+	else if (my_id == S2_ID)
+	{
+		OT_socket = Connect(OT_send_addr, OT_port);
+		if (!OT_socket)
+		{
+			std::cerr << "Connect failed on " << OT_send_addr << ":" << OT_port << "\n";
+			std::exit(1);
 		}
 
-		unsigned char bhat1_buf[num_input_bytes];
-		block *in_labels = (block*) malloc(sizeof(block) * 2 * garbledCircuit.n);
-		block *out_labels = (block*) malloc(sizeof(block) * 2 * garbledCircuit.m);
-
-		if (computing_offline)
-			timer->process_timestamp(true, verbose, "\nGarbling circuit\n");
-
-		garbleCircuit(&garbledCircuit, in_labels, out_labels);
+		for (int worker = 0; worker < session_workers; worker++)
+		{
+			InitOTReceiver(crypt, glock, OT_socket, verifying_ot, worker);
+			worker_OT_exts.push_back(receiver);
+		}
 
-		if (computing_offline)
-			timer->process_timestamp(true, verbose, "Done garbling circuit\n\n");
+		if (readCircuitFromFile(&garbledCircuit, gc_file_c) < 0)
+		{
+			printf("Error reading GC scd file\n");
+		}
 
-		block *table_buf = (block*) malloc(gtable_size * sizeof(block));		// assumes no truncation in GC
-		//copy garbled table into send buffer
-		memcpy(table_buf, &garbledCircuit.garbledTable->table, gtable_size * sizeof(block));
+		//NOTE only non-free gates have table rows, see getTableRows() in JG
+		gtable_bytes = getTableRows(&garbledCircuit) * sizeof(GarbledTable);
 
-		if (computing_offline)
-			timer->process_timestamp(true, verbose, "\nSending garbled table to S2\n");
+		read_precomputed_bits(&garbledCircuit, &num_OT_bits, &gc_input_size);
+		assert(garbledCircuit.n == gc_input_size);
+		assert(garbledCircuit.m == 2 + chosen_tm);
+	}
 
-		bytes_out = peer_net->send_to_peer(S2_ID, (unsigned char*) table_buf, gtable_size * sizeof(block), PLAINTEXT, NULL);
-		errors_detected = bytes_out != gtable_size * sizeof(block);
+	if (my_id != C_ID)
+	{
+		ot_batcher.ot_ext = worker_OT_exts[0];
+	}
 
-		if (computing_offline)
+	//NOTE session worker w serves the clients of session slot w, all workers share the OT socket, the garbling pool
+	//NOTE and the circuit read above; all but the first read their own circuit copy to garble or evaluate in place
+	auto serve_sessions = [&](int worker, GarbledCircuit &garbledCircuit)
+	{
+		BYTE failure, decision;
+		BYTE errors_detected = false;
+		int bytes_in = 0;
+		int bytes_out = 0;
+		int tot_bytes_in = 0;
+		int tot_bytes_out = 0;
+		unsigned char ack_buf[1];
+		random_ot_pool ot_pool;
+
+		if (worker > 0)
 		{
-			timer->process_timestamp(true, verbose, "Done sending garbled table to S2\n");
-			tot_bytes_out += bytes_out;
+			timer = new Timer();
+			peer_net = new PeerNet(3, my_id, rsa_prv_keyfile, pn_config_file, 0, 0, 0, worker * SESSION_SLOT_PORT_STRIDE);
 		}
-
-		if (errors_detected)
+		if (my_id == S1_ID)
+			sender = (OTExtSnd*) worker_OT_exts[worker];
+		else if (my_id == S2_ID)
+			receiver = (OTExtRec*) worker_OT_exts[worker];
+
+		//NOTE a C process runs one session; S1 and S2 serve serving_sessions of them (0 for no limit) in each session
+		//NOTE worker, each from a new C, and number the test runs of concurrent workers apart
+		int num_sessions = (my_id == C_ID) ? 1 : serving_sessions;
+		for (int session = 0; (num_sessions == 0) || (session < num_sessions); session++)
 		{
-			printf("Error sending garbled table to S2\n");
-		}
+			int session_run_num = (test_run_num < 0) ? test_run_num : test_run_num + session * session_workers + worker;
+			tot_bytes_in = 0;
+			tot_bytes_out = 0;
+			GarbledInstance *garbled_instance = NULL;	//S1 only
+
+			//NOTE back-pressure: a worker takes on its next client only once it holds a pre-garbled circuit and
+			//NOTE enough random OTs for it, so clients wait to connect rather than stall mid-session
+			if ((my_id == S1_ID) && (garbling_pool != NULL))
+				garbled_instance = takeGarbledInstance(garbling_pool);
+			if ((my_id != C_ID) && (random_OT_sessions > 0) && !fill_random_ot_pool(&ot_pool, num_OT_bits, worker, crypt, glock, OT_socket))
+				printf("Error extending random OTs with %s\n", (my_id == S1_ID) ? "S2" : "S1");
+
+			if (session > 0)
+			{
+				//NOTE only the links to the new C are set up again, see reconnect_peer() in PeerNet
+				if (!peer_net->reconnect_peer(C_ID))
+				{
+					if (garbled_instance != NULL)
+						releaseGarbledInstance(garbling_pool, garbled_instance);
+					break;
+				}
+				delete timer;
+				timer = new Timer();
+			}
 
-		block *s2_label_buf;
+			//NOTE begin individual party branches
+			if (my_id == S1_ID)
+			{
+				//generate runtime random value for S1's share of enrollment biometric (B1), precomputed terms included
 
-		if (chosen_tm == MALICIOUS)
-		{
-			s2_label_buf = (block*) malloc(commitment_size * sizeof(block));
+				mpz_t b_1;
+				mpz_init2(b_1, num_input_bits + num_precomputed_bits);
+				aby_prng(b_1, num_input_bits + num_precomputed_bits);
 
-			//set commitment labels for comparison
-			for (int i = 0; i < commitment_size; i++)
-			{
-				int c_i = mpz_tstbit(c_1, i);
-				memcpy(&s2_label_buf[i], &in_labels[(6 * num_input_bits + (2*i + c_i))], sizeof(block));
-			}
+				mpz_t c_1;
+				mpz_init2(c_1, num_input_bits);
+				aby_prng(c_1, num_input_bits);
 
-			if (computing_offline)
-				timer->process_timestamp(true, verbose, "\nSending commitment labels to S2\n");
+				group_ACK();
 
-			bytes_out = peer_net->send_to_peer(S2_ID, (unsigned char*) s2_label_buf, commitment_size * sizeof(block), ENCRYPTED, NULL);
-			errors_detected = bytes_out != commitment_size * sizeof(block);
+				if (computing_offline)
+				{
+					//NOTE test run timer starts now; offline time included
+					timer->process_timestamp(false, verbose, NULL);
+					//NOTE test run timer starts now; offline time included
+				}
 
-			if (computing_offline)
-			{
-				timer->process_timestamp(true, verbose, "Done sending commitment labels to S2\n\n");
-				tot_bytes_out += bytes_out;
-			}
+				unsigned char bhat1_buf[num_input_bytes];
+				block *in_labels = (block*) malloc(sizeof(block) * 2 * garbledCircuit.n);
+				block *out_labels;
 
-			if (errors_detected)
-			{
-				printf("Error sending commitment labels to S2\n");
-			}
-		}
+				if (garbling_pool != NULL)
+				{
+					if (computing_offline)
+						timer->process_timestamp(true, verbose, "\nTaking pre-garbled circuit and sending garbled table to S2\n");
 
-		if (!computing_online)
-		{
-			free(in_labels);
-			free(out_labels);
-			free(table_buf);
-			removeGarbledCircuit(&garbledCircuit);
-			mpz_clear(b_1);
-			mpz_clear(c_1);
-			goto finalization;
-		}
+					//NOTE pooled instances keep only their seed, the input labels for the OTs are recomputed from it
+					createInputLabelsFromSeed(in_labels, garbledCircuit.n, garbled_instance->seed);
+					out_labels = garbled_instance->outputMap;
+					bytes_out = peer_net->send_to_peer(S2_ID, (unsigned char*) garbled_instance->garbledTable, gtable_bytes, PLAINTEXT, NULL);
+				}
+				else
+				{
+					out_labels = (block*) malloc(sizeof(block) * 2 * garbledCircuit.m);
+
+					if (computing_offline)
+						timer->process_timestamp(true, verbose, "\nGarbling circuit and sending garbled table to S2\n");
+
+					//NOTE table rows are sent straight from the garbled circuit by a second thread while the rest is garbled
+					long table_bytes_out = 0;
+					table_stream stream;
+					PeerNet *table_net = peer_net;
+					std::thread table_sender([&stream, &table_bytes_out, &garbledCircuit, gtable_bytes, table_net] {
+						table_bytes_out = send_table_stream(table_net, &stream, garbledCircuit.garbledTable, gtable_bytes);
+					});
+
+					garbleCircuitStreaming(&garbledCircuit, in_labels, out_labels, GC_STREAM_CHUNK_ROWS, table_stream_sink, &stream);
+					{
+						std::lock_guard<std::mutex> lock(stream.mtx);
+						stream.done = true;
+						stream.rows_ready.notify_one();
+					}
+
+					if (computing_offline)
+						timer->process_timestamp(true, verbose, "Done garbling circuit\n");
+
+					table_sender.join();
+					bytes_out = table_bytes_out;
+				}
+				errors_detected = bytes_out != gtable_bytes;
 
-		//NOTE synchronization
-		peer_net->receive_from_peer(C_ID, ack_buf, 1, PLAINTEXT, NULL);
-		peer_net->receive_from_peer(S2_ID, ack_buf, 1, PLAINTEXT, NULL);
-		peer_net->send_to_peer(C_ID, ack_buf, 1, PLAINTEXT, NULL);
-		peer_net->send_to_peer(S2_ID, ack_buf, 1, PLAINTEXT, NULL);
+				if (computing_offline)
+				{
+					timer->process_timestamp(true, verbose, "Done sending garbled table to S2\n");
+					tot_bytes_out += bytes_out;
+				}
 
-		if (!computing_offline)
-		{
-			//NOTE test run timer starts now; offline time NOT included
-			timer->process_timestamp(false, verbose, NULL);
-			//NOTE test run timer starts now; offline time NOT included
-		}
+				if (errors_detected)
+				{
+					printf("Error sending garbled table to S2\n");
+				}
 
-		timer->process_timestamp(true, verbose, "\nReceiving XOR share from C\n");
-		bytes_in = peer_net->receive_from_peer(C_ID, bhat1_buf, num_input_bytes, ENCRYPTED, NULL);
-		timer->process_timestamp(true, verbose, "Done receiving XOR share from C\n\n");
-		errors_detected = bytes_in != num_input_bytes;
-		tot_bytes_in += bytes_in;
+				block *s2_label_buf;
 
-		//there is no secific creation of delta because JustGarble handles this implicitly within createInputLabels (called from garbleCircuit() from within Garbler_Process_GC())
+				if (chosen_tm == MALICIOUS)
+				{
+					s2_label_buf = (block*) malloc(commitment_size * sizeof(block));
+
+					//set commitment labels for comparison
+					for (int i = 0; i < commitment_size; i++)
+					{
+						int c_i = mpz_tstbit(c_1, i);
+						memcpy(&s2_label_buf[i], &in_labels[(6 * num_input_bits + (2*i + c_i))], sizeof(block));
+					}
+
+					if (computing_offline)
+						timer->process_timestamp(true, verbose, "\nSending commitment labels to S2\n");
+
+					bytes_out = peer_net->send_to_peer(S2_ID, (unsigned char*) s2_label_buf, commitment_size * sizeof(block), ENCRYPTED, NULL);
+					errors_detected = bytes_out != commitment_size * sizeof(block);
+
+					if (computing_offline)
+					{
+						timer->process_timestamp(true, verbose, "Done sending commitment labels to S2\n\n");
+						tot_bytes_out += bytes_out;
+					}
+
+					if (errors_detected)
+					{
+						printf("Error sending commitment labels to S2\n");
+					}
+				}
 
-		block *OT_zero_buf = (block*) malloc(num_OT_bits * sizeof(block));
-		block *OT_one_buf = (block*) malloc(num_OT_bits * sizeof(block));
+				if (random_OT_sessions > 0)
+				{
+					if (computing_offline)
+						timer->process_timestamp(true, verbose, "\nExtending random OTs with S2\n");
 
-		CBitVector **OT_all = (CBitVector**) malloc(2 * sizeof(CBitVector*));
-		for(int i = 0; i < 2; i++)
-		{
-			OT_all[i] = new CBitVector();
-			OT_all[i]->Create(num_OT_bits, 8 * sizeof(block));
-		}
+					errors_detected = !fill_random_ot_pool(&ot_pool, num_OT_bits, worker, crypt, glock, OT_socket);
 
-		//put extracted labels (based on b_1 bits) into buffer, for transmission to S2
-		for (int i = 0; i < num_input_bits; i++)
-		{
-			int b_i = mpz_tstbit(b_1, i);
-			int rhat_i = (bhat1_buf[i / 8] & (1 << (i % 8))) >> (i % 8);
-			memcpy(&OT_zero_buf[i], &in_labels[2*i + rhat_i], sizeof(block));
-			memcpy(&OT_one_buf[i], &in_labels[(2*i + (rhat_i ^ 1))], sizeof(block));
-			memcpy(&OT_zero_buf[num_input_bits + i], &in_labels[2*num_input_bits + 2*i + b_i], sizeof(block));
-			memcpy(&OT_one_buf[num_input_bits + i], &in_labels[2*num_input_bits + (2*i + (b_i ^ 1))], sizeof(block));
-		}
+					if (computing_offline)
+						timer->process_timestamp(true, verbose, "Done extending random OTs with S2\n\n");
 
-		mpz_clear(b_1);
-		mpz_clear(c_1);
+					if (errors_detected)
+					{
+						printf("Error extending random OTs with S2\n");
+					}
+				}
 
-		OT_all[0]->SetBits((BYTE*) OT_zero_buf, 0, num_OT_bits * 8 * sizeof(block));
-		OT_all[1]->SetBits((BYTE*) OT_one_buf, 0, num_OT_bits * 8 * sizeof(block));
+				if (!computing_online)
+				{
+					free(in_labels);
+					if (garbling_pool != NULL)
+					{
+						releaseGarbledInstance(garbling_pool, garbled_instance);
+					}
+					else
+					{
+						free(out_labels);
+					}
+					mpz_clear(b_1);
+					mpz_clear(c_1);
+					goto finalization;
+				}
 
-		timer->process_timestamp(true, verbose, "\nEngaging in OT with S2\n");
-		errors_detected = !OTSend(OT_all, num_OT_bits, 8 * sizeof(block), crypt, glock, OT_socket);
-		timer->process_timestamp(true, verbose, "Done engaging in OT with S2\n\n");
+				//NOTE synchronization
+				peer_net->receive_from_peer(C_ID, ack_buf, 1, PLAINTEXT, NULL);
+				peer_net->receive_from_peer(S2_ID, ack_buf, 1, PLAINTEXT, NULL);
+				peer_net->send_to_peer(C_ID, ack_buf, 1, PLAINTEXT, NULL);
+				peer_net->send_to_peer(S2_ID, ack_buf, 1, PLAINTEXT, NULL);
 
-		if (errors_detected)
-		{
-			printf("Error engaging in OT with S2\n");
-		}
+				if (!computing_offline)
+				{
+					//NOTE test run timer starts now; offline time NOT included
+					timer->process_timestamp(false, verbose, NULL);
+					//NOTE test run timer starts now; offline time NOT included
+				}
 
-		BYTE verify_success, verify_failure;
-		BYTE* elln_buf = (BYTE*) malloc(1 + ((2 + chosen_tm) * sizeof(block)));
+				timer->process_timestamp(true, verbose, "\nReceiving XOR share from C\n");
+				bytes_in = peer_net->receive_from_peer(C_ID, bhat1_buf, num_input_bytes, ENCRYPTED, NULL);
+				timer->process_timestamp(true, verbose, "Done receiving XOR share from C\n\n");
+				errors_detected = bytes_in != num_input_bytes;
+				tot_bytes_in += bytes_in;
 
-		timer->process_timestamp(true, verbose, "\nReceiving output labels from S2\n");
-		bytes_in = peer_net->receive_from_peer(S2_ID, elln_buf, 1 + ((2 + chosen_tm) * sizeof(block)), ENCRYPTED, NULL);
-		timer->process_timestamp(true, verbose, "Done receiving output labels from S2\n\n");
-		errors_detected = bytes_in != 1 + ((2 + chosen_tm) * sizeof(block));
-		tot_bytes_in += bytes_in;
+				//there is no secific creation of delta because JustGarble handles this implicitly within createInputLabels (called from garbleCircuit() from within Garbler_Process_GC())
 
-		if (errors_detected)
-		{
-			printf("Error receiving labels from S2\n");
-		}
+				block *OT_zero_buf = (block*) malloc(num_OT_bits * sizeof(block));
+				block *OT_one_buf = (block*) malloc(num_OT_bits * sizeof(block));
 
-		int accepted_dist;
-		int accepted_norm;
-		int rejected_dist;
-		int accepted_verif;
-		int rejected_norm;
-		int rejected_verif;
+				CBitVector **OT_all = (CBitVector**) malloc(2 * sizeof(CBitVector*));
+				for(int i = 0; i < 2; i++)
+				{
+					OT_all[i] = new CBitVector();
+					OT_all[i]->Create(num_OT_bits, 8 * sizeof(block));
+				}
 
-		if (!errors_detected & (elln_buf[(2 + chosen_tm) * sizeof(block)] == 1))
-		{
-			int accepted_dist = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[1]), _mm_castsi128_pd (*((block*) elln_buf)));
-			int rejected_dist = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[0]), _mm_castsi128_pd (*((block*) elln_buf)));
+				//put extracted labels (based on b_1 bits) into buffer, for transmission to S2
+				for (int i = 0; i < num_input_bits; i++)
+				{
+					int b_i = mpz_tstbit(b_1, i);
+					int rhat_i = (bhat1_buf[i / 8] & (1 << (i % 8))) >> (i % 8);
+					memcpy(&OT_zero_buf[i], &in_labels[2*i + rhat_i], sizeof(block));
+					memcpy(&OT_one_buf[i], &in_labels[(2*i + (rhat_i ^ 1))], sizeof(block));
+					memcpy(&OT_zero_buf[num_input_bits + i], &in_labels[2*num_input_bits + 2*i + b_i], sizeof(block));
+					memcpy(&OT_one_buf[num_input_bits + i], &in_labels[2*num_input_bits + (2*i + (b_i ^ 1))], sizeof(block));
+				}
+				for (int i = num_input_bits; i < num_input_bits + num_precomputed_bits; i++)
+				{
+					int b_i = mpz_tstbit(b_1, i);
+					memcpy(&OT_zero_buf[num_input_bits + i], &in_labels[2*num_input_bits + 2*i + b_i], sizeof(block));
+					memcpy(&OT_one_buf[num_input_bits + i], &in_labels[2*num_input_bits + (2*i + (b_i ^ 1))], sizeof(block));
+				}
 
-			int accepted_norm = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[3]), _mm_castsi128_pd (*((block*) &elln_buf[sizeof(block)])));
-			int rejected_norm = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[2]), _mm_castsi128_pd (*((block*) &elln_buf[sizeof(block)])));
+				mpz_clear(b_1);
+				mpz_clear(c_1);
 
-			if (chosen_tm == MALICIOUS)
-			{
-				int accepted_verif = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[5]), _mm_castsi128_pd (*((block*) &elln_buf[2 * sizeof(block)])));
-				int rejected_verif = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[4]), _mm_castsi128_pd (*((block*) &elln_buf[2 * sizeof(block)])));
-			}
+				OT_all[0]->SetBits((BYTE*) OT_zero_buf, 0, num_OT_bits * 8 * sizeof(block));
+				OT_all[1]->SetBits((BYTE*) OT_one_buf, 0, num_OT_bits * 8 * sizeof(block));
 
-			if (verbose)
-			{
-				if (!(accepted_dist || rejected_dist ))
-					printf("Distance label mismatch\n");
+				if (random_OT_sessions > 0)
+				{
+					//NOTE the OTs were extended offline, only their derandomization is left, see random_OT_corrections()
+					int corrections_bytes = ceil_divide(num_OT_bits, 8);
+					unsigned char *corrections_buf = (unsigned char*) malloc(corrections_bytes);
+					block *masked_labels = (block*) malloc(2 * num_OT_bits * sizeof(block));
+
+					timer->process_timestamp(true, verbose, "\nDerandomizing precomputed OTs with S2\n");
+					bytes_in = peer_net->receive_from_peer(S2_ID, corrections_buf, corrections_bytes, PLAINTEXT, NULL);
+					errors_detected = bytes_in != corrections_bytes;
+					tot_bytes_in += bytes_in;
+					if (!errors_detected)
+					{
+						errors_detected = !derandomize_OT_send(&ot_pool, corrections_buf, OT_zero_buf, OT_one_buf, num_OT_bits, masked_labels);
+						bytes_out = peer_net->send_to_peer(S2_ID, (unsigned char*) masked_labels, 2 * num_OT_bits * sizeof(block), PLAINTEXT, NULL);
+						errors_detected |= bytes_out != 2 * num_OT_bits * sizeof(block);
+						tot_bytes_out += bytes_out;
+					}
+					timer->process_timestamp(true, verbose, "Done derandomizing precomputed OTs with S2\n\n");
+					ot_pool.next_OT += num_OT_bits;
+
+					free(corrections_buf);
+					free(masked_labels);
+				}
 				else
-					printf("Valid distance label received\n");
+				{
+					timer->process_timestamp(true, verbose, "\nEngaging in OT with S2\n");
+					errors_detected = !OTSend(OT_all, num_OT_bits, 8 * sizeof(block), crypt, glock, OT_socket);
+					timer->process_timestamp(true, verbose, "Done engaging in OT with S2\n\n");
+				}
+
+				if (errors_detected)
+				{
+					printf("Error engaging in OT with S2\n");
+				}
 
-				if (!(accepted_norm || rejected_norm))
-					printf("Normalization label mismatch\n");
+				BYTE verify_success, verify_failure;
+				BYTE* elln_buf = (BYTE*) malloc(1 + ((2 + chosen_tm) * sizeof(block)));
+
+				timer->process_timestamp(true, verbose, "\nReceiving output labels from S2\n");
+				bytes_in = peer_net->receive_from_peer(S2_ID, elln_buf, 1 + ((2 + chosen_tm) * sizeof(block)), ENCRYPTED, NULL);
+				timer->process_timestamp(true, verbose, "Done receiving output labels from S2\n\n");
+				errors_detected = bytes_in != 1 + ((2 + chosen_tm) * sizeof(block));
+				tot_bytes_in += bytes_in;
+
+				if (errors_detected)
+				{
+					printf("Error receiving labels from S2\n");
+				}
+
+				int accepted_dist;
+				int accepted_norm;
+				int rejected_dist;
+				int accepted_verif;
+				int rejected_norm;
+				int rejected_verif;
+
+				if (!errors_detected & (elln_buf[(2 + chosen_tm) * sizeof(block)] == 1))
+				{
+					int accepted_dist = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[1]), _mm_castsi128_pd (*((block*) elln_buf)));
+					int rejected_dist = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[0]), _mm_castsi128_pd (*((block*) elln_buf)));
+
+					int accepted_norm = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[3]), _mm_castsi128_pd (*((block*) &elln_buf[sizeof(block)])));
+					int rejected_norm = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[2]), _mm_castsi128_pd (*((block*) &elln_buf[sizeof(block)])));
+
+					if (chosen_tm == MALICIOUS)
+					{
+						int accepted_verif = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[5]), _mm_castsi128_pd (*((block*) &elln_buf[2 * sizeof(block)])));
+						int rejected_verif = _mm_ucomieq_sd (_mm_castsi128_pd (out_labels[4]), _mm_castsi128_pd (*((block*) &elln_buf[2 * sizeof(block)])));
+					}
+
+					if (verbose)
+					{
+						if (!(accepted_dist || rejected_dist ))
+							printf("Distance label mismatch\n");
+						else
+							printf("Valid distance label received\n");
+
+						if (!(accepted_norm || rejected_norm))
+							printf("Normalization label mismatch\n");
+						else
+							printf("Valid normalization received\n");
+
+						if (chosen_tm == MALICIOUS)
+						{
+							if (!(accepted_verif || rejected_verif))
+								printf("Verification label mismatch\n");
+							else
+								printf("Valid verification received\n");
+						}
+					}
+
+					if (accepted_dist && accepted_norm && ((chosen_tm == MALICIOUS) && accepted_verif))
+					{
+						decision = 1;	//accept C
+					}
+					else {
+						decision = 0;	//reject C
+					}
+				}
 				else
-					printf("Valid normalization received\n");
+				{
+					decision = 4;	//retry, other error(s)
+					if (elln_buf[(2 + chosen_tm) * sizeof(block)] != 1)
+					{
+						printf("S2 signals failure\n");
+					}
+				}
+
+				if (verbose) printf("\nDecision at S1:\t%u\n\n", decision);
+
+				timer->process_timestamp(true, verbose, "\nSending decision to C\n");
+				bytes_out = peer_net->send_to_peer(C_ID, &decision, 1, ENCRYPTED, NULL);
+				timer->process_timestamp(true, verbose, "Done sending decision to C\n\n");
+				errors_detected = bytes_out != 1;
+				tot_bytes_out += bytes_out;
+
+				if (errors_detected)
+				{
+					printf("Error sending decision to C\n");
+				}
 
 				if (chosen_tm == MALICIOUS)
+					free(s2_label_buf);
+				free(OT_zero_buf);
+				free(OT_one_buf);
+				free(elln_buf);
+
+				OT_all[0]->delCBitVector();
+				OT_all[1]->delCBitVector();
+				delete OT_all[0];
+				delete OT_all[1];
+				free(OT_all);
+
+				free(in_labels);
+				if (garbling_pool != NULL)
 				{
-					if (!(accepted_verif || rejected_verif))
-						printf("Verification label mismatch\n");
-					else
-						printf("Valid verification received\n");
+					releaseGarbledInstance(garbling_pool, garbled_instance);
+				}
+				else
+				{
+					free(out_labels);
 				}
 			}
 
-			if (accepted_dist && accepted_norm && ((chosen_tm == MALICIOUS) && accepted_verif))
+			else if (my_id == S2_ID)
 			{
-				decision = 1;	//accept C
-			}
-			else {
-				decision = 0;	//reject C
-			}
-		}
-		else
-		{
-			decision = 4;	//retry, other error(s)
-			if (elln_buf[(2 + chosen_tm) * sizeof(block)] != 1)
-			{
-				printf("S2 signals failure\n");
-			}
-		}
+				group_ACK();
 
-		if (verbose) printf("\nDecision at S1:\t%u\n\n", decision);
+				if (computing_offline)
+				{
+					//NOTE test run timer starts now; offline time included
+					timer->process_timestamp(false, verbose, NULL);
+					//NOTE test run timer starts now; offline time included
+				}
 
-		timer->process_timestamp(true, verbose, "\nSending decision to C\n");
-		bytes_out = peer_net->send_to_peer(C_ID, &decision, 1, ENCRYPTED, NULL);
-		timer->process_timestamp(true, verbose, "Done sending decision to C\n\n");
-		errors_detected = bytes_out != 1;
-		tot_bytes_out += bytes_out;
+				block *s2_label_buf = (block*) malloc(commitment_size * sizeof(block));
 
-		if (errors_detected)
-		{
-			printf("Error sending decision to C\n");
-		}
+				if (computing_offline)
+					timer->process_timestamp(true, verbose, "\nReceiving garbled table from S1\n");
 
-		free(table_buf);
-		if (chosen_tm == MALICIOUS)
-			free(s2_label_buf);
-		free(OT_zero_buf);
-		free(OT_one_buf);
-		free(elln_buf);
+				//NOTE the table is received in chunks straight into the garbled circuit, as S1 streams it out while garbling
+				long chunk_bytes = GC_STREAM_CHUNK_ROWS * sizeof(GarbledTable);
+				bytes_in = 0;
+				while (bytes_in < gtable_bytes)
+				{
+					int this_chunk_bytes = std::min(chunk_bytes, gtable_bytes - bytes_in);
+					if (peer_net->receive_from_peer(S1_ID, (unsigned char*) garbledCircuit.garbledTable + bytes_in, this_chunk_bytes, PLAINTEXT, NULL) != this_chunk_bytes)
+						break;
+					bytes_in += this_chunk_bytes;
+				}
+				errors_detected = bytes_in != gtable_bytes;
 
-		OT_all[0]->delCBitVector();
-		OT_all[1]->delCBitVector();
-		delete OT_all[0];
-		delete OT_all[1];
-		free(OT_all);
+				if (computing_offline)
+				{
+					timer->process_timestamp(true, verbose, "Done receiving garbled table from S1\n\n");
+					tot_bytes_in += bytes_in;
+				}
 
-		removeGarbledCircuit(&garbledCircuit);
-		free(in_labels);
-		free(out_labels);
-	}
+				if (errors_detected)
+				{
+					printf("Error receiving garbled table from S1\n");
+				}
 
-	else if (my_id == S2_ID)
-	{
-		OT_socket = Connect(OT_send_addr, OT_port);
-		if (!OT_socket)
-		{
-			std::cerr << "Connect failed on " << OT_send_addr << ":" << OT_port << "\n";
-			std::exit(1);
-		}
+				if (chosen_tm == MALICIOUS)
+				{
+					if (computing_offline)
+						timer->process_timestamp(true, verbose, "\nReceiving commitment labels from S1\n");
+
+					bytes_in = peer_net->receive_from_peer(S1_ID, (unsigned char*) s2_label_buf, commitment_size * sizeof(block), ENCRYPTED, NULL);
+					errors_detected = bytes_in != commitment_size * sizeof(block);
+
+					if (computing_offline)
+					{
+						timer->process_timestamp(true, verbose, "Done receiving commitment labels from S1\n\n");
+						tot_bytes_in += bytes_in;
+					}
+
+					if (errors_detected)
+					{
+						printf("Error receiving commitment labels from S1\n");
+					}
+				}
 
-	 	InitOTReceiver(crypt, glock, OT_socket, verifying_ot);
+				if (random_OT_sessions > 0)
+				{
+					if (computing_offline)
+						timer->process_timestamp(true, verbose, "\nExtending random OTs with S1\n");
 
-		GarbledCircuit garbledCircuit;
-		errors_detected = readCircuitFromFile(&garbledCircuit, gc_file_c) < 0;
+					errors_detected = !fill_random_ot_pool(&ot_pool, num_OT_bits, worker, crypt, glock, OT_socket);
 
-#ifdef ROW_REDUCTION
-		int gtable_size = 3 * garbledCircuit.q;	//in blocks
-#else
-		int gtable_size = 4 * garbledCircuit.q;	//in blocks
-#endif
+					if (computing_offline)
+						timer->process_timestamp(true, verbose, "Done extending random OTs with S1\n\n");
 
-		assert(garbledCircuit.n == gc_input_size);
-		assert(garbledCircuit.m == 2 + chosen_tm);
+					if (errors_detected)
+					{
+						printf("Error extending random OTs with S1\n");
+					}
+				}
 
-		group_ACK();
+				block *extracted_labels = (block*) malloc(gc_input_size * sizeof(block));
 
-		if (computing_offline)
-		{
-			//NOTE test run timer starts now; offline time included
-			timer->process_timestamp(false, verbose, NULL);
-			//NOTE test run timer starts now; offline time included
-		}
+				//copy commitment labels to end of buffer, leaving space for labels via OT
+				if (chosen_tm == MALICIOUS)
+					memcpy(&extracted_labels[num_OT_bits], s2_label_buf, commitment_size * sizeof(block));
 
-		block *table_buf = (block*) malloc(gtable_size * sizeof(block));		// assumes no truncation in GC
-		block *s2_label_buf = (block*) malloc(commitment_size * sizeof(block));
+				if (!computing_online)
+				{
+					free(extracted_labels);
+					free(s2_label_buf);
+					goto finalization;
+				}
 
-		if (computing_offline)
-			timer->process_timestamp(true, verbose, "\nReceiving garbled table from S1\n");
+				//NOTE synchronization
+				peer_net->send_to_peer(S1_ID, ack_buf, 1, PLAINTEXT, NULL);
+				peer_net->receive_from_peer(S1_ID, ack_buf, 1, PLAINTEXT, NULL);
 
-		bytes_in = peer_net->receive_from_peer(S1_ID, (unsigned char*) table_buf, gtable_size * sizeof(block), PLAINTEXT, NULL);
-		errors_detected = bytes_in != gtable_size * sizeof(block);
+				BYTE verify_success, verify_failure;
+				BYTE *elln_buf = (BYTE*) malloc(1 + ((2 + chosen_tm) * sizeof(block)));
 
-		if (computing_offline)
-		{
-			timer->process_timestamp(true, verbose, "Done receiving garbled table from S1\n\n");
-			tot_bytes_in += bytes_in;
-		}
+				if (!computing_offline)
+				{
+					//NOTE test run timer starts now; offline time NOT included
+					timer->process_timestamp(false, verbose, NULL);
+					//NOTE test run timer starts now; offline time NOT included
+				}
 
-		if (errors_detected)
-		{
-			printf("Error receiving garbled table from S1\n");
-		}
+				unsigned char bhat2_buf[num_input_bytes];
 
-		if (chosen_tm == MALICIOUS)
-		{
-			if (computing_offline)
-				timer->process_timestamp(true, verbose, "\nReceiving commitment labels from S1\n");
+				timer->process_timestamp(true, verbose, "\nReceiving XOR share from C\n");
+				bytes_in = peer_net->receive_from_peer(C_ID, bhat2_buf, num_input_bytes, ENCRYPTED, NULL);
+				timer->process_timestamp(true, verbose, "Done receiving XOR share from C\n\n");
+				errors_detected = bytes_in != num_input_bytes;
+				tot_bytes_in += bytes_in;
 
-			bytes_in = peer_net->receive_from_peer(S1_ID, (unsigned char*) s2_label_buf, commitment_size * sizeof(block), ENCRYPTED, NULL);
-			errors_detected = bytes_in != commitment_size * sizeof(block);
+				if (errors_detected)
+				{
+					printf("Error receiving XOR share from C\n");
+				}
 
-			if (computing_offline)
-			{
-				timer->process_timestamp(true, verbose, "Done receiving commitment labels from S1\n\n");
-				tot_bytes_in += bytes_in;
-			}
+				//S2 input bits for OT
+				CBitVector *OT_bits = new CBitVector();
+				//NOTE passing crypt causes population of OT_bits with random values, implicitly choosing random B2 at runtime
+				OT_bits->Create(num_OT_bits, crypt);
+				if (chosen_df == HD)
+					OT_bits->XORBits(bhat2_buf, 0, num_input_bits);
+				else
+					OT_bits->SetBits(bhat2_buf, num_input_bits, num_input_bits);
 
-			if (errors_detected)
-			{
-				printf("Error receiving commitment labels from S1\n");
-			}
-		}
+				//receive buffer for OT
+				CBitVector *OT_recv_buf = new CBitVector();
+				OT_recv_buf->Create(num_OT_bits, 8 * sizeof(block));
 
-		block *extracted_labels = (block*) malloc(gc_input_size * sizeof(block));
+				if (random_OT_sessions > 0)
+				{
+					int corrections_bytes = ceil_divide(num_OT_bits, 8);
+					unsigned char *corrections_buf = (unsigned char*) malloc(corrections_bytes);
+					block *masked_labels = (block*) malloc(2 * num_OT_bits * sizeof(block));
+
+					timer->process_timestamp(true, verbose, "\nDerandomizing precomputed OTs with S1\n");
+					errors_detected = !random_OT_corrections(&ot_pool, OT_bits, num_OT_bits, corrections_buf);
+					bytes_out = peer_net->send_to_peer(S1_ID, corrections_buf, corrections_bytes, PLAINTEXT, NULL);
+					errors_detected |= bytes_out != corrections_bytes;
+					tot_bytes_out += bytes_out;
+					if (bytes_out == corrections_bytes)
+					{
+						bytes_in = peer_net->receive_from_peer(S1_ID, (unsigned char*) masked_labels, 2 * num_OT_bits * sizeof(block), PLAINTEXT, NULL);
+						errors_detected |= bytes_in != 2 * num_OT_bits * sizeof(block);
+						tot_bytes_in += bytes_in;
+					}
+					if (!errors_detected)
+						derandomize_OT_recv(&ot_pool, masked_labels, OT_bits, num_OT_bits, extracted_labels);
+					timer->process_timestamp(true, verbose, "Done derandomizing precomputed OTs with S1\n\n");
+					ot_pool.next_OT += num_OT_bits;
+
+					free(corrections_buf);
+					free(masked_labels);
+				}
+				else
+				{
+					timer->process_timestamp(true, verbose, "\nEngaging in OT with S1\n");
+					errors_detected = !OTRecv(OT_recv_buf, OT_bits, num_OT_bits, 8 * sizeof(block), crypt, glock, OT_socket);
+					timer->process_timestamp(true, verbose, "Done engaging in OT with S1\n\n");
 
-		//copy garbled table from recv buffer
-		memcpy(&garbledCircuit.garbledTable->table, table_buf, gtable_size * sizeof(block));
-		//copy commitment labels to end of buffer, leaving space for labels via OT
-		if (chosen_tm == MALICIOUS)
-			memcpy(&extracted_labels[num_OT_bits], s2_label_buf, commitment_size * sizeof(block));
+					if (!errors_detected)
+						OT_recv_buf->GetBits((BYTE*) extracted_labels, 0, num_OT_bits * 8 * sizeof(block));
+				}
 
-		if (!computing_online)
-		{
-			free(table_buf);
-			free(extracted_labels);
-			free(s2_label_buf);
-			removeGarbledCircuit(&garbledCircuit);
-			goto finalization;
-		}
+				if (!errors_detected)
+				{
+					timer->process_timestamp(true, verbose, "\nEvaluating GC\n");
+					evaluate(&garbledCircuit, extracted_labels, (block*) elln_buf);
+					timer->process_timestamp(true, verbose, "Done evaluating GC\n\n");
+				}
+				else
+				{
+					printf("Could not evaluate GC due to previous errors\n");
+				}
 
-		//NOTE synchronization
-		peer_net->send_to_peer(S1_ID, ack_buf, 1, PLAINTEXT, NULL);
-		peer_net->receive_from_peer(S1_ID, ack_buf, 1, PLAINTEXT, NULL);
+				free(extracted_labels);
+				free(s2_label_buf);
+				OT_recv_buf->delCBitVector();
+				OT_bits->delCBitVector();
+				delete OT_recv_buf;
+				delete OT_bits;
 
-		BYTE verify_success, verify_failure;
-		BYTE *elln_buf = (BYTE*) malloc(1 + ((2 + chosen_tm) * sizeof(block)));
+				//mpz_clear(b_2);
 
-		if (!computing_offline)
-		{
-			//NOTE test run timer starts now; offline time NOT included
-			timer->process_timestamp(false, verbose, NULL);
-			//NOTE test run timer starts now; offline time NOT included
-		}
+				elln_buf[(2 + chosen_tm) * sizeof(block)] = !errors_detected;
 
-		unsigned char bhat2_buf[num_input_bytes];
+				timer->process_timestamp(true, verbose, "\nSending output labels to S1\n");
+				bytes_out = peer_net->send_to_peer(S1_ID, elln_buf, 1 + ((2 + chosen_tm) * sizeof(block)), ENCRYPTED, NULL);
+				timer->process_timestamp(true, verbose, "Done sending output labels to S1\n\n");
+				errors_detected = bytes_out != 1 + ((2 + chosen_tm) * sizeof(block));
+				tot_bytes_out += bytes_out;
 
-		timer->process_timestamp(true, verbose, "\nReceiving XOR share from C\n");
-		bytes_in = peer_net->receive_from_peer(C_ID, bhat2_buf, num_input_bytes, ENCRYPTED, NULL);
-		timer->process_timestamp(true, verbose, "Done receiving XOR share from C\n\n");
-		errors_detected = bytes_in != num_input_bytes;
-		tot_bytes_in += bytes_in;
+				if (errors_detected)
+				{
+					printf("Error sending labels to S1\n");
+				}
 
-		if (errors_detected)
-		{
-			printf("Error receiving XOR share from C\n");
-		}
+				//std::cout << "S2 Done\n";
 
-		//S2 input bits for OT
-		CBitVector *OT_bits = new CBitVector();
-		//NOTE passing crypt causes population of OT_bits with random values, implicitly choosing random B2 at runtime
-		OT_bits->Create(num_OT_bits, crypt);
-		if (chosen_df == HD)
-			OT_bits->XORBits(bhat2_buf, 0, num_input_bits);
-		else
-			OT_bits->SetBits(bhat2_buf, num_input_bits, num_input_bits);
+				//mpz_clear(b_2):
+				free(elln_buf);
+			}
 
-		//receive buffer for OT
-		CBitVector *OT_recv_buf = new CBitVector();
-		OT_recv_buf->Create(num_OT_bits, 8 * sizeof(block));
+			else if (my_id == C_ID)
+			{
+				group_ACK();
 
-		timer->process_timestamp(true, verbose, "\nEngaging in OT with S1\n");
-		errors_detected = !OTRecv(OT_recv_buf, OT_bits, num_OT_bits, 8 * sizeof(block), crypt, glock, OT_socket);
-		timer->process_timestamp(true, verbose, "Done engaging in OT with S1\n\n");
+				if (!computing_online)
+				{
+					goto finalization;
+				}
 
-		if (!errors_detected)
-		{
-			OT_recv_buf->GetBits((BYTE*) extracted_labels, 0, num_OT_bits * 8 * sizeof(block));
+				//NOTE synchronization
+				peer_net->send_to_peer(S1_ID, ack_buf, 1, PLAINTEXT, NULL);
+				peer_net->receive_from_peer(S1_ID, ack_buf, 1, PLAINTEXT, NULL);
 
-			timer->process_timestamp(true, verbose, "\nEvaluating GC\n");
-			evaluate(&garbledCircuit, extracted_labels, (block*) elln_buf);
-			timer->process_timestamp(true, verbose, "Done evaluating GC\n\n");
-		}
-		else
-		{
-			printf("Could not evaluate GC due to previous errors\n");
-		}
+				//NOTE test run timer starts now
+				timer->process_timestamp(false, verbose, NULL);
+				//NOTE test run timer starts now
 
-		free(extracted_labels);
-		free(s2_label_buf);
-		free(table_buf);
-		OT_recv_buf->delCBitVector();
-		OT_bits->delCBitVector();
-		delete OT_recv_buf;
-		delete OT_bits;
+				/* Generate Random Biometric */
 
-		//mpz_clear(b_2);
+				srand(time(NULL));
+				int bits_in_sysrand = lg_flr(RAND_MAX);
 
-		elln_buf[(2 + chosen_tm) * sizeof(block)] = !errors_detected;
+				//IEEE 754 mantissa: 23 value bits, one sign bit
+				mpf_set_default_prec(24);
+				int mantissa_expansion = 23 - bits_in_sysrand;
+				double mantissa_exp_factor = (double) (1 << mantissa_expansion) - 1;
 
-		timer->process_timestamp(true, verbose, "\nSending output labels to S1\n");
-		bytes_out = peer_net->send_to_peer(S1_ID, elln_buf, 1 + ((2 + chosen_tm) * sizeof(block)), ENCRYPTED, NULL);
-		timer->process_timestamp(true, verbose, "Done sending output labels to S1\n\n");
-		errors_detected = bytes_out != 1 + ((2 + chosen_tm) * sizeof(block));
-		tot_bytes_out += bytes_out;
+				mpf_t b_hat_raw[num_inputs];
+				for (int i = 0; i < num_inputs; i++)
+				{
+					mpf_init(b_hat_raw[i]);
+					double bhat_rand =  ((double) rand() / (double) (RAND_MAX)) - 0.5;
+					bhat_rand *= mantissa_exp_factor;
+					mpf_init_set_d(b_hat_raw[i], bhat_rand);
+				}
 
-		if (errors_detected)
-		{
-			printf("Error sending labels to S1\n");
-		}
+				mpz_t b_hat;
+
+				/* Compress Biometric If Necessary */
+
+				//NOTE uncompressed biometric feature values (i.e. *_raw_* variables) are generated as floats as per specification
+
+				if (input_length < DEFAULT_BIOMETRIC_INPUT_LENGTH)
+				{	//then compress
+					mpf_t bhat_min;
+					mpf_t bhat_max;
+					mpf_init_set(bhat_min, b_hat_raw[0]);
+					mpf_init_set(bhat_max, b_hat_raw[0]);
+					for (int i = 1; i < num_inputs; i++)
+					{	//get min and max vector elements
+						if (mpf_cmp(b_hat_raw[i], bhat_min) < 0)
+						{
+							mpf_set(bhat_min, b_hat_raw[i]);
+						}
+						else if (mpf_cmp(b_hat_raw[i], bhat_max) > 0)
+						{
+							mpf_set(bhat_max, b_hat_raw[i]);
+						}
+					}
+
+					mpf_t range;
+					mpf_t delta;
+					mpf_t compr_float;
+					mpf_t scaling_factor;
+					mpf_t compr_max_float;
+					mpf_init(range);
+					mpf_init(delta);
+					mpf_init(compr_float);
+					mpf_init(scaling_factor);
+					mpf_init_set_ui(compr_max_float, (unsigned long) (1 << COMPRESSED_BIOMETRIC_INPUT_LENGTH) - 1);
+
+					mpf_sub(range, bhat_max, bhat_min);
+					mpf_div(scaling_factor, compr_max_float, range);
+
+					mpz_t compr_uint;
+					mpz_init2(compr_uint, num_inputs * COMPRESSED_BIOMETRIC_INPUT_LENGTH);
+					mpz_init2(b_hat, num_inputs * COMPRESSED_BIOMETRIC_INPUT_LENGTH);
+					mpz_set_ui(b_hat, 0);
+
+					uint32_t compr_shift = 0;
+					for (int i = 0; i < num_inputs; i++)
+					{
+						mpf_sub(delta, b_hat_raw[i], bhat_min);
+						mpf_mul(compr_float, delta, scaling_factor);
+						//cast to uint
+						mpz_set_ui(compr_uint, mpf_get_ui(compr_float));
+						//left shift and mask
+						mpz_mul_2exp(compr_uint, compr_uint, compr_shift);
+						mpz_ior(b_hat, b_hat, compr_uint);
+						compr_shift += COMPRESSED_BIOMETRIC_INPUT_LENGTH;
+					}
+
+					mpf_clear(bhat_min);
+					mpf_clear(bhat_max);
+					mpf_clear(range);
+					mpf_clear(delta);
+					mpf_clear(compr_float);
+					mpf_clear(scaling_factor);
+					mpf_clear(compr_max_float);
+					mpz_clear(compr_uint);
 
-		//std::cout << "S2 Done\n";
+				}
+				else
+				{	//then no compression
+					mpz_init2(b_hat, num_inputs * DEFAULT_BIOMETRIC_INPUT_LENGTH);
+
+					mpz_t compr_uint;
+					mpz_init2(compr_uint, num_inputs * DEFAULT_BIOMETRIC_INPUT_LENGTH);
+					mpz_init2(b_hat, num_inputs * DEFAULT_BIOMETRIC_INPUT_LENGTH);
+					mpz_set_ui(b_hat, 0);
+
+					uint32_t compr_shift = 0;
+					for (int i = 0; i < num_inputs; i++)
+					{
+						mpz_set_ui(compr_uint, mpf_get_ui(b_hat_raw[i]));
+						mpz_mul_2exp(compr_uint, compr_uint, compr_shift);
+						mpz_ior(b_hat, b_hat, compr_uint);
+						compr_shift += DEFAULT_BIOMETRIC_INPUT_LENGTH;
+					}
+
+					mpz_clear(compr_uint);
+				}
 
-		//mpz_clear(b_2):
-		removeGarbledCircuit(&garbledCircuit);
-		free(elln_buf);
-	}
+				for (int i = 0; i < num_inputs; i++)
+				{
+					mpf_clear(b_hat_raw[i]);
+				}
 
-	else if (my_id == C_ID)
-	{
-		group_ACK();
+				//printf("1\n");
 
-		if (!computing_online)
-		{
-			goto finalization;
-		}
+				mpz_t r, r_hat;
+				mpz_init2(r, num_input_bits);
+				mpz_init2(r_hat, num_input_bits);
 
-		//NOTE synchronization
-		peer_net->send_to_peer(S1_ID, ack_buf, 1, PLAINTEXT, NULL);
-		peer_net->receive_from_peer(S1_ID, ack_buf, 1, PLAINTEXT, NULL);
+				gmp_randstate_t state;
+				gmp_randinit_mt(state);
+				mpz_urandomb(r, state, num_input_bits);
+				mpz_xor(r_hat, b_hat, r);
 
-		//NOTE test run timer starts now
-		timer->process_timestamp(false, verbose, NULL);
-		//NOTE test run timer starts now
+				size_t bytes_exported;
+				unsigned char bhat2_buf[num_input_bytes];
+				unsigned char bhat1_buf[num_input_bytes];
+				mpz_export(bhat2_buf, &bytes_exported, -1, 1, 0, 0, r);
+				//assert(bytes_exported == num_input_bytes);
+				mpz_export(bhat1_buf, &bytes_exported, -1, 1, 0, 0, r_hat);
+				//assert(bytes_exported == num_input_bytes);
 
-		/* Generate Random Biometric */
+				mpz_clear(b_hat);
+				mpz_clear(r_hat);
+				mpz_clear(r);
 
-		srand(time(NULL));
-		int bits_in_sysrand = lg_flr(RAND_MAX);
+				//print_block((block *) bhat2_buf, 1);
 
-		//IEEE 754 mantissa: 23 value bits, one sign bit
-		mpf_set_default_prec(24);
-		int mantissa_expansion = 23 - bits_in_sysrand;
-		double mantissa_exp_factor = (double) (1 << mantissa_expansion) - 1;
+				timer->process_timestamp(true, verbose, "\nSending input XOR share to S1\n");
+				bytes_out = peer_net->send_to_peer(S1_ID, bhat1_buf, num_input_bytes, ENCRYPTED, NULL);
+				timer->process_timestamp(true, verbose, "Done sending input XOR share to S1\n\n");
+				errors_detected = bytes_out != num_input_bytes;
+				tot_bytes_out += bytes_out;
 
-		mpf_t b_hat_raw[num_inputs];
-		for (int i = 0; i < num_inputs; i++)
-		{
-			mpf_init(b_hat_raw[i]);
-			double bhat_rand =  ((double) rand() / (double) (RAND_MAX)) - 0.5;
-			bhat_rand *= mantissa_exp_factor;
-			mpf_init_set_d(b_hat_raw[i], bhat_rand);
-		}
+				if (errors_detected)
+				{
+					printf("Error sending input XOR share to S1\n");
+				}
 
-		mpz_t b_hat;
+				timer->process_timestamp(true, verbose, "\nSending input XOR share to S2\n");
+				bytes_out = peer_net->send_to_peer(S2_ID, bhat2_buf, num_input_bytes, ENCRYPTED, NULL);
+				timer->process_timestamp(true, verbose, "Done sending input XOR share to S2\n\n");
+				errors_detected = bytes_out != num_input_bytes;
+				tot_bytes_out += bytes_out;
 
-		/* Compress Biometric If Necessary */
+				if (errors_detected)
+				{
+					printf("Error sending input XOR share to S2\n");
+				}
 
-		//NOTE uncompressed biometric feature values (i.e. *_raw_* variables) are generated as floats as per specification
+				timer->process_timestamp(true, verbose, "\nReceiving decision from S1\n");
+				bytes_in = peer_net->receive_from_peer(S1_ID, &decision, 1, ENCRYPTED, NULL);
+				timer->process_timestamp(true, verbose, "Done receiving decision from S1\n\n");
+				errors_detected = bytes_in != 1;
+				tot_bytes_in += bytes_in;
 
-		if (input_length < DEFAULT_BIOMETRIC_INPUT_LENGTH)
-		{	//then compress
-			mpf_t bhat_min;
-			mpf_t bhat_max;
-			mpf_init_set(bhat_min, b_hat_raw[0]);
-			mpf_init_set(bhat_max, b_hat_raw[0]);
-			for (int i = 1; i < num_inputs; i++)
-			{	//get min and max vector elements
-				if (mpf_cmp(b_hat_raw[i], bhat_min) < 0)
+				if (errors_detected)
 				{
-					mpf_set(bhat_min, b_hat_raw[i]);
+					printf("Error receiving decision from S1\n");
 				}
-				else if (mpf_cmp(b_hat_raw[i], bhat_max) > 0)
+				else if (verbose)
 				{
-					mpf_set(bhat_max, b_hat_raw[i]);
+					printf("\nDecision at C:\t%u\n\n", decision);
 				}
 			}
 
-			mpf_t range;
-			mpf_t delta;
-			mpf_t compr_float;
-			mpf_t scaling_factor;
-			mpf_t compr_max_float;
-			mpf_init(range);
-			mpf_init(delta);
-			mpf_init(compr_float);
-			mpf_init(scaling_factor);
-			mpf_init_set_ui(compr_max_float, (unsigned long) (1 << COMPRESSED_BIOMETRIC_INPUT_LENGTH) - 1);
-
-			mpf_sub(range, bhat_max, bhat_min);
-			mpf_div(scaling_factor, compr_max_float, range);
-
-			mpz_t compr_uint;
-			mpz_init2(compr_uint, num_inputs * COMPRESSED_BIOMETRIC_INPUT_LENGTH);
-			mpz_init2(b_hat, num_inputs * COMPRESSED_BIOMETRIC_INPUT_LENGTH);
-			mpz_set_ui(b_hat, 0);
-
-			uint32_t compr_shift = 0;
-			for (int i = 0; i < num_inputs; i++)
-			{
-				mpf_sub(delta, b_hat_raw[i], bhat_min);
-				mpf_mul(compr_float, delta, scaling_factor);
-				//cast to uint
-				mpz_set_ui(compr_uint, mpf_get_ui(compr_float));
-				//left shift and mask
-				mpz_mul_2exp(compr_uint, compr_uint, compr_shift);
-				mpz_ior(b_hat, b_hat, compr_uint);
-				compr_shift += COMPRESSED_BIOMETRIC_INPUT_LENGTH;
-			}
-
-			mpf_clear(bhat_min);
-			mpf_clear(bhat_max);
-			mpf_clear(range);
-			mpf_clear(delta);
-			mpf_clear(compr_float);
-			mpf_clear(scaling_factor);
-			mpf_clear(compr_max_float);
-			mpz_clear(compr_uint);
-
-		}
-		else
-		{	//then no compression
-			mpz_init2(b_hat, num_inputs * DEFAULT_BIOMETRIC_INPUT_LENGTH);
-
-			mpz_t compr_uint;
-			mpz_init2(compr_uint, num_inputs * DEFAULT_BIOMETRIC_INPUT_LENGTH);
-			mpz_init2(b_hat, num_inputs * DEFAULT_BIOMETRIC_INPUT_LENGTH);
-			mpz_set_ui(b_hat, 0);
+//NOTE label
+finalization:
 
-			uint32_t compr_shift = 0;
-			for (int i = 0; i < num_inputs; i++)
+			//NOTE saved after every session, so the counter on file is never behind the OTs used; with random OTs,
+			//NOTE only the batches use an OT extension, and fill_random_ot_pool() saves it instead
+			if ((my_id != C_ID) && (OT_state_file != "") && (random_OT_sessions == 0))
 			{
-				mpz_set_ui(compr_uint, mpf_get_ui(b_hat_raw[i]));
-				mpz_mul_2exp(compr_uint, compr_uint, compr_shift);
-				mpz_ior(b_hat, b_hat, compr_uint);
-				compr_shift += DEFAULT_BIOMETRIC_INPUT_LENGTH;
+				OTExt *ot_ext = (my_id == S1_ID) ? (OTExt*) sender : (OTExt*) receiver;
+				if (!ot_ext->SaveState(OT_state_filename(worker).c_str()))
+					printf("Error saving OT state file %s\n", OT_state_filename(worker).c_str());
 			}
 
-			mpz_clear(compr_uint);
-		}
+			std::lock_guard<std::mutex> results_lock(results_mtx);
 
-		for (int i = 0; i < num_inputs; i++)
-		{
-			mpf_clear(b_hat_raw[i]);
-		}
-
-		//printf("1\n");
-
-		mpz_t r, r_hat;
-		mpz_init2(r, num_input_bits);
-		mpz_init2(r_hat, num_input_bits);
+			if (session_run_num == 0)
+			{
+				std::ofstream comm_results_file;
+				comm_results_file.open(comm_res_fname, std::ios::app);
 
-		gmp_randstate_t state;
-		gmp_randinit_mt(state);
-		mpz_urandomb(r, state, num_input_bits);
-		mpz_xor(r_hat, b_hat, r);
+				//NOTE session workers share OT_socket and its byte counters, so with more than one the OT traffic of a
+				//NOTE session cannot be told apart, and only the bytes sent over its peer links are reported
+				if ((my_id != C_ID) && (session_workers == 1))
+				{
+					comm_results_file << "OT bytes sent:\t\t" << OT_socket->getSndCnt() << " bytes" << std::endl;
+					comm_results_file << "OT bytes received:\t\t" << OT_socket->getRcvCnt() <<" bytes" << std::endl;
 
-		size_t bytes_exported;
-		unsigned char bhat2_buf[num_input_bytes];
-		unsigned char bhat1_buf[num_input_bytes];
-		mpz_export(bhat2_buf, &bytes_exported, -1, 1, 0, 0, r);
-		//assert(bytes_exported == num_input_bytes);
-		mpz_export(bhat1_buf, &bytes_exported, -1, 1, 0, 0, r_hat);
-		//assert(bytes_exported == num_input_bytes);
+					comm_results_file << "Other bytes sent:\t\t" << tot_bytes_out << " bytes" << std::endl;
+					comm_results_file << "Other bytes received:\t\t" << tot_bytes_in << " bytes" << std::endl;
 
-		mpz_clear(b_hat);
-		mpz_clear(r_hat);
-		mpz_clear(r);
+					comm_results_file << "Total bytes sent:\t\t" << tot_bytes_out + OT_socket->getSndCnt() << " bytes" << std::endl;
+					comm_results_file << "Total bytes received:\t\t" << tot_bytes_in + OT_socket->getRcvCnt() << " bytes" << std::endl;
+				}
+				else if (my_id != C_ID)
+				{
+					comm_results_file << "OT bytes:\t\tnot counted per session with " << session_workers << " session workers" << std::endl;
 
-		//print_block((block *) bhat2_buf, 1);
+					comm_results_file << "Other bytes sent:\t\t" << tot_bytes_out << " bytes" << std::endl;
+					comm_results_file << "Other bytes received:\t\t" << tot_bytes_in << " bytes" << std::endl;
+				}
+				else
+				{
+					comm_results_file << "Total bytes sent:\t\t" << tot_bytes_out << " bytes" << std::endl;
+					comm_results_file << "Total bytes received:\t\t" << tot_bytes_in << " bytes" << std::endl;
+				}
 
-		timer->process_timestamp(true, verbose, "\nSending input XOR share to S1\n");
-		bytes_out = peer_net->send_to_peer(S1_ID, bhat1_buf, num_input_bytes, ENCRYPTED, NULL);
-		timer->process_timestamp(true, verbose, "Done sending input XOR share to S1\n\n");
-		errors_detected = bytes_out != num_input_bytes;
-		tot_bytes_out += bytes_out;
+				comm_results_file << "\n";
+				comm_results_file.close();
+			}
 
-		if (errors_detected)
-		{
-			printf("Error sending input XOR share to S1\n");
+			timer->process_results(id_str[my_id], test_params, session_run_num);
 		}
 
-		timer->process_timestamp(true, verbose, "\nSending input XOR share to S2\n");
-		bytes_out = peer_net->send_to_peer(S2_ID, bhat2_buf, num_input_bytes, ENCRYPTED, NULL);
-		timer->process_timestamp(true, verbose, "Done sending input XOR share to S2\n\n");
-		errors_detected = bytes_out != num_input_bytes;
-		tot_bytes_out += bytes_out;
-
-		if (errors_detected)
+		if (worker > 0)
 		{
-			printf("Error sending input XOR share to S2\n");
+			delete peer_net;
+			delete timer;
 		}
+	};
 
-		timer->process_timestamp(true, verbose, "\nReceiving decision from S1\n");
-		bytes_in = peer_net->receive_from_peer(S1_ID, &decision, 1, ENCRYPTED, NULL);
-		timer->process_timestamp(true, verbose, "Done receiving decision from S1\n\n");
-		errors_detected = bytes_in != 1;
-		tot_bytes_in += bytes_in;
-
-		if (errors_detected)
-		{
-			printf("Error receiving decision from S1\n");
-		}
-		else if (verbose)
+	if (my_id != C_ID)
+	{
+		worker_circuits.resize(session_workers - 1);
+		for (int worker = 1; worker < session_workers; worker++)
 		{
-			printf("\nDecision at C:\t%u\n\n", decision);
+			if (readCircuitFromFile(&worker_circuits[worker - 1], gc_file_c) < 0)
+				printf("Error reading GC scd file\n");
 		}
 	}
 
-//NOTE label
-finalization:
-
-	if (test_run_num == 0)
+	std::vector<std::thread> worker_threads;
+	for (int worker = 1; (my_id != C_ID) && (worker < session_workers); worker++)
 	{
-		std::ofstream comm_results_file;
-		comm_results_file.open(comm_res_fname, std::ios::app);
-
-		if (my_id != C_ID)
-		{
-			comm_results_file << "OT bytes sent:\t\t" << OT_socket->getSndCnt() << " bytes" << std::endl;
-			comm_results_file << "OT bytes received:\t\t" << OT_socket->getRcvCnt() <<" bytes" << std::endl;
-
-			comm_results_file << "Other bytes sent:\t\t" << tot_bytes_out << " bytes" << std::endl;
-			comm_results_file << "Other bytes received:\t\t" << tot_bytes_in << " bytes" << std::endl;
-
-			comm_results_file << "Total bytes sent:\t\t" << tot_bytes_out + OT_socket->getSndCnt() << " bytes" << std::endl;
-			comm_results_file << "Total bytes received:\t\t" << tot_bytes_in + OT_socket->getRcvCnt() << " bytes" << std::endl;
-		}
-		else
-		{
-			comm_results_file << "Total bytes sent:\t\t" << tot_bytes_out << " bytes" << std::endl;
-			comm_results_file << "Total bytes received:\t\t" << tot_bytes_in << " bytes" << std::endl;
-		}
-
-		comm_results_file << "\n";
-		comm_results_file.close();
+		worker_threads.push_back(std::thread(serve_sessions, worker, std::ref(worker_circuits[worker - 1])));
+	}
+	serve_sessions(0, garbledCircuit);
+	for (std::thread& worker_thread : worker_threads)
+	{
+		worker_thread.join();
 	}
 
-	timer->process_results(id_str[my_id], test_params, test_run_num);
-
+	if (garbling_pool != NULL)
+		removeGarblingPool(garbling_pool);
+	if (my_id != C_ID)
+		removeGarbledCircuit(&garbledCircuit);
+	for (GarbledCircuit& worker_circuit : worker_circuits)
+		removeGarbledCircuit(&worker_circuit);
 
 	Cleanup();
 	delete crypt;
@@ -31,6 +31,10 @@
 #define OT_ADMIN_CHANNEL MAX_NUM_COMM_CHANNELS-2
 #define OT_BASE_CHANNEL 0
 
+#define OT_STATE_ID_BYTES 16
+#define OT_STATE_VERSION 1
+#define OT_STATE_RESUME_GAP ((uint64_t) 1 << 32)
+
 /**
  \enum 	ot_ext_prot
  \brief	Specifies the different underlying OT extension protocols that are available
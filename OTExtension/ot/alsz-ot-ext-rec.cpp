@@ -43,11 +43,11 @@ BOOL ALSZOTExtRec::receiver_routine(uint32_t id, uint64_t myNumOTs) {
 		nchans = 3;
 	}
 
-	channel* ot_chan = new channel(OT_BASE_CHANNEL+nchans*id, m_cRcvThread, m_cSndThread);
-	channel* check_chan = new channel(OT_BASE_CHANNEL+nchans*id+1, m_cRcvThread, m_cSndThread);
+	channel* ot_chan = new channel(m_nChannelBase+nchans*id, m_cRcvThread, m_cSndThread);
+	channel* check_chan = new channel(m_nChannelBase+nchans*id+1, m_cRcvThread, m_cSndThread);
 	channel* mat_chan;
 	if(use_mat_chan) {
-		mat_chan = new channel(nchans*id+2, m_cRcvThread, m_cSndThread);
+		mat_chan = new channel(m_nChannelBase+nchans*id+2, m_cRcvThread, m_cSndThread);
 	}
 
 	// A temporary part of the T matrix
@@ -457,6 +457,8 @@ void ALSZOTExtRec::ComputeBaseOTs(field_type ftype) {
 		m_tBaseOTQ.push_back(tmp);*/
 	} else {
 		ALSZOTExtSnd* snd = new ALSZOTExtSnd(m_cCrypt, m_cRcvThread, m_cSndThread, m_nBaseOTs, m_nChecks);
+		snd->SetChannelBase(m_nChannelBase);
+		snd->SetAdminChannel(m_nAdminChannel);
 		uint32_t numots = buffer_ot_keys * m_nBaseOTs;
 		XORMasking* m_fMaskFct = new XORMasking(m_cCrypt->get_seclvl().symbits);
 		CBitVector** X = (CBitVector**) malloc(sizeof(CBitVector*) * nsndvals);//new CBitVector[nsndvals];
@@ -41,11 +41,11 @@ BOOL ALSZOTExtSnd::sender_routine(uint32_t id, uint64_t myNumOTs) {
 		nchans = 3;
 	}
 
-	channel* ot_chan = new channel(OT_BASE_CHANNEL+nchans*id, m_cRcvThread, m_cSndThread);
-	channel* check_chan = new channel(OT_BASE_CHANNEL+nchans*id + 1, m_cRcvThread, m_cSndThread);
+	channel* ot_chan = new channel(m_nChannelBase+nchans*id, m_cRcvThread, m_cSndThread);
+	channel* check_chan = new channel(m_nChannelBase+nchans*id + 1, m_cRcvThread, m_cSndThread);
 	channel* mat_chan;
 	if(use_mat_chan) {
-		mat_chan = new channel(nchans*id+2, m_cRcvThread, m_cSndThread);
+		mat_chan = new channel(m_nChannelBase+nchans*id+2, m_cRcvThread, m_cSndThread);
 	}
 
 	uint64_t internal_numOTs = std::min(myNumOTs + myStartPos, m_nOTs) - myStartPos;
@@ -505,6 +505,8 @@ void ALSZOTExtSnd::ComputeBaseOTs(field_type ftype) {
 		m_tBaseOTQ.push_back(tmp);*/
 	} else {
 		ALSZOTExtRec* rec = new ALSZOTExtRec(m_cCrypt, m_cRcvThread, m_cSndThread, m_nBaseOTs, m_nChecks);
+		rec->SetChannelBase(m_nChannelBase);
+		rec->SetAdminChannel(m_nAdminChannel);
 		uint32_t numots = buffer_ot_keys * m_nBaseOTs;
 		XORMasking* m_fMaskFct = new XORMasking(m_cCrypt->get_seclvl().symbits);
 		CBitVector U, resp;
@@ -53,7 +53,7 @@ BOOL KKOTExtRec::receiver_routine(uint32_t id, uint64_t myNumOTs) {
 	uint64_t OTwindow = num_ot_blocks * wd_size_bits;
 	uint64_t** rndmat;
 	uint64_t processedOTs;
-	channel* chan = new channel(OT_BASE_CHANNEL+id, m_cRcvThread, m_cSndThread);
+	channel* chan = new channel(m_nChannelBase+id, m_cRcvThread, m_cSndThread);
 
 	// A temporary part of the T matrix
 	CBitVector T(wd_size_bits * OTsPerIteration);
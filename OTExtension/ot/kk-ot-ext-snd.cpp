@@ -37,7 +37,7 @@ BOOL KKOTExtSnd::sender_routine(uint32_t id, uint64_t myNumOTs) {
 	uint64_t wd_size_bits = m_nBlockSizeBits;
 	uint64_t processedOTBlocks = std::min(num_ot_blocks, ceil_divide(myNumOTs, wd_size_bits));
 	uint64_t OTsPerIteration = processedOTBlocks * wd_size_bits;
-	channel* chan = new channel(OT_BASE_CHANNEL+id, m_cRcvThread, m_cSndThread);
+	channel* chan = new channel(m_nChannelBase+id, m_cRcvThread, m_cSndThread);
 	uint64_t** rndmat;
 	uint64_t processedOTs;
 
@@ -35,11 +35,11 @@ BOOL NNOBOTExtSnd::sender_routine(uint32_t id, uint64_t myNumOTs) {
 		nchans = 3;
 	}
 
-	channel* ot_chan = new channel(OT_BASE_CHANNEL+nchans*id, m_cRcvThread, m_cSndThread);
-	channel* check_chan = new channel(OT_BASE_CHANNEL+nchans*id + 1, m_cRcvThread, m_cSndThread);
+	channel* ot_chan = new channel(m_nChannelBase+nchans*id, m_cRcvThread, m_cSndThread);
+	channel* check_chan = new channel(m_nChannelBase+nchans*id + 1, m_cRcvThread, m_cSndThread);
 	channel* mat_chan;
 	if(use_mat_chan) {
-		mat_chan = new channel(nchans*id+2, m_cRcvThread, m_cSndThread);
+		mat_chan = new channel(m_nChannelBase+nchans*id+2, m_cRcvThread, m_cSndThread);
 	}
 
 	myNumOTs = std::min(myNumOTs + myStartPos, m_nOTs) - myStartPos;
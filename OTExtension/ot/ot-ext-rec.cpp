@@ -381,7 +381,7 @@ BOOL OTExtRec::verifyOT(uint64_t NumOTs) {
 	//uint8_t** tmpXn = (uint8_t**) malloc(nsndvals-1);
 	std::vector<uint8_t> tempRet(bytelen);
 	std::vector<uint8_t*> buf(nsndvals);
-	std::unique_ptr<channel> chan = std::make_unique<channel>(OT_ADMIN_CHANNEL, m_cRcvThread, m_cSndThread);
+	std::unique_ptr<channel> chan = std::make_unique<channel>(m_nAdminChannel, m_cRcvThread, m_cSndThread);
 	uint8_t *tmpbuf;
 	BYTE resp;
 	uint64_t tmpchoice;
@@ -446,7 +446,7 @@ BOOL OTExtRec::verifyOT(uint64_t NumOTs) {
 }
 
 void OTExtRec::ComputePKBaseOTs() {
-	channel* chan = new channel(OT_ADMIN_CHANNEL, m_cRcvThread, m_cSndThread);
+	channel* chan = new channel(m_nAdminChannel, m_cRcvThread, m_cSndThread);
 	uint32_t nsndvals = 2;
 	uint8_t* pBuf = (uint8_t*) malloc(m_cCrypt->get_hash_bytes() * m_nBaseOTs * nsndvals);
 	uint8_t* keyBuf = (uint8_t*) malloc(m_cCrypt->get_aes_key_bytes() * m_nBaseOTs * nsndvals);
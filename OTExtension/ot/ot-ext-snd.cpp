@@ -315,7 +315,7 @@ BOOL OTExtSnd::verifyOT(uint64_t NumOTs) {
 	uint64_t nSnd;
 	uint8_t* resp;
 
-	std::unique_ptr<channel> chan = std::make_unique<channel>(OT_ADMIN_CHANNEL, m_cRcvThread, m_cSndThread);
+	std::unique_ptr<channel> chan = std::make_unique<channel>(m_nAdminChannel, m_cRcvThread, m_cSndThread);
 
 	for (uint64_t i = 0; i < NumOTs; i += OTsPerIteration) {
 		processedOTBlocks = std::min(num_ot_blocks, ceil_divide(NumOTs - i, AES_BITS));
@@ -345,7 +345,7 @@ BOOL OTExtSnd::verifyOT(uint64_t NumOTs) {
 
 
 void OTExtSnd::ComputePKBaseOTs() {
-	channel* chan = new channel(OT_ADMIN_CHANNEL, m_cRcvThread, m_cSndThread);
+	channel* chan = new channel(m_nAdminChannel, m_cRcvThread, m_cSndThread);
 	uint8_t* pBuf = (uint8_t*) malloc(m_cCrypt->get_hash_bytes() * m_nBaseOTs);
 	uint8_t* keyBuf = (uint8_t*) malloc(m_cCrypt->get_aes_key_bytes() * m_nBaseOTs);
 
@@ -73,6 +73,10 @@ protected:
 
 	void ComputePKBaseOTs();
 
+	std::vector<CBitVector*>* GetBaseOTChoices() {
+		return &m_tBaseOTChoices;
+	}
+
 	//CBitVector m_vU;
 	CBitVector** m_vValues;
 
@@ -21,3 +21,217 @@
 
 
 
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * An OT state file holds, in this order: the OT_STATE_MAGIC string, the version, the role (0 for the sender, 1 for
+ * the receiver), the number of base OTs, the AES key size, the pairing id, the OT counter, the number of base OT key
+ * sets, the seed bytes of all sets, then for the sender the choice bits of each set, and a hash over all of it.
+ */
+#define OT_STATE_MAGIC "OTXSTATE"
+#define OT_STATE_MAGIC_BYTES 8
+
+struct ot_state {
+	uint32_t role;
+	uint32_t nbaseOTs;
+	uint32_t aes_key_bytes;
+	uint8_t state_id[OT_STATE_ID_BYTES];
+	uint64_t counter;
+	uint64_t nsets;
+	std::vector<uint8_t> seeds;
+	std::vector<std::vector<uint8_t> > choices;
+};
+
+static void put_bytes(std::vector<uint8_t>& buf, const void* src, uint64_t nbytes) {
+	buf.insert(buf.end(), (const uint8_t*) src, (const uint8_t*) src + nbytes);
+}
+
+static BOOL get_bytes(const std::vector<uint8_t>& buf, uint64_t* pos, void* dst, uint64_t nbytes) {
+	if(nbytes > buf.size() || *pos > buf.size() - nbytes)
+		return false;
+	memcpy(dst, buf.data() + *pos, nbytes);
+	*pos += nbytes;
+	return true;
+}
+
+static BOOL ReadStateFile(const char* filename, crypto* crypt, ot_state* state) {
+	FILE* f = fopen(filename, "rb");
+	if(f == NULL)
+		return false;
+	std::vector<uint8_t> buf;
+	uint8_t chunk[4096];
+	size_t nread;
+	while((nread = fread(chunk, 1, sizeof(chunk), f)) > 0)
+		buf.insert(buf.end(), chunk, chunk + nread);
+	fclose(f);
+
+	//integrity: the trailing hash has to match everything before it
+	uint32_t hash_bytes = crypt->get_hash_bytes();
+	if(buf.size() < OT_STATE_MAGIC_BYTES + hash_bytes) {
+		std::cerr << "OT state file " << filename << " is truncated" << std::endl;
+		return false;
+	}
+	uint64_t body_bytes = buf.size() - hash_bytes;
+	std::vector<uint8_t> digest(hash_bytes);
+	crypt->hash(digest.data(), hash_bytes, buf.data(), body_bytes);
+	if(memcmp(digest.data(), buf.data() + body_bytes, hash_bytes) != 0) {
+		std::cerr << "OT state file " << filename << " failed its integrity check" << std::endl;
+		return false;
+	}
+	buf.resize(body_bytes);
+
+	uint64_t pos = 0, nseedbytes, nchoicesets, nchoicebytes;
+	uint32_t version;
+	char magic[OT_STATE_MAGIC_BYTES];
+	BOOL ok = get_bytes(buf, &pos, magic, OT_STATE_MAGIC_BYTES) && memcmp(magic, OT_STATE_MAGIC, OT_STATE_MAGIC_BYTES) == 0
+			&& get_bytes(buf, &pos, &version, sizeof(version)) && version == OT_STATE_VERSION
+			&& get_bytes(buf, &pos, &state->role, sizeof(state->role))
+			&& get_bytes(buf, &pos, &state->nbaseOTs, sizeof(state->nbaseOTs))
+			&& get_bytes(buf, &pos, &state->aes_key_bytes, sizeof(state->aes_key_bytes))
+			&& get_bytes(buf, &pos, state->state_id, OT_STATE_ID_BYTES)
+			&& get_bytes(buf, &pos, &state->counter, sizeof(state->counter))
+			&& get_bytes(buf, &pos, &state->nsets, sizeof(state->nsets))
+			&& get_bytes(buf, &pos, &nseedbytes, sizeof(nseedbytes)) && nseedbytes <= buf.size() - pos;
+	if(ok) {
+		state->seeds.resize(nseedbytes);
+		ok = get_bytes(buf, &pos, state->seeds.data(), nseedbytes) && get_bytes(buf, &pos, &nchoicesets, sizeof(nchoicesets))
+				&& nchoicesets <= state->nsets;
+	}
+	for(uint64_t i = 0; ok && i < nchoicesets; i++) {
+		ok = get_bytes(buf, &pos, &nchoicebytes, sizeof(nchoicebytes)) && nchoicebytes <= buf.size() - pos;
+		if(ok) {
+			state->choices.push_back(std::vector<uint8_t>(nchoicebytes));
+			ok = get_bytes(buf, &pos, state->choices.back().data(), nchoicebytes);
+		}
+	}
+	if(!ok || pos != buf.size()) {
+		std::cerr << "OT state file " << filename << " is malformed" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+
+BOOL OTExt::ReadState(const char* filename, uint8_t* state_id, uint64_t* counter) {
+	ot_state state;
+	if(!ReadStateFile(filename, m_cCrypt, &state))
+		return false;
+	memcpy(state_id, state.state_id, OT_STATE_ID_BYTES);
+	*counter = state.counter;
+	return true;
+}
+
+
+BOOL OTExt::LoadState(const char* filename) {
+	ot_state state;
+	if(!ReadStateFile(filename, m_cCrypt, &state))
+		return false;
+
+	std::vector<CBitVector*>* base_ot_choices = GetBaseOTChoices();
+	uint32_t role = (base_ot_choices == NULL);
+	uint32_t aes_key_bytes = m_cCrypt->get_aes_key_bytes();
+	//the sender holds one key per base OT, the receiver one per base OT and sender value
+	uint64_t set_bytes = (uint64_t) m_nBaseOTs * (role + 1) * aes_key_bytes;
+	if(!m_tBaseOTKeys.empty() || state.role != role || state.nbaseOTs != m_nBaseOTs || state.aes_key_bytes != aes_key_bytes
+			|| state.nsets == 0 || state.seeds.size() != state.nsets * set_bytes
+			|| state.choices.size() != (role ? 0 : state.nsets)) {
+		std::cerr << "OT state file " << filename << " does not match this OT extension" << std::endl;
+		return false;
+	}
+	if(state.counter > UINT64_MAX - OT_STATE_RESUME_GAP) {
+		std::cerr << "OT state file " << filename << " has run out of OTs, the base OTs have to be redone" << std::endl;
+		return false;
+	}
+
+	OT_AES_KEY_CTX* tmp_keys;
+	for(uint64_t i = 0; i < state.nsets; i++) {
+		tmp_keys = (OT_AES_KEY_CTX*) malloc(sizeof(OT_AES_KEY_CTX) * m_nBaseOTs * (role + 1));
+		InitPRFKeys(tmp_keys, state.seeds.data() + i * set_bytes, m_nBaseOTs * (role + 1));
+		m_tBaseOTKeys.push_back(tmp_keys);
+	}
+	CBitVector* tmp_choices;
+	for(uint64_t i = 0; i < state.choices.size(); i++) {
+		tmp_choices = new CBitVector();
+		tmp_choices->CreateBytes(state.choices[i].size());
+		tmp_choices->Copy(state.choices[i].data(), 0, state.choices[i].size());
+		base_ot_choices->push_back(tmp_choices);
+	}
+
+	memcpy(m_vStateId, state.state_id, OT_STATE_ID_BYTES);
+	m_nCounter = state.counter + OT_STATE_RESUME_GAP;
+	return true;
+}
+
+
+BOOL OTExt::SaveState(const char* filename) {
+	if(m_tBaseOTKeys.empty())
+		return false;
+
+	//monotonicity: never replace the state of this pairing with an older one
+	ot_state saved;
+	if(ReadStateFile(filename, m_cCrypt, &saved) && memcmp(saved.state_id, m_vStateId, OT_STATE_ID_BYTES) == 0
+			&& saved.counter > m_nCounter) {
+		std::cerr << "OT state file " << filename << " is ahead of this OT extension, not overwriting it" << std::endl;
+		return false;
+	}
+
+	std::vector<CBitVector*>* base_ot_choices = GetBaseOTChoices();
+	uint32_t version = OT_STATE_VERSION;
+	uint32_t role = (base_ot_choices == NULL);
+	uint32_t aes_key_bytes = m_cCrypt->get_aes_key_bytes();
+	uint64_t nsets = m_tBaseOTKeys.size();
+	uint64_t nseedbytes = m_vBaseOTSeeds.size();
+	uint64_t nchoicesets = role ? 0 : base_ot_choices->size();
+	uint64_t nchoicebytes;
+
+	std::vector<uint8_t> buf;
+	put_bytes(buf, OT_STATE_MAGIC, OT_STATE_MAGIC_BYTES);
+	put_bytes(buf, &version, sizeof(version));
+	put_bytes(buf, &role, sizeof(role));
+	put_bytes(buf, &m_nBaseOTs, sizeof(m_nBaseOTs));
+	put_bytes(buf, &aes_key_bytes, sizeof(aes_key_bytes));
+	put_bytes(buf, m_vStateId, OT_STATE_ID_BYTES);
+	put_bytes(buf, &m_nCounter, sizeof(m_nCounter));
+	put_bytes(buf, &nsets, sizeof(nsets));
+	put_bytes(buf, &nseedbytes, sizeof(nseedbytes));
+	put_bytes(buf, m_vBaseOTSeeds.data(), nseedbytes);
+	put_bytes(buf, &nchoicesets, sizeof(nchoicesets));
+	for(uint64_t i = 0; i < nchoicesets; i++) {
+		nchoicebytes = (*base_ot_choices)[i]->GetSize();
+		put_bytes(buf, &nchoicebytes, sizeof(nchoicebytes));
+		put_bytes(buf, (*base_ot_choices)[i]->GetArr(), nchoicebytes);
+	}
+	uint32_t hash_bytes = m_cCrypt->get_hash_bytes();
+	buf.resize(buf.size() + hash_bytes);
+	m_cCrypt->hash(buf.data() + buf.size() - hash_bytes, hash_bytes, buf.data(), buf.size() - hash_bytes);
+
+	//written aside and renamed over the old file, so a crash mid-write leaves the previous state intact
+	//the file holds base-OT secrets, so it is created readable by its owner only and synced before the rename
+	//a stale .tmp left by a crash is removed first, since O_CREAT keeps the mode of an existing file
+	std::string tmpname = std::string(filename) + ".tmp";
+	remove(tmpname.c_str());
+	int fd = open(tmpname.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0600);
+	FILE* f = (fd < 0) ? NULL : fdopen(fd, "wb");
+	if(f == NULL) {
+		std::cerr << "Could not write OT state file " << tmpname << std::endl;
+		if(fd >= 0) {
+			close(fd);
+			remove(tmpname.c_str());
+		}
+		return false;
+	}
+	BOOL ok = (fwrite(buf.data(), 1, buf.size(), f) == buf.size());
+	ok = (fflush(f) == 0) && ok;
+	ok = (fsync(fd) == 0) && ok;
+	ok = (fclose(f) == 0) && ok;
+	if(!ok || rename(tmpname.c_str(), filename) != 0) {
+		std::cerr << "Could not write OT state file " << filename << std::endl;
+		remove(tmpname.c_str());
+		return false;
+	}
+	return true;
+}
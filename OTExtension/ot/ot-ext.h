@@ -131,6 +131,28 @@ public:
 		m_bUseMinEntCorRob = false;
 	}
 
+	//Persisting the base OT seeds and OT counter lets a pairing of parties skip the base OTs when it reconnects.
+	//ReadState only verifies a state file and returns its pairing id and counter, LoadState replaces ComputeBaseOTs
+	//with it and moves the counter OT_STATE_RESUME_GAP ahead, so OTs done after the last save are never reused
+	BOOL ReadState(const char* filename, uint8_t* state_id, uint64_t* counter);
+	BOOL LoadState(const char* filename);
+	BOOL SaveState(const char* filename);
+	void SetStateId(const uint8_t* state_id) {
+		memcpy(m_vStateId, state_id, OT_STATE_ID_BYTES);
+	}
+	uint64_t GetCounter() {
+		return m_nCounter;
+	}
+
+	//Several OT extensions can share one socket if each uses its own range of channel ids, starting at channel_base
+	void SetChannelBase(uint32_t channel_base) {
+		m_nChannelBase = channel_base;
+	}
+	//The base OTs and OT verification run on the admin channel, which must differ too if they can run concurrently
+	void SetAdminChannel(uint32_t admin_channel) {
+		m_nAdminChannel = admin_channel;
+	}
+
 protected:
 	void Init(crypto* crypt, RcvThread* rcvthread, SndThread* sndthread, uint32_t nbaseOTs) {
 		m_cCrypt = crypt;
@@ -139,8 +161,12 @@ protected:
 		m_nBlockSizeBits = pad_to_power_of_two(m_nBaseOTs);
 		m_nBlockSizeBytes = pad_to_power_of_two(m_nBaseOTs/8);
 		m_nCounter = 0;
+		m_nChannelBase = OT_BASE_CHANNEL;
+		m_nAdminChannel = OT_ADMIN_CHANNEL;
 		m_bUseMinEntCorRob = false;
 		m_tBaseOTKeys.resize(0);
+		m_vBaseOTSeeds.resize(0);
+		memset(m_vStateId, 0, OT_STATE_ID_BYTES);
 
 		//sndthread = new SndThread(sock);
 		//rcvthread = new RcvThread(sock);
@@ -156,6 +182,8 @@ protected:
 
 	void InitPRFKeys(OT_AES_KEY_CTX* base_ot_keys, uint8_t* keybytes, uint32_t nbasekeys) {
 		InitAESKey(base_ot_keys, keybytes, nbasekeys, m_cCrypt);
+		//the expanded key contexts cannot be written out, so the seeds are kept in the order of m_tBaseOTKeys
+		m_vBaseOTSeeds.insert(m_vBaseOTSeeds.end(), keybytes, keybytes + nbasekeys * m_cCrypt->get_aes_key_bytes());
 
 		if (use_fixed_key_aes_hashing) {
 			m_kCRFKey = (AES_KEY_CTX*) malloc(sizeof(AES_KEY_CTX));
@@ -163,6 +191,11 @@ protected:
 		}
 	}
 
+	//the sender's base OT choice bits, NULL for the receiver
+	virtual std::vector<CBitVector*>* GetBaseOTChoices() {
+		return NULL;
+	}
+
 	snd_ot_flavor m_eSndOTFlav;
 	rec_ot_flavor m_eRecOTFlav;
 	uint32_t m_nSndVals;
@@ -174,6 +207,8 @@ protected:
 	uint32_t m_nChecks;
 	uint32_t m_nBlockSizeBits;
 	uint32_t m_nBlockSizeBytes;
+	uint32_t m_nChannelBase;
+	uint32_t m_nAdminChannel;
 
 	crypto* m_cCrypt;
 
@@ -184,6 +219,8 @@ protected:
 	RcvThread* m_cRcvThread;
 
     std::vector<OT_AES_KEY_CTX*> m_tBaseOTKeys;
+	std::vector<uint8_t> m_vBaseOTSeeds;
+	uint8_t m_vStateId[OT_STATE_ID_BYTES];
 
 	MaskingFunction* m_fMaskFct;
 